@@ -22,7 +22,26 @@ bool boxer_MIDIAvailable();
 void boxer_sendMIDIMessage(Bit8u *msg);
 void boxer_sendMIDISysex(Bit8u *msg, Bitu len);
 
+//Called on the emulation thread for each message before it is queued for DOSBox's MIDI
+//dispatch thread. These attach the MIDI device and run MT-32 detection, and deliver the
+//message at once to devices that render into the mixer. They return false if there is
+//nothing left for the dispatch thread to send.
+bool boxer_prepareMIDIMessage(Bit8u *msg);
+bool boxer_prepareMIDISysex(Bit8u *msg, Bitu len);
+
+//Called on the dispatch thread to hand a prepared message to the active MIDI device.
+//These never wait on the device: the dispatch thread waits out
+//boxer_secondsUntilMIDIDeviceIsReady itself first.
+void boxer_dispatchMIDIMessage(Bit8u *msg);
+void boxer_dispatchMIDISysex(Bit8u *msg, Bitu len);
+
+//How long until the active MIDI device is ready for another message, in seconds.
+double boxer_secondsUntilMIDIDeviceIsReady();
+
 float boxer_masterVolume(BXAudioChannel channel);
 
 //Defined in mixer.cpp. Update the volumes of all active channels.
-void boxer_updateVolumes();
\ No newline at end of file
+void boxer_updateVolumes();
+
+//Defined in midi.cpp. Blocks until the MIDI dispatch thread has delivered everything queued so far.
+void MIDI_WaitForDispatch();
\ No newline at end of file
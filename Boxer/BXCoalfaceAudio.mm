@@ -124,6 +124,45 @@ void boxer_sendMIDISysex(Bit8u *msg, Bitu len)
     [[BXEmulator currentEmulator] sendMIDISysex: [NSData dataWithBytesNoCopy: msg length: len freeWhenDone: NO]];
 }
 
+bool boxer_prepareMIDIMessage(Bit8u *msg)
+{
+    NSUInteger len = (NSUInteger)BXMIDIMessageLength[msg[0]];
+    if (!len) return NO;
+    
+    return [[BXEmulator currentEmulator] prepareMIDIMessage: [NSData dataWithBytesNoCopy: msg length: len freeWhenDone: NO]];
+}
+
+bool boxer_prepareMIDISysex(Bit8u *msg, Bitu len)
+{
+    return [[BXEmulator currentEmulator] prepareMIDISysex: [NSData dataWithBytesNoCopy: msg length: len freeWhenDone: NO]];
+}
+
+void boxer_dispatchMIDIMessage(Bit8u *msg)
+{
+    NSUInteger len = (NSUInteger)BXMIDIMessageLength[msg[0]];
+    
+    //We're called from DOSBox's MIDI dispatch thread, which has no autorelease pool of its own.
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [[BXEmulator currentEmulator] dispatchMIDIMessage: [NSData dataWithBytesNoCopy: msg length: len freeWhenDone: NO]];
+    [pool drain];
+}
+
+void boxer_dispatchMIDISysex(Bit8u *msg, Bitu len)
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [[BXEmulator currentEmulator] dispatchMIDISysex: [NSData dataWithBytesNoCopy: msg length: len freeWhenDone: NO]];
+    [pool drain];
+}
+
+double boxer_secondsUntilMIDIDeviceIsReady()
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    id <BXMIDIDevice> device = [BXEmulator currentEmulator].activeMIDIDevice;
+    NSTimeInterval wait = (device.isProcessing) ? device.dateWhenReady.timeIntervalSinceNow : 0;
+    [pool drain];
+    return wait;
+}
+
 float boxer_masterVolume(BXAudioChannel channel)
 {
     //We don't use separate left and right volumes.
@@ -74,4 +74,16 @@ extern NSString * const BXMIDIExternalDeviceNeedsMT32SysexDelaysKey;
 - (void) sendMIDIMessage: (NSData *)message;
 - (void) sendMIDISysex: (NSData *)message;
 
+//Sending is split in two when DOSBox sends MIDI from its dispatch thread.
+//The prepare methods run on the emulation thread: they attach the MIDI device,
+//run MT-32 detection, and deliver the message straight away to devices that render
+//into the mixer. They return YES if the message still has to be dispatched.
+- (BOOL) prepareMIDIMessage: (NSData *)message;
+- (BOOL) prepareMIDISysex: (NSData *)message;
+
+//Hands a prepared message to the active MIDI device without waiting for it to be ready.
+//Called from the dispatch thread, which does its own waiting.
+- (void) dispatchMIDIMessage: (NSData *)message;
+- (void) dispatchMIDISysex: (NSData *)message;
+
 @end
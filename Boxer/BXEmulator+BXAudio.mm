@@ -58,6 +58,9 @@ NSString * const BXMIDIExternalDeviceNeedsMT32SysexDelaysKey = @"Needs MT-32 Sys
 {
     if (device != [self activeMIDIDevice])
     {
+        //Let DOSBox's MIDI dispatch thread deliver what it has for the old device first.
+        MIDI_WaitForDispatch();
+        
         [activeMIDIDevice release];
         activeMIDIDevice = [device retain];
         
@@ -90,19 +93,43 @@ NSString * const BXMIDIExternalDeviceNeedsMT32SysexDelaysKey = @"Needs MT-32 Sys
 }
 
 - (void) sendMIDIMessage: (NSData *)message
+{
+    if ([self prepareMIDIMessage: message])
+    {
+        //If we're not ready to send yet, wait until we are.
+        [self _waitUntilActiveMIDIDeviceIsReady];
+        [self dispatchMIDIMessage: message];
+    }
+}
+
+- (void) sendMIDISysex: (NSData *)message
+{
+    if ([self prepareMIDISysex: message])
+    {
+        //If we're not ready to send yet, wait until we are.
+        [self _waitUntilActiveMIDIDeviceIsReady];
+        [self dispatchMIDISysex: message];
+    }
+}
+
+- (BOOL) prepareMIDIMessage: (NSData *)message
 {
     //Connect to our requested MIDI device the first time we need one.
     [self _attachRequestedMIDIDeviceIfNeeded];
     
-    if ([self activeMIDIDevice])
+    if (!self.activeMIDIDevice) return NO;
+    
+    //Devices that render into the mixer are fed on the thread the mixer runs on.
+    if ([self.activeMIDIDevice conformsToProtocol: @protocol(BXAudioSource)])
     {
-        //If we're not ready to send yet, wait until we are.
         [self _waitUntilActiveMIDIDeviceIsReady];
-        [[self activeMIDIDevice] handleMessage: message];
+        [self dispatchMIDIMessage: message];
+        return NO;
     }
+    return YES;
 }
 
-- (void) sendMIDISysex: (NSData *)message
+- (BOOL) prepareMIDISysex: (NSData *)message
 {
     //Connect to our requested MIDI device the first time we need one.
     [self _attachRequestedMIDIDeviceIfNeeded];
@@ -156,12 +183,26 @@ NSString * const BXMIDIExternalDeviceNeedsMT32SysexDelaysKey = @"Needs MT-32 Sys
         }
     }
 
-    if (self.activeMIDIDevice)
+    if (!self.activeMIDIDevice) return NO;
+    
+    //Devices that render into the mixer are fed on the thread the mixer runs on.
+    if ([self.activeMIDIDevice conformsToProtocol: @protocol(BXAudioSource)])
     {
-        //If we're not ready to send yet, wait until we are.
         [self _waitUntilActiveMIDIDeviceIsReady];
-        [self.activeMIDIDevice handleSysex: message];
+        [self dispatchMIDISysex: message];
+        return NO;
     }
+    return YES;
+}
+
+- (void) dispatchMIDIMessage: (NSData *)message
+{
+    [self.activeMIDIDevice handleMessage: message];
+}
+
+- (void) dispatchMIDISysex: (NSData *)message
+{
+    [self.activeMIDIDevice handleSysex: message];
 }
 
 
@@ -491,8 +491,13 @@ void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
 				break;
 		}
 		
-		//Prevent DOSBox from resetting the core mode after a program exits
-		CPU_AutoDetermineMode &= ~CPU_AUTODETERMINE_CORE;
+		//Prevent DOSBox from resetting the core mode after a program exits.
+		//While a protected-mode program runs, DOSBox keeps the flag shifted
+		//up and shifts it back down once the program exits, so clear both.
+		CPU_AutoDetermineMode &= ~(CPU_AUTODETERMINE_CORE | (CPU_AUTODETERMINE_CORE << CPU_AUTODETERMINE_SHIFT));
+		
+		//Stop core=auto from switching away from the chosen core
+		CPU_AutoCore_Reset(false);
 		
 		//Reset DOSBox's emulated cycles counters
 		CPU_CycleLeft=0;
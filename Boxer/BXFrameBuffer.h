@@ -12,6 +12,8 @@
 
 #import <Foundation/Foundation.h>
 
+@class BXFrameExchange;
+
 
 //Aspect ratios with a difference smaller than this will be considered equivalent
 #define BXIdenticalAspectRatioDelta	0.025f
@@ -30,6 +32,9 @@
     
     NSRange dirtyRegions[MAX_DIRTY_REGIONS];
     NSUInteger numDirtyRegions;
+    
+    NSUInteger frameNumber;
+    BXFrameExchange *exchange;
 }
 
 #pragma mark -
@@ -67,6 +72,14 @@
 //and reset to 0 by clearDirtyRegions. See the dirty region functions below.
 @property (readonly, assign) NSUInteger numDirtyRegions;
 
+//The sequence number of the frame last published in this buffer.
+//Set by BXFrameExchange, and used by the renderer to notice frames it never saw.
+@property (assign) NSUInteger frameNumber;
+
+//The exchange this buffer belongs to, or nil if it is a standalone buffer.
+//Not retained, as the exchange owns the buffer.
+@property (assign) BXFrameExchange *exchange;
+
 
 #pragma mark -
 #pragma mark Class helpers
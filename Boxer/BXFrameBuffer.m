@@ -16,6 +16,7 @@
 @implementation BXFrameBuffer
 @synthesize size, baseResolution, bitDepth, intendedScale;
 @synthesize numDirtyRegions;
+@synthesize frameNumber, exchange;
 
 
 + (NSSize) scalingFactorForSize: (NSSize)frameSize toAspectRatio: (CGFloat)aspectRatio
@@ -0,0 +1,124 @@
+/*
+ Boxer is copyright 2011 Alun Bestor and contributors.
+ Boxer is released under the GNU General Public License 2.0. A full copy of this license can be
+ found in this XCode project at Resources/English.lproj/BoxerHelp/pages/legalese.html, or read
+ online at [http://www.gnu.org/licenses/gpl-2.0.txt].
+ */
+
+
+//BXFrameExchange hands frames from the emulation thread to the presentation thread through
+//three framebuffers. DOSBox renders into the back buffer; when a frame is finished it is
+//swapped into the ready slot, and the presenter swaps the ready slot for its front buffer
+//whenever it wants the latest frame. Neither side ever waits on the other: if DOS produces
+//frames faster than they are presented, the unpresented frame in the ready slot is simply
+//replaced with the newer one.
+
+#import <Foundation/Foundation.h>
+#import <libkern/OSAtomic.h>
+
+@class BXFrameBuffer;
+
+//Frame pacing statistics, collected since the exchange was created or last reset.
+typedef struct {
+	//The number of frames finished by DOSBox.
+	NSUInteger framesPublished;
+
+	//The number of frames taken up by the presenter.
+	NSUInteger framesPresented;
+
+	//The number of frames that were replaced by a newer frame before they could be presented.
+	NSUInteger framesDropped;
+
+	//The average and longest time between a frame being finished and being taken up.
+	NSTimeInterval meanLatency;
+	NSTimeInterval maxLatency;
+
+	//The average and longest time between two frames being taken up.
+	NSTimeInterval meanPresentInterval;
+	NSTimeInterval maxPresentInterval;
+} BXFramePacingStats;
+
+
+#define BXFrameExchangeBufferCount 3
+
+@interface BXFrameExchange : NSObject
+{
+	BXFrameBuffer *buffers[BXFrameExchangeBufferCount];
+	NSUInteger backIndex;
+	NSUInteger readyIndex;
+	NSUInteger frontIndex;
+	BOOL readyIsFresh;
+	OSSpinLock slotLock;
+
+	//The number of the last frame published, for every line of the buffers.
+	//Used to bring a recycled back buffer up to date with the lines it missed.
+	NSUInteger *lineStamps;
+	NSUInteger lastFrameNumber;
+	BOOL backBufferTainted;
+
+	NSTimeInterval publishTimes[BXFrameExchangeBufferCount];
+	NSTimeInterval lastPresentTime;
+	NSTimeInterval totalLatency;
+	NSTimeInterval totalPresentInterval;
+	BXFramePacingStats stats;
+}
+
+#pragma mark -
+#pragma mark Properties
+
+//The size and bit depth of all three buffers.
+@property (readonly) NSSize size;
+@property (readonly) NSUInteger bitDepth;
+
+
+#pragma mark -
+#pragma mark Initializers
+
++ (id) exchangeWithSize: (NSSize)targetSize depth: (NSUInteger)depth;
+- (id) initWithSize: (NSSize)targetSize depth: (NSUInteger)depth;
+
+
+#pragma mark -
+#pragma mark Producer methods
+
+//These should only be called from the emulation thread.
+
+//Returns the buffer that DOSBox should render the next frame into.
+//Its contents are always those of the last published frame.
+- (BXFrameBuffer *) backBuffer;
+
+//Returns all three buffers, for applying settings like the aspect ratio to each.
+- (NSArray *) buffers;
+
+//Swaps the finished back buffer into the ready slot for the presenter to take up,
+//and returns it. The dirty regions of the buffer must describe what changed.
+- (BXFrameBuffer *) publishBackBuffer;
+
+//Flags that the back buffer was partially drawn into by a frame that was abandoned.
+//The next published frame will then be treated as having changed completely.
+- (void) discardBackBuffer;
+
+
+#pragma mark -
+#pragma mark Presenter methods
+
+//These may be called from any thread.
+
+//Swaps the most recently published frame into the front buffer and returns it,
+//or returns nil if nothing has been published since the last call.
+//The returned buffer will not be touched by the emulation thread until the next
+//time a frame is taken up.
+- (BXFrameBuffer *) takeLatestFrame;
+
+//Returns the buffer the presenter is currently drawing from.
+- (BXFrameBuffer *) frontBuffer;
+
+
+#pragma mark -
+#pragma mark Statistics
+
+//BXVideoHandler logs these and resets them whenever the video mode changes and at shutdown.
+- (BXFramePacingStats) pacingStats;
+- (void) resetPacingStats;
+
+@end
@@ -0,0 +1,230 @@
+/*
+ Boxer is copyright 2011 Alun Bestor and contributors.
+ Boxer is released under the GNU General Public License 2.0. A full copy of this license can be
+ found in this XCode project at Resources/English.lproj/BoxerHelp/pages/legalese.html, or read
+ online at [http://www.gnu.org/licenses/gpl-2.0.txt].
+ */
+
+
+#import "BXFrameExchange.h"
+#import "BXFrameBuffer.h"
+
+
+@interface BXFrameExchange ()
+
+//Copies every line that has changed since the back buffer was last published
+//from the specified frame, which must be the most recently published one.
+- (void) _bringBackBufferUpToDateWithFrame: (BXFrameBuffer *)frame;
+
+@end
+
+
+@implementation BXFrameExchange
+
++ (id) exchangeWithSize: (NSSize)targetSize depth: (NSUInteger)depth
+{
+	return [[[self alloc] initWithSize: targetSize depth: depth] autorelease];
+}
+
+- (id) initWithSize: (NSSize)targetSize depth: (NSUInteger)depth
+{
+	if ((self = [super init]))
+	{
+		NSUInteger i;
+		for (i=0; i<BXFrameExchangeBufferCount; i++)
+		{
+			buffers[i] = [[BXFrameBuffer alloc] initWithSize: targetSize depth: depth];
+			[buffers[i] setExchange: self];
+		}
+		backIndex	= 0;
+		readyIndex	= 1;
+		frontIndex	= 2;
+		slotLock	= OS_SPINLOCK_INIT;
+
+		lineStamps = (NSUInteger *)calloc((NSUInteger)targetSize.height, sizeof(NSUInteger));
+	}
+	return self;
+}
+
+- (void) dealloc
+{
+	NSUInteger i;
+	for (i=0; i<BXFrameExchangeBufferCount; i++)
+	{
+		[buffers[i] setExchange: nil];
+		[buffers[i] release], buffers[i] = nil;
+	}
+	free(lineStamps), lineStamps = NULL;
+	[super dealloc];
+}
+
+- (NSSize) size
+{
+	return [buffers[0] size];
+}
+
+- (NSUInteger) bitDepth
+{
+	return [buffers[0] bitDepth];
+}
+
+- (NSArray *) buffers
+{
+	return [NSArray arrayWithObjects: (id *)buffers count: BXFrameExchangeBufferCount];
+}
+
+
+#pragma mark -
+#pragma mark Producer methods
+
+- (BXFrameBuffer *) backBuffer
+{
+	return buffers[backIndex];
+}
+
+- (void) discardBackBuffer
+{
+	backBufferTainted = YES;
+}
+
+- (BXFrameBuffer *) publishBackBuffer
+{
+	BXFrameBuffer *frame = buffers[backIndex];
+	NSUInteger frameNumber = ++lastFrameNumber;
+	NSUInteger height = (NSUInteger)[frame size].height;
+
+	//If an abandoned frame left lines behind that DOSBox won't redraw,
+	//we have no idea which ones they were: treat the whole frame as changed.
+	if (backBufferTainted)
+	{
+		[frame clearDirtyRegions];
+		[frame setNeedsDisplayInRegion: NSMakeRange(0, height)];
+		backBufferTainted = NO;
+	}
+
+	NSUInteger i, numRegions = [frame numDirtyRegions];
+	for (i=0; i<numRegions; i++)
+	{
+		NSRange region = [frame dirtyRegionAtIndex: i];
+		NSUInteger line, end = MIN(NSMaxRange(region), height);
+		for (line = region.location; line < end; line++) lineStamps[line] = frameNumber;
+	}
+	[frame setFrameNumber: frameNumber];
+	publishTimes[backIndex] = CFAbsoluteTimeGetCurrent();
+
+	OSSpinLockLock(&slotLock);
+		//The presenter never got around to the previous frame
+		if (readyIsFresh) stats.framesDropped++;
+		stats.framesPublished++;
+
+		NSUInteger publishedIndex = backIndex;
+		backIndex		= readyIndex;
+		readyIndex		= publishedIndex;
+		readyIsFresh	= YES;
+	OSSpinLockUnlock(&slotLock);
+
+	//DOSBox only redraws the lines that changed since its last frame,
+	//so the buffer it draws into next must match the frame it just finished.
+	[self _bringBackBufferUpToDateWithFrame: frame];
+
+	return frame;
+}
+
+- (void) _bringBackBufferUpToDateWithFrame: (BXFrameBuffer *)frame
+{
+	BXFrameBuffer *back = buffers[backIndex];
+	NSUInteger since = [back frameNumber];
+	if (since == [frame frameNumber]) return;
+
+	NSUInteger pitch = [frame pitch];
+	NSUInteger height = (NSUInteger)[frame size].height;
+	const Byte *source = (const Byte *)[frame bytes];
+	Byte *dest = (Byte *)[back mutableBytes];
+
+	//Copy runs of stale lines in one go
+	NSUInteger line = 0;
+	while (line < height)
+	{
+		if (lineStamps[line] <= since)
+		{
+			line++;
+			continue;
+		}
+		NSUInteger runStart = line;
+		while (line < height && lineStamps[line] > since) line++;
+		memcpy(dest + (runStart * pitch), source + (runStart * pitch), (line - runStart) * pitch);
+	}
+	[back setFrameNumber: [frame frameNumber]];
+}
+
+
+#pragma mark -
+#pragma mark Presenter methods
+
+- (BXFrameBuffer *) takeLatestFrame
+{
+	BXFrameBuffer *frame = nil;
+	NSTimeInterval now = CFAbsoluteTimeGetCurrent();
+
+	OSSpinLockLock(&slotLock);
+		if (readyIsFresh)
+		{
+			NSUInteger takenIndex = readyIndex;
+			readyIndex		= frontIndex;
+			frontIndex		= takenIndex;
+			readyIsFresh	= NO;
+			frame = buffers[frontIndex];
+
+			NSTimeInterval latency = now - publishTimes[frontIndex];
+			totalLatency += latency;
+			stats.maxLatency = MAX(stats.maxLatency, latency);
+
+			if (stats.framesPresented)
+			{
+				NSTimeInterval interval = now - lastPresentTime;
+				totalPresentInterval += interval;
+				stats.maxPresentInterval = MAX(stats.maxPresentInterval, interval);
+			}
+			lastPresentTime = now;
+			stats.framesPresented++;
+		}
+	OSSpinLockUnlock(&slotLock);
+
+	return frame;
+}
+
+- (BXFrameBuffer *) frontBuffer
+{
+	OSSpinLockLock(&slotLock);
+		BXFrameBuffer *frame = buffers[frontIndex];
+	OSSpinLockUnlock(&slotLock);
+	return frame;
+}
+
+
+#pragma mark -
+#pragma mark Statistics
+
+- (BXFramePacingStats) pacingStats
+{
+	OSSpinLockLock(&slotLock);
+		BXFramePacingStats currentStats = stats;
+		if (stats.framesPresented)
+			currentStats.meanLatency = totalLatency / stats.framesPresented;
+		if (stats.framesPresented > 1)
+			currentStats.meanPresentInterval = totalPresentInterval / (stats.framesPresented - 1);
+	OSSpinLockUnlock(&slotLock);
+	return currentStats;
+}
+
+- (void) resetPacingStats
+{
+	OSSpinLockLock(&slotLock);
+		memset(&stats, 0, sizeof(stats));
+		totalLatency			= 0;
+		totalPresentInterval	= 0;
+		lastPresentTime			= 0;
+	OSSpinLockUnlock(&slotLock);
+}
+
+@end
@@ -21,11 +21,14 @@
 #import <OpenGL/OpenGL.h>
 
 @class BXFrameBuffer;
+@class BXFrameExchange;
 @class Shader;
 
 @interface BXRenderer : NSObject
 {
 	BXFrameBuffer *currentFrame;
+	BXFrameExchange *frameExchange;
+	NSUInteger lastFrameNumber;
 	Shader *currentShader;
 	
 	BOOL supportsFBO;
@@ -58,6 +61,10 @@
 //Set using updateWithFrame:inGLContext:.
 @property (retain, readonly) BXFrameBuffer *currentFrame;
 
+//The exchange that frames are taken from when rendering, if the last frame came from one.
+//Set using updateWithFrame:inGLContext:.
+@property (retain) BXFrameExchange *frameExchange;
+
 //The current shader we are using to render with.
 @property (retain) Shader *currentShader;
 
@@ -85,6 +92,9 @@
 //Replaces the current frame with a new/updated one for rendering.
 //Next time renderToGLContext is called, the rendering state will be updated
 //to match the new frame and the new frame will be rendered. 
+//If the frame belongs to a BXFrameExchange, this touches no OpenGL state at all:
+//the latest frame is instead taken from the exchange when rendering, so that the
+//thread delivering frames never waits on the thread presenting them.
 - (void) updateWithFrame: (BXFrameBuffer *)frame inGLContext: (CGLContextObj)glContext;
 
 //Returns the maximum drawable frame size.
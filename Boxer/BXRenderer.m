@@ -12,6 +12,7 @@
 #import <OpenGL/CGLRenderers.h>
 #import "Shader.h"
 #import "BXFrameBuffer.h"
+#import "BXFrameExchange.h"
 #import "BXGeometry.h"
 
 //Documented but for some reason not present in OpenGL headers
@@ -30,6 +31,9 @@
 - (void) _prepareScalingBufferForFrame: (BXFrameBuffer *)frame inCGLContext: (CGLContextObj)glContext;
 - (void) _prepareFrameTextureForFrame: (BXFrameBuffer *)frame  inCGLContext: (CGLContextObj)glContext;
 
+//Switch to the specified frame, flagging whatever needs to be updated to render it.
+- (void) _useFrame: (BXFrameBuffer *)frame;
+
 //Render the specified frame into the specified GL context.
 - (void) _renderFrame: (BXFrameBuffer *)frame inCGLContext: (CGLContextObj)glContext;
 
@@ -51,11 +55,12 @@
 
 
 @implementation BXRenderer
-@synthesize currentFrame, currentShader, frameRate, renderingTime, canvas, maintainsAspectRatio;
+@synthesize currentFrame, frameExchange, currentShader, frameRate, renderingTime, canvas, maintainsAspectRatio;
 
 - (void) dealloc
 {
 	[self setCurrentFrame: nil], [currentFrame release];
+	[self setFrameExchange: nil], [frameExchange release];
 	[super dealloc];
 }
 
@@ -64,32 +69,50 @@
 #pragma mark Handling frame updates
 
 - (void) updateWithFrame: (BXFrameBuffer *)frame inGLContext: (CGLContextObj)context
-{   
+{
+    //Frames from an exchange are picked up by the presenting thread in renderToGLContext:.
+    //The exchange guarantees that the frame it hands over won't be drawn into while we're
+    //using it, so there's no need to take it up here to prevent tearing.
+    [self setFrameExchange: [frame exchange]];
+    if ([self frameExchange]) return;
+    
+    [self _useFrame: frame];
+    
+    //TWEAK: update our frame texture immediately with the new frame, while we know
+    //we have a complete frame in the buffer. (If we defer the update until it's time
+    //to render to the screen, then we may do it while DOS is in the middle of writing
+    //to the framebuffer: resulting in a 'torn' frame.)
+    [self _prepareFrameTextureForFrame: frame inCGLContext: context];
+}
+
+- (void) _useFrame: (BXFrameBuffer *)frame
+{
     if (frame != currentFrame)
 	{
-		//If the buffer memory locations for the two frames are different,
-        //we'll need to reinitialize the texture to link to the new buffer.
-        //This will be done next time we render.
-		if ([frame bytes] != [currentFrame bytes])
-			needsNewFrameTexture = YES;
-		
-		//If the buffers for the two frames are a different size,
-        //we'll need to recreate the scaling buffer when we next render too.
+        //Frame numbers start over with each new set of buffers
+        if ([frame exchange] != [currentFrame exchange])
+            needsNewFrameTexture = YES;
+        
+		//If the buffers for the two frames are a different size, we'll need to
+        //reinitialize the texture and recreate the scaling buffer when we next render.
 		if (!NSEqualSizes([frame size], [currentFrame size]))
+        {
+			needsNewFrameTexture = YES;
 			recalculateScalingBuffer = YES;
+        }
         
         [self setCurrentFrame: frame];
 	}
     
+    //If we skipped any frames from the exchange, the frame's dirty regions won't cover
+    //everything that changed since the texture was last filled: replace it outright.
+    if ([frame exchange] && [frame frameNumber] != lastFrameNumber + 1)
+        needsNewFrameTexture = YES;
+    lastFrameNumber = [frame frameNumber];
+    
     //Even if the frame hasn't changed, it may contain new data:
     //flag that we're dirty and need re-rendering.
     needsFrameTextureUpdate = YES;
-    
-    //TWEAK: update our frame texture immediately with the new frame, while we know
-    //we have a complete frame in the buffer. (If we defer the update until it's time
-    //to render to the screen, then we may do it while DOS is in the middle of writing
-    //to the framebuffer: resulting in a 'torn' frame.)
-    [self _prepareFrameTextureForFrame: frame inCGLContext: context];
 }
 
 - (CGSize) maxFrameSize
@@ -177,7 +200,7 @@
 
 - (BOOL) canRenderToGLContext: (CGLContextObj)glContext
 {
-	return [self currentFrame] != nil;
+	return [self currentFrame] != nil || [self frameExchange] != nil;
 }
 
 - (void) renderToGLContext: (CGLContextObj)glContext
@@ -188,7 +211,16 @@
     
     NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
     
+    //Take up the latest frame from the emulation thread, if there is a new one
+    BXFrameBuffer *latestFrame = [[self frameExchange] takeLatestFrame];
+    if (latestFrame) [self _useFrame: latestFrame];
+    
     BXFrameBuffer *frame = [self currentFrame];
+    if (!frame)
+    {
+        CGLUnlockContext(cgl_ctx);
+        return;
+    }
     
     [self _prepareFrameTextureForFrame: frame inCGLContext: cgl_ctx];
     [self _prepareScalingBufferForFrame: frame inCGLContext: cgl_ctx];
@@ -59,11 +59,12 @@ typedef struct {
 
 @class BXEmulator;
 @class BXFrameBuffer;
+@class BXFrameExchange;
 
 @interface BXVideoHandler : NSObject
 {
 	BXEmulator *emulator;
-	BXFrameBuffer *frameBuffer;
+	BXFrameExchange *frameExchange;
 	
 	NSInteger currentVideoMode;
 	BXFilterType filterType;
@@ -82,8 +83,12 @@ typedef struct {
 //Our parent emulator.
 @property (assign, nonatomic) BXEmulator *emulator;
 
-//The framebuffer we render our frames into.
-@property (retain, nonatomic) BXFrameBuffer *frameBuffer;
+//The triple-buffered set of framebuffers we render our frames into and hand over
+//to the presentation thread.
+@property (retain, nonatomic) BXFrameExchange *frameExchange;
+
+//The framebuffer DOSBox is currently rendering into: the back buffer of the exchange.
+@property (readonly, nonatomic) BXFrameBuffer *frameBuffer;
 
 //Whether to apply 4:3 aspect ratio correction to the rendered output.
 @property (assign, nonatomic, getter=isAspectCorrected) BOOL aspectCorrected;
@@ -9,6 +9,7 @@
 #import "BXVideoHandler.h"
 #import "BXEmulatorPrivate.h"
 #import "BXFrameBuffer.h"
+#import "BXFrameExchange.h"
 #import "BXGeometry.h"
 #import "BXFilterDefinitions.h"
 
@@ -40,11 +41,14 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 
 - (void) _applyAspectCorrectionToFrame: (BXFrameBuffer *)frame;
 
+//Logs how frames have been paced since the last video mode change, then starts counting afresh.
+- (void) _logPacingStats;
+
 @end
 
 
 @implementation BXVideoHandler
-@synthesize frameBuffer;
+@synthesize frameExchange;
 @synthesize emulator;
 @synthesize aspectCorrected;
 @synthesize filterType;
@@ -61,10 +65,15 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 
 - (void) dealloc
 {	
-	[self setFrameBuffer: nil], [frameBuffer release];
+	[self setFrameExchange: nil], [frameExchange release];
 	[super dealloc];
 }
 
+- (BXFrameBuffer *) frameBuffer
+{
+	return [[self frameExchange] backBuffer];
+}
+
 - (NSSize) resolution
 {
 	NSSize size = NSZeroSize;
@@ -166,6 +175,23 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 {
 	[self finishFrameWithChanges: 0];
 	if (callback) callback(GFX_CallBackStop);
+	[self _logPacingStats];
+}
+
+- (void) _logPacingStats
+{
+	BXFramePacingStats stats = [[self frameExchange] pacingStats];
+	if (stats.framesPublished)
+	{
+		NSLog(@"Frame pacing at %@: %lu frames finished, %lu presented, %lu dropped; latency %.1fms mean, %.1fms max; present interval %.1fms mean, %.1fms max",
+			  NSStringFromSize([[self frameExchange] size]),
+			  (unsigned long)stats.framesPublished,
+			  (unsigned long)stats.framesPresented,
+			  (unsigned long)stats.framesDropped,
+			  stats.meanLatency * 1000, stats.maxLatency * 1000,
+			  stats.meanPresentInterval * 1000, stats.maxPresentInterval * 1000);
+	}
+	[[self frameExchange] resetPacingStats];
 }
 
 
@@ -201,15 +227,21 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 	
 	callback = newCallback;
 	
-	//Check if we can reuse our existing framebuffer: if not, create a new one
-	if (!NSEqualSizes(outputSize, [[self frameBuffer] size]))
+	//Report how the previous mode was paced before we count frames for the new one
+	[self _logPacingStats];
+	
+	//Check if we can reuse our existing framebuffers: if not, create a new set
+	if (!NSEqualSizes(outputSize, [[self frameExchange] size]))
 	{
-		BXFrameBuffer *newBuffer = [BXFrameBuffer bufferWithSize: outputSize depth: 4];
-		[self setFrameBuffer: newBuffer];
+		BXFrameExchange *newExchange = [BXFrameExchange exchangeWithSize: outputSize depth: 4];
+		[self setFrameExchange: newExchange];
 	}
 	
-	[[self frameBuffer] setBaseResolution: [self resolution]];
-	[self _applyAspectCorrectionToFrame: [self frameBuffer]];
+	for (BXFrameBuffer *buffer in [[self frameExchange] buffers])
+	{
+		[buffer setBaseResolution: [self resolution]];
+		[self _applyAspectCorrectionToFrame: buffer];
+	}
 	
 	
 	//Send notifications if the display mode has changed
@@ -233,7 +265,7 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 		return NO;
 	}
 	
-	if (![self frameBuffer])
+	if (![self frameExchange])
 	{
 		NSLog(@"Tried to start a frame before any framebuffer was created!");
 		return NO;
@@ -250,7 +282,7 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
 
 - (void) finishFrameWithChanges: (const uint16_t *)dirtyBlocks
 {
-	if ([self frameBuffer] && dirtyBlocks)
+	if ([self frameExchange] && dirtyBlocks && frameInProgress)
 	{
         //Convert DOSBox's array of dirty blocks into a set of ranges
         NSUInteger i=0, currentOffset = 0, maxOffset = [[self frameBuffer] size].height;
@@ -271,8 +303,16 @@ const CGFloat BX4by3AspectRatio = (CGFloat)320.0 / (CGFloat)240.0;
             i++;
         }
         
-        [self.emulator _didFinishFrame: self.frameBuffer];
+        //Hand the finished frame over to the presentation thread: from here on
+        //DOSBox draws into a different buffer, so we never wait for it to be displayed.
+        BXFrameBuffer *finishedFrame = [[self frameExchange] publishBackBuffer];
+        [self.emulator _didFinishFrame: finishedFrame];
 	}
+    //DOSBox may have drawn some lines of an abandoned frame, which it won't redraw next time
+    else if (frameInProgress)
+    {
+        [[self frameExchange] discardBackBuffer];
+    }
 	frameInProgress = NO;
 }
 
@@ -71,7 +71,11 @@ This means that this file has had too many modifications to be safely replaceabl
 /* Define to 1 to use a x86 assembly fpu core */
 //--Modified 2009-02-26 by Alun Bestor to force this on for Intel
 
-#if defined(__i386__) || defined(__x86_64__)
+//--Modified 2026-10-19 as the assembly fpu core only builds for 32-bit x86:
+//x86-64 uses the portable core, which the dynamic core translates with SSE2
+//#if defined(__i386__) || defined(__x86_64__)
+#if defined(__i386__)
+//--End of modifications
 	#define C_FPU_X86 1
 #endif
 
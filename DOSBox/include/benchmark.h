@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DOSBOX_BENCHMARK_H
+#define DOSBOX_BENCHMARK_H
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+/* Benchmark mode turns off the pacing of the normal run loop so that it runs as
+   fast as the host allows, and uses the profiler to keep count of where the time
+   goes. In headless mode, video frames are dropped before they reach the GFX layer
+   and sound is mixed into a null sink instead of the audio device, so that only
+   the emulation itself is measured. */
+void BENCHMARK_Start(bool headless);
+/* Stops the benchmark and writes its report into buffer */
+void BENCHMARK_Stop(char * report,Bitu size);
+bool BENCHMARK_IsRunning(void);
+
+extern bool benchmark_running;
+
+/* Called around each run of the CPU core to count the speed of each core */
+void BENCHMARK_EnterCore(void);
+void BENCHMARK_LeaveCore(void);
+
+/* Charges the rest of the enclosing block to the CPU core that was current at its start */
+class BenchmarkCoreScope {
+public:
+	BenchmarkCoreScope() : active(benchmark_running) {
+		if (GCC_UNLIKELY(active)) BENCHMARK_EnterCore();
+	}
+	~BenchmarkCoreScope() {
+		if (GCC_UNLIKELY(active)) BENCHMARK_LeaveCore();
+	}
+private:
+	bool active;
+};
+
+/* Called by the renderer for every frame the emulated video card produces:
+   returns false if the frame should be dropped rather than drawn. */
+bool BENCHMARK_StartFrame(void);
+
+/* Replays a DRO capture through the DBOPL synth with and without its operator
+   pipeline, and reports the speed of each and whether their output matched. */
+bool OPL_BenchmarkDRO(const char * filename,char * report,Bitu size);
+
+/* Records what the GUS voices are told to do, along with the card's memory, into a trace */
+bool GUS_StartTrace(const char * filename);
+void GUS_StopTrace(void);
+/* Replays a GUS trace through the one-sample-at-a-time voice renderer and the
+   batched one, and reports the speed of each and whether their output matched. */
+bool GUS_BenchmarkTrace(const char * filename,char * report,Bitu size);
+
+/* Runs the VGA line drawers that have SIMD versions on random video memory, and
+   reports the speed of each version and whether their output matched. */
+bool VGA_BenchmarkDraw(char * report,Bitu size);
+
+#endif
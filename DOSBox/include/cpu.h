@@ -77,9 +77,48 @@ Bits CPU_Core_Dyn_X86_Run(void);
 Bits CPU_Core_Dyn_X86_Trap_Run(void);
 Bits CPU_Core_Dynrec_Run(void);
 Bits CPU_Core_Dynrec_Trap_Run(void);
+//--Added 2026-10-19 for inline TLB lookups
+/* Makes the recompiling core look up the TLB inline in the code it generates
+   (the default), or call out to the memory helpers for every access */
+void CPU_Core_Dynrec_SetInlineTLB(bool enabled);
+//--End of modifications
+//--Added 2026-10-19 for guest register caching
+/* Makes the recompiling core keep guest registers in host registers within
+   the blocks it translates (the default), or load and store them every time */
+void CPU_Core_Dynrec_SetRegisterCache(bool enabled);
+//--End of modifications
+//--Added 2026-10-19 for superblocks
+/* Makes the recompiling core continue blocks through the side of a conditional
+   jump that is taken most (the default), or end every block at a conditional jump */
+void CPU_Core_Dynrec_SetTraces(bool enabled);
+/* The number of conditional jumps that blocks were continued through, and how often
+   the translated code went on through them or left through the other side */
+void CPU_Core_Dynrec_GetTraceStats(Bitu & formed,Bitu & followed,Bitu & left,bool reset);
+//--End of modifications
+//--Added 2026-10-19 for adaptive self-modifying code handling
+/* Lists the pages whose code the recompiling core has seen modified in the
+   debugger, with how often and whether the code is translated, translated
+   with checks on every block entry or interpreted */
+void CPU_Core_Dynrec_ShowCodePages(void);
+//--End of modifications
+//--Added 2026-10-19 for automatic core selection
+/* The number of blocks the recompiling core has translated, and how often
+   translated code was invalidated because the code it came from was modified */
+void CPU_Core_Dynrec_GetCodeStats(Bitu & translated,Bitu & invalidated,bool reset);
+//--End of modifications
 Bits CPU_Core_Prefetch_Run(void);
 Bits CPU_Core_Prefetch_Trap_Run(void);
 
+//--Added 2026-10-19 for automatic core selection
+/* With core=auto the run loop calls the decoder through CPU_AutoCore_Run,
+   which measures the cores and switches between them */
+extern bool CPU_AutoCoreActive;
+Bits CPU_AutoCore_Run(void);
+/* Starts measuring the cores afresh, or with active false stops core=auto from
+   switching cores; call it whenever the core is set explicitly */
+void CPU_AutoCore_Reset(bool active);
+//--End of modifications
+
 void CPU_Enable_SkipAutoAdjust(void);
 void CPU_Disable_SkipAutoAdjust(void);
 void CPU_Reset_AutoAdjust(void);
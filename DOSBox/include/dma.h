@@ -30,6 +30,10 @@ enum DMAEvent {
 
 class DmaChannel;
 typedef void (* DMA_CallBack)(DmaChannel * chan,DMAEvent event);
+//--Added 2026-10-19 to save and load controller state
+class SaveStateWriter;
+class SaveStateReader;
+//--End of modifications
 
 class DmaChannel {
 public:
@@ -107,6 +111,10 @@ public:
 	}
 	void WriteControllerReg(Bitu reg,Bitu val,Bitu len);
 	Bitu ReadControllerReg(Bitu reg,Bitu len);
+	//--Added 2026-10-19 to save and load controller state
+	void SaveState(SaveStateWriter & state);
+	bool LoadState(SaveStateReader & state);
+	//--End of modifications
 };
 
 DmaChannel * GetDMAChannel(Bit8u chan);
@@ -82,6 +82,9 @@ public:
     //--Added 2011-11-03 by Alun Bestor to let Boxer inform open file handles
     //that their physical backing media will be removed.
     virtual void    willBecomeUnavailable()     { }
+    //--End of modifications
+    //--Added 2026-10-19 to let files write back any buffered data on commit.
+    virtual bool    Flush()                     { return true; }
     //--End of modifications
 	void SetDrive(Bit8u drv) { hdrive=drv;}
 	Bit8u GetDrive(void) { return hdrive;}
@@ -40,6 +40,11 @@ typedef Bitu (LoopHandler)(void);
 void DOSBOX_RunMachine();
 void DOSBOX_SetLoop(LoopHandler * handler);
 void DOSBOX_SetNormalLoop();
+//--Added 2026-10-19 to benchmark the emulation
+/* With pacing off, the normal loop runs every emulated millisecond as soon as
+   the previous one has finished instead of keeping in step with the host clock. */
+void DOSBOX_SetPacing(bool paced);
+//--End of modifications
 
 void DOSBOX_Init(void);
 
@@ -52,6 +52,19 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence);
 MemHandle MEM_NextHandle(MemHandle handle);
 MemHandle MEM_NextHandleAt(MemHandle handle,Bitu where);
 
+//--Added 2026-10-19: copy-on-write snapshots of guest RAM.
+//A snapshot is taken whenever a state is saved or loaded, and delta states are
+//encoded against it: only pages written since then are copied or compared.
+struct MEM_SnapshotStats {
+	Bitu total_pages;		//4 kb pages of guest RAM
+	Bitu dirty_pages;		//4 kb pages modified since the last state was saved or loaded
+	double snapshot_ms;		//Time taken to take the last snapshot
+	double restore_ms;		//Time taken to roll back to the last snapshot when loading a delta
+};
+
+void MEM_GetSnapshotStats(MEM_SnapshotStats * stats);
+//--End of modifications
+
 /* 
 	The folowing six functions are used everywhere in the end so these should be changed for
 	Working on big or little endian machines 
@@ -27,6 +27,9 @@
 
 typedef void (*MIXER_MixHandler)(Bit8u * sampdate,Bit32u len);
 typedef void (*MIXER_Handler)(Bitu len);
+//--Added 2026-10-19 for idle channels
+typedef void (*MIXER_IdleHandler)(void);
+//--End of modifications
 
 enum BlahModes {
 	MIXER_8MONO,MIXER_8STEREO,
@@ -77,6 +80,21 @@ public:
 	void AddStretched(Bitu len,Bit16s * data);		//Strech block up into needed data
 	void FillUp(void);
 	void Enable(bool _yesno);
+	//--Added 2026-10-19 to stop calling the handlers of idle devices
+	/* Called by the handler once it will produce nothing but silence until its
+	   device is next written to: the mixer stops calling it and mixes silence instead.
+	   While asleep the mixer calls idle, if given, once every mixer tick, so that
+	   the device can still switch the channel off after a long enough silence. */
+	void Sleep(MIXER_IdleHandler idle=0);
+	/* Called by the device before it acts on a write. Returns how many samples of
+	   silence were mixed in place of the handler, for devices that keep time. */
+	Bitu WakeUp(void);
+	bool sleeping;
+	Bitu slept_index;
+	MIXER_IdleHandler idle;
+	/* Milliseconds the channel has spent enabled and calling its handler, and enabled but asleep */
+	Bitu awake_ms,asleep_ms;
+	//--End of modifications
 	MIXER_Handler handler;
 	float volmain[2];
 	float scale;
@@ -93,6 +111,10 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
 MixerChannel * MIXER_FindChannel(const char * name);
 /* Find the device you want to delete with findchannel "delchan gets deleted" */
 void MIXER_DelChannel(MixerChannel* delchan); 
+//--Added 2026-10-19 to let benchmarks run without an audio device
+/* Mixes everything as usual but discards the result instead of playing it */
+void MIXER_SetNullSink(bool enable);
+//--End of modifications
 
 /* Object to maintain a mixerchannel; As all objects it registers itself with create
  * and removes itself when destroyed. */
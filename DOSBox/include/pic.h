@@ -62,6 +62,11 @@ bool PIC_RunQueue(void);
 void PIC_AddEvent(PIC_EventHandler handler,float delay,Bitu val=0);
 void PIC_RemoveEvents(PIC_EventHandler handler);
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, Bitu val);
+//--Added 2026-10-19 so that only events of devices with saved state are saved.
+//Events from these handlers are saved and loaded along with the PIC; events
+//from any other handler are left in the queue as they are when a state is loaded.
+void PIC_AddStateEvent(PIC_EventHandler handler);
+//--End of modifications
 
 void PIC_SetIRQMask(Bitu irq, bool masked);
 #endif
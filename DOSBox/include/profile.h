@@ -0,0 +1,92 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DOSBOX_PROFILE_H
+#define DOSBOX_PROFILE_H
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+#ifndef CH_STRING
+#define CH_STRING
+#include <string>
+#endif
+
+/* The profiler splits the host time spent in each emulated video frame between
+   the parts of the emulator, and keeps a histogram of each part's time per frame.
+   It is always compiled in but does nothing until switched on with PROF.COM or
+   the debugger, so the scopes below cost a single test when it is off. */
+
+enum ProfileSection {
+	PROFILE_OTHER,		//Anything not inside one of the scopes below
+	PROFILE_CPU,		//Running the CPU core, including port and memory handlers
+	PROFILE_CALLBACKS,	//BIOS and DOS emulation
+	PROFILE_EVENTS,		//PIC events not covered below
+	PROFILE_TICKS,		//Timer tick handlers not covered below
+	PROFILE_MIXER,		//Mixing the sound channels
+	PROFILE_VGA,		//Drawing the lines of the emulated display
+	PROFILE_RENDER,		//Scaling the lines into the output buffer
+	PROFILE_PRESENT,	//Handing finished frames to the GFX layer
+	PROFILE_HOST,		//Host events and state requests
+	PROFILE_IDLE,		//Waiting for the host clock
+	PROFILE_SECTIONS
+};
+
+enum ProfileFormat {
+	PROFILE_TEXT,
+	PROFILE_CSV,
+	PROFILE_JSON
+};
+
+extern bool profile_enabled;
+
+/* Charges the time from here on to section, until the matching PROFILE_Leave */
+void PROFILE_Enter(ProfileSection section);
+void PROFILE_Leave(void);
+
+/* Times the rest of the enclosing block */
+class ProfileScope {
+public:
+	ProfileScope(ProfileSection section) : active(profile_enabled) {
+		if (GCC_UNLIKELY(active)) PROFILE_Enter(section);
+	}
+	~ProfileScope() {
+		if (GCC_UNLIKELY(active)) PROFILE_Leave();
+	}
+private:
+	bool active;
+};
+
+/* Called by the VGA at the start of every emulated frame */
+void PROFILE_Frame(void);
+/* Called by the run loop for every emulated millisecond it runs, and for
+   every millisecond it drops because the emulation fell too far behind */
+void PROFILE_Tick(void);
+void PROFILE_DropTicks(Bitu ms);
+
+void PROFILE_Start(void);
+void PROFILE_Stop(void);
+void PROFILE_Reset(void);
+/* Writes the statistics gathered since the profiler was started or reset */
+void PROFILE_Report(std::string & out,ProfileFormat format);
+/* Appends the statistics of every emulated second to a host file, as a CSV row
+   or a line of JSON, until stopped with a null filename */
+bool PROFILE_SetStream(const char * filename,ProfileFormat format);
+
+#endif
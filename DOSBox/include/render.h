@@ -29,7 +29,10 @@
 
 #define RENDER_SKIP_CACHE	16
 //Enable this for scalers to support 0 input for empty lines
+//--Modified 2026-10-19: the VGA passes lines it knows to be unchanged as 0
 //#define RENDER_NULL_INPUT
+#define RENDER_NULL_INPUT
+//--End of modifications
 
 typedef struct {
 	struct { 
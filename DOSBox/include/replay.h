@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DOSBOX_REPLAY_H
+#define DOSBOX_REPLAY_H
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+#include <time.h>
+
+/* A replay is a saved state followed by a log of everything that reached the
+   emulated machine from outside: input events and changes to the cycle count,
+   each keyed to the emulated millisecond tick it took effect on. While
+   recording or replaying, input is held back and delivered at the start of the
+   next tick, so that it lands on exactly the same instruction both times. */
+
+/* Input hooks: these return true if the event has been taken over by the
+   replay system, in which case the caller must not process it itself. */
+bool REPLAY_KeyEvent(Bitu key,bool pressed);
+bool REPLAY_MouseMoveEvent(float xrel,float yrel,float x,float y,bool emulate);
+bool REPLAY_MouseButtonEvent(Bit8u button,bool pressed);
+bool REPLAY_JoystickAxisEvent(Bitu which,Bitu axis,float position);
+bool REPLAY_JoystickButtonEvent(Bitu which,Bitu num,bool pressed);
+
+/* Called at the start of every emulated millisecond, before TIMER_AddTick */
+void REPLAY_Tick(void);
+
+/* The host time as the emulated machine should see it: while recording or
+   replaying this is the time the recording started plus the emulated time since. */
+time_t REPLAY_HostTime(void);
+
+/* While replaying, the emulation runs as fast as it can rather than in step with the host clock */
+bool REPLAY_IsPlaying(void);
+
+struct REPLAY_Result {
+	Bitu emulated_ms;
+	double wall_ms;
+};
+/* Called with the timings of a replay once it has finished */
+typedef void (*REPLAY_FinishHandler)(const REPLAY_Result & result);
+
+void REPLAY_RequestRecord(const char * filename);
+void REPLAY_RequestPlay(const char * filename,REPLAY_FinishHandler handler=0);
+void REPLAY_RequestStop(void);
+
+#endif
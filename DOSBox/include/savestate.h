@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DOSBOX_SAVESTATE_H
+#define DOSBOX_SAVESTATE_H
+
+#ifndef DOSBOX_DOSBOX_H
+#include "dosbox.h"
+#endif
+
+#ifndef CH_STRING
+#define CH_STRING
+#include <string>
+#endif
+
+#include <vector>
+
+/* Bump this whenever the layout of any module's state changes */
+#define SAVESTATE_VERSION 1
+
+/* Offset of a function from a fixed point in the binary: this lets function
+   pointers (such as PIC event handlers) survive address space randomisation,
+   though not a rebuild. The state header carries a fingerprint to catch that. */
+Bit64s SAVESTATE_FunctionOffset(void (*func)(void));
+void (*SAVESTATE_FunctionFromOffset(Bit64s offset))(void);
+
+class SaveStateWriter {
+public:
+	SaveStateWriter(std::vector<Bit8u> & _buffer,Bit64u _serial,bool _delta)
+		:buffer(_buffer),serial(_serial),delta(_delta) {}
+
+	void WriteB(Bit8u val)			{ buffer.push_back(val); }
+	void WriteW(Bit16u val)			{ WriteB((Bit8u)val); WriteB((Bit8u)(val>>8)); }
+	void WriteD(Bit32u val)			{ WriteW((Bit16u)val); WriteW((Bit16u)(val>>16)); }
+	void WriteQ(Bit64u val)			{ WriteD((Bit32u)val); WriteD((Bit32u)(val>>32)); }
+	void WriteBool(bool val)		{ WriteB(val ? 1 : 0); }
+	void WriteFloat(float val);
+	void WriteDouble(double val);
+	void WriteBytes(const void * data,Bitu size);
+	void WriteString(const char * str);
+	/* Register blocks that are plain structures: the size is stored alongside
+	   so that a mismatched layout is refused rather than misread. */
+	void WriteBlock(const void * data,Bitu size) { WriteD((Bit32u)size); WriteBytes(data,size); }
+	template <class T> void WriteFunction(T func) {
+		WriteQ((Bit64u)SAVESTATE_FunctionOffset(reinterpret_cast<void (*)(void)>(func)));
+	}
+
+	/* Identifies the state being written, for delta-encoding against it later */
+	Bit64u Serial(void) const	{ return serial; }
+	/* Whether modules may encode their data against the previously saved state */
+	bool Delta(void) const		{ return delta; }
+	Bitu Size(void) const		{ return buffer.size(); }
+	/* Direct access for bulk encoders, which reserve space and fill it in */
+	Bit8u * Reserve(Bitu size)	{ Bitu pos=buffer.size(); buffer.resize(pos+size); return &buffer[pos]; }
+	void Truncate(Bitu size)	{ buffer.resize(size); }
+private:
+	std::vector<Bit8u> & buffer;
+	Bit64u serial;
+	bool delta;
+};
+
+class SaveStateReader {
+public:
+	SaveStateReader(const Bit8u * _data,Bitu _size,Bit64u _serial,bool _checking=false)
+		:data(_data),size(_size),pos(0),serial(_serial),failed(false),checking(_checking) {}
+
+	Bit8u ReadB(void)				{ if (pos>=size) { failed=true; return 0; } return data[pos++]; }
+	Bit16u ReadW(void)				{ Bit16u lo=ReadB(); return lo|(ReadB()<<8); }
+	Bit32u ReadD(void)				{ Bit32u lo=ReadW(); return lo|((Bit32u)ReadW()<<16); }
+	Bit64u ReadQ(void)				{ Bit64u lo=ReadD(); return lo|((Bit64u)ReadD()<<32); }
+	bool ReadBool(void)				{ return ReadB()!=0; }
+	float ReadFloat(void);
+	double ReadDouble(void);
+	bool ReadBytes(void * dest,Bitu len);
+	std::string ReadString(void);
+	bool ReadBlock(void * dest,Bitu len);
+	template <class T> T ReadFunction(void) {
+		return reinterpret_cast<T>(SAVESTATE_FunctionFromOffset((Bit64s)ReadQ()));
+	}
+	/* Returns a pointer to the next len bytes and skips over them, or 0 if there aren't enough */
+	const Bit8u * Skip(Bitu len)	{ if (size-pos<len) { failed=true; return 0; } pos+=len; return data+pos-len; }
+
+	Bit64u Serial(void) const		{ return serial; }
+	/* Set while the state is only being checked before anything is loaded: modules
+	   must then read all of their state and report whether it would load, but leave
+	   everything as it is. ReadBytes and ReadBlock only skip over the data. */
+	bool Checking(void) const		{ return checking; }
+	Bitu Remaining(void) const		{ return size-pos; }
+	/* Set when a read ran past the end of the data or a block did not match */
+	bool Failed(void) const			{ return failed; }
+	void Fail(void)					{ failed=true; }
+private:
+	const Bit8u * data;
+	Bitu size;
+	Bitu pos;
+	Bit64u serial;
+	bool failed;
+	bool checking;
+};
+
+/* Subsystems that are not Module_base subclasses register their state with these.
+   Load handlers are checked first just like Module_base::LoadState. */
+typedef void (*SAVESTATE_SaveHandler)(SaveStateWriter & state);
+typedef bool (*SAVESTATE_LoadHandler)(SaveStateReader & state);
+void SAVESTATE_AddHandler(const char * name,SAVESTATE_SaveHandler save,SAVESTATE_LoadHandler load);
+void SAVESTATE_DelHandler(const char * name);
+
+/* Module_base registers itself through these */
+class Module_base;
+void SAVESTATE_AddModule(Module_base * module);
+void SAVESTATE_DelModule(Module_base * module);
+
+/* Save the whole machine into buffer. With delta set, modules may encode their
+   data against the last state saved or loaded, which must then be present when
+   loading the result. */
+bool SAVESTATE_Save(std::vector<Bit8u> & buffer,bool delta=false);
+/* Every module's state is checked before any of it is loaded: if anything in
+   it can't be loaded, the machine is left untouched and this returns false. */
+bool SAVESTATE_Load(const Bit8u * data,Bitu size);
+bool SAVESTATE_SaveFile(const char * filename);
+bool SAVESTATE_LoadFile(const char * filename);
+
+/* Saving and loading from outside the emulation is deferred to the next
+   millisecond boundary of the run loop, where the machine state is consistent. */
+void SAVESTATE_RequestSave(const char * filename);
+void SAVESTATE_RequestLoad(const char * filename);
+void SAVESTATE_RunRequests(void);
+
+#endif
@@ -317,15 +317,33 @@ public:
 	std::string data;
 };
 
+//--Added 2026-10-19 to let modules save and load their state
+class Module_base;
+class SaveStateWriter;
+class SaveStateReader;
+void SAVESTATE_AddModule(Module_base * module);
+void SAVESTATE_DelModule(Module_base * module);
+//--End of modifications
+
 class Module_base {
 	/* Base for all hardware and software "devices" */
 protected:
 	Section* m_configuration;
 public:
-	Module_base(Section* configuration){m_configuration=configuration;};
+	//--Modified 2026-10-19 to register each module for saving and loading state
+	Module_base(Section* configuration){m_configuration=configuration;SAVESTATE_AddModule(this);};
 //	Module_base(Section* configuration, SaveState* state) {};
-	virtual ~Module_base(){/*LOG_MSG("executed")*/;};//Destructors are required
+	virtual ~Module_base(){/*LOG_MSG("executed")*/;SAVESTATE_DelModule(this);};//Destructors are required
+	//--End of modifications
 	/* Returns true if succesful.*/
 	virtual bool Change_Config(Section* /*newconfig*/) {return false;} ;
+	//--Added 2026-10-19 to let modules save and load their state
+	/* Modules with state worth saving return a unique name for it here. */
+	virtual const char * GetStateName(void) {return 0;}
+	virtual void SaveState(SaveStateWriter & /*state*/) {}
+	/* Returns false if the state could not be restored. This is called once with
+	   state.Checking() set before anything is loaded, and must then change nothing. */
+	virtual bool LoadState(SaveStateReader & /*state*/) {return true;}
+	//--End of modifications
 };
 #endif
@@ -29,6 +29,11 @@
 
 #define GetTicks() SDL_GetTicks()
 
+//--Added 2026-10-19: a microsecond-resolution host clock for profiling,
+//since SDL_GetTicks is too coarse to measure individual operations.
+Bit64u GetMicroTicks(void);
+//--End of modifications
+
 typedef void (*TIMER_TickHandler)(void);
 
 /* Register a function that gets called everytime if 1 or more ticks pass */
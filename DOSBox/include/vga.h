@@ -27,7 +27,10 @@
 
 //Don't enable keeping changes and mapping lfb probably...
 #define VGA_LFB_MAPPED
+//--Modified 2026-10-19 to track VRAM writes, so that lines whose memory is untouched are not redrawn
 //#define VGA_KEEP_CHANGES
+#define VGA_KEEP_CHANGES
+//--End of modifications
 #define VGA_CHANGE_SHIFT	9
 
 class PageHandler;
@@ -363,12 +366,19 @@ typedef struct {
 
 typedef struct {
 	//Add a few more just to be safe
-	Bit8u*	map; /* allocated dynamically: [(VGA_MEMORY >> VGA_CHANGE_SHIFT) + 32] */
+	//--Modified 2026-10-19: the map also covers the pixel buffer, which is twice as big
+	Bit8u*	map; /* allocated dynamically: [((VGA_MEMORY << 1) >> VGA_CHANGE_SHIFT) + 32] */
+	//--End of modifications
 	Bit8u	checkMask, frame, writeMask;
 	bool	active;
 	Bit32u  clearMask;
 	Bit32u	start, last;
 	Bit32u	lastAddress;
+	//--Added 2026-10-19 for skipping unchanged lines
+	Bitu	mapSize;
+	bool	skip;		/* Lines with no changes in the map may be left out of this frame */
+	bool	refresh;	/* Something besides VRAM changed, draw the next frame in full */
+	//--End of modifications
 } VGA_Changes;
 
 typedef struct {
@@ -417,6 +427,9 @@ void VGA_DetermineMode(void);
 void VGA_SetupHandlers(void);
 void VGA_StartResize(Bitu delay=50);
 void VGA_SetupDrawing(Bitu val);
+//--Added 2026-10-19 to save the drawing events along with the video state
+void VGA_AddStateEvents(void);
+//--End of modifications
 void VGA_CheckScanLength(void);
 void VGA_ChangedBank(void);
 
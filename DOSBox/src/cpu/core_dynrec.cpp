@@ -52,8 +52,14 @@
 #include "inout.h"
 #include "lazyflags.h"
 #include "pic.h"
-
-#define CACHE_MAXSIZE	(4096*2)
+//--Added 2026-10-19 for SSE2 FPU translation
+#include "fpu.h"
+//--End of modifications
+
+//--Modified 2026-10-19 to leave room for inline TLB lookups
+//#define CACHE_MAXSIZE	(4096*2)
+#define CACHE_MAXSIZE	(4096*3)
+//--End of modifications
 #define CACHE_TOTAL		(1024*1024*8)
 #define CACHE_PAGES		(512)
 #define CACHE_BLOCKS	(128*1024)
@@ -61,6 +67,15 @@
 #define DYN_HASH_SHIFT	(4)
 #define DYN_PAGE_HASH	(4096>>DYN_HASH_SHIFT)
 #define DYN_LINKS		(16)
+//--Added 2026-10-19 for superblocks
+#define DYN_TRACE_THRESHOLD	(256)	// exits through one side of a conditional jump before tracing through it
+#define DYN_TRACE_MAXSKIP	(256)	// longest forward jump that is traced through
+//--End of modifications
+//--Added 2026-10-19 for adaptive self-modifying code handling
+#define DYN_SMC_LIMIT	(32)	// invalidations of a page per review that make it change its policy
+#define DYN_SMC_PERIOD	(1000)	// milliseconds after which the policy of a page is reviewed
+#define DYN_SMC_SLICE	(32)	// instructions run by the normal core at a time in interpreted pages
+//--End of modifications
 
 #if 0
 #define DYN_LOG	LOG_MSG
@@ -115,7 +130,13 @@ enum BlockReturn {
 #endif
 	BR_Iret,
 	BR_CallBack,
-	BR_SMCBlock
+	BR_SMCBlock,
+	//--Added 2026-10-19 for superblocks
+	BR_Trace1,BR_Trace2,BR_TraceCheck,
+	//--End of modifications
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	BR_SMCCheck
+	//--End of modifications
 };
 
 // identificator to signal self-modification of the currently executed block
@@ -131,6 +152,20 @@ static struct {
 	Bitu callback;				// the occurred callback
 	Bitu readdata;				// spare space used when reading from memory
 	Bit32u protected_regs[8];	// space to save/restore register values
+	//--Added 2026-10-19 for inline TLB lookups
+	bool inline_tlb;			// translate memory accesses with inline TLB lookups
+	bool cache_regs;			// keep guest registers in host registers within blocks
+	//--End of modifications
+	//--Added 2026-10-19 for superblocks
+	bool traces;				// continue blocks through the hot side of conditional jumps
+	Bit32u trace_formed;		// conditional jumps that were traced through
+	Bit32u trace_followed;		// times the translated code continued through them
+	Bit32u trace_left;			// times it left the block through the other side instead
+	//--End of modifications
+	//--Added 2026-10-19 for automatic core selection
+	Bit32u blocks_translated;	// blocks translated since the stats were last reset
+	Bit32u smc_invalidations;	// writes or checks that found translated code modified since then
+	//--End of modifications
 } core_dynrec;
 
 
@@ -173,6 +208,37 @@ CacheBlockDynRec * LinkBlocks(BlockReturn ret) {
 	return NULL;
 }
 
+//--Added 2026-10-19 for superblocks
+// one side of the conditional jump that closes the last block has been taken
+// DYN_TRACE_THRESHOLD times; if the other side was taken rarely, have the block
+// translated again to continue through the jump (see dyn_branched_exit)
+static void TraceBlock(BlockReturn ret) {
+	CacheBlockDynRec * block=cache.block.running;
+	if (!block || !block->page.handler || !block->trace.handler) return;
+	Bitu side=(ret==BR_Trace2) ? 1 : 0;
+	Bit32u other=DYN_TRACE_THRESHOLD-trace_counts[block-cache_blocks][side^1];
+	if (other>DYN_TRACE_THRESHOLD/16) return;
+	block->trace.handler->SetTraceSide(block->trace.index,side);
+	block->Clear();
+}
+
+// the side exit of a block continued through a conditional jump has been taken
+// DYN_TRACE_THRESHOLD/16 times; unless the traced side was taken at least 16
+// times as often meanwhile, the jump is counted again in a plain block
+static void UntraceBlock(void) {
+	CacheBlockDynRec * block=cache.block.running;
+	if (!block || !block->page.handler || !block->trace.handler) return;
+	Bit32u * counts=trace_counts[block-cache_blocks];
+	if (counts[1]>=DYN_TRACE_THRESHOLD) {
+		counts[0]=DYN_TRACE_THRESHOLD/16;
+		counts[1]=0;
+		return;
+	}
+	block->trace.handler->ClearTraceSide(block->trace.index);
+	block->Clear();
+}
+//--End of modifications
+
 /*
 	The core tries to find the block that should be executed next.
 	If such a block is found, it is run, otherwise the instruction
@@ -204,6 +270,29 @@ Bits CPU_Core_Dynrec_Run(void) {
 		// page doesn't contain code or is special
 		if (GCC_UNLIKELY(!chandler)) return CPU_Core_Normal_Run();
 
+		//--Added 2026-10-19 for adaptive self-modifying code handling
+		if (GCC_UNLIKELY(chandler->smc_policy!=SMC_BLOCKS)) {
+			chandler->ReviewPolicy();
+			if (chandler->smc_policy==SMC_INTERPRET) {
+				// the code in this page is modified too often to be worth
+				// translating, let the normal core run a few instructions
+				if (CPU_Cycles<=0) return CBRET_NONE;
+				Bits slice=(CPU_Cycles>DYN_SMC_SLICE) ? DYN_SMC_SLICE : CPU_Cycles;
+				Bits rest_cycles=CPU_Cycles-slice;
+				CPU_Cycles=slice;
+				Bits nc_retcode=CPU_Core_Normal_Run();
+				// the normal core leaves CPU_Cycles at -1 once the slice is used up;
+				// carry on unless an instruction like hlt switched the decoder
+				if (!nc_retcode && cpudecoder==&CPU_Core_Dynrec_Run) {
+					CPU_Cycles=rest_cycles;
+					continue;
+				}
+				CPU_CycleLeft+=rest_cycles;
+				return nc_retcode;
+			}
+		}
+		//--End of modifications
+
 		// find correct Dynamic Block to run
 		CacheBlockDynRec * block=chandler->FindCacheBlock(ip_point&4095);
 		if (!block) {
@@ -293,6 +382,27 @@ run_block:
 			if (block) goto run_block;
 			break;
 
+		//--Added 2026-10-19 for superblocks
+		case BR_Trace1:
+		case BR_Trace2:
+			TraceBlock(ret);
+			break;
+
+		case BR_TraceCheck:
+			UntraceBlock();
+			break;
+		//--End of modifications
+
+		//--Added 2026-10-19 for adaptive self-modifying code handling
+		case BR_SMCCheck:
+			// the code of the block has been modified since it was translated,
+			// nothing of it has run yet so it can simply be translated again
+			block=cache.block.running;
+			block->page.handler->NoteInvalidation();
+			block->Clear();
+			break;
+		//--End of modifications
+
 		default:
 			E_Exit("Invalid return code %d", ret);
 		}
@@ -320,6 +430,13 @@ Bits CPU_Core_Dynrec_Trap_Run(void) {
 }
 
 void CPU_Core_Dynrec_Init(void) {
+	//--Added 2026-10-19 for inline TLB lookups and guest register caching
+	core_dynrec.inline_tlb=true;
+	core_dynrec.cache_regs=true;
+	//--End of modifications
+	//--Added 2026-10-19 for superblocks
+	core_dynrec.traces=true;
+	//--End of modifications
 }
 
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache) {
@@ -331,4 +448,63 @@ void CPU_Core_Dynrec_Cache_Close(void) {
 	cache_close();
 }
 
+//--Added 2026-10-19 for inline TLB lookups and guest register caching
+// throw away all translated code, so that it is translated again with new options
+static void dyn_clear_cache(void) {
+	while (cache.used_pages) cache.used_pages->ClearRelease();
+}
+
+void CPU_Core_Dynrec_SetInlineTLB(bool enabled) {
+	if (core_dynrec.inline_tlb==enabled) return;
+	core_dynrec.inline_tlb=enabled;
+	dyn_clear_cache();
+}
+
+void CPU_Core_Dynrec_SetRegisterCache(bool enabled) {
+	if (core_dynrec.cache_regs==enabled) return;
+	core_dynrec.cache_regs=enabled;
+	dyn_clear_cache();
+}
+//--End of modifications
+
+//--Added 2026-10-19 for superblocks
+void CPU_Core_Dynrec_SetTraces(bool enabled) {
+	if (core_dynrec.traces==enabled) return;
+	core_dynrec.traces=enabled;
+	dyn_clear_cache();
+}
+
+void CPU_Core_Dynrec_GetTraceStats(Bitu & formed,Bitu & followed,Bitu & left,bool reset) {
+	formed=core_dynrec.trace_formed;
+	followed=core_dynrec.trace_followed;
+	left=core_dynrec.trace_left;
+	if (reset) core_dynrec.trace_formed=core_dynrec.trace_followed=core_dynrec.trace_left=0;
+}
+//--End of modifications
+
+//--Added 2026-10-19 for automatic core selection
+void CPU_Core_Dynrec_GetCodeStats(Bitu & translated,Bitu & invalidated,bool reset) {
+	translated=core_dynrec.blocks_translated;
+	invalidated=core_dynrec.smc_invalidations;
+	if (reset) core_dynrec.blocks_translated=core_dynrec.smc_invalidations=0;
+}
+//--End of modifications
+
+//--Added 2026-10-19 for adaptive self-modifying code handling
+#if C_DEBUG
+void CPU_Core_Dynrec_ShowCodePages(void) {
+	static const char * policies[]={ "blocks","checked","interpret" };
+	DEBUG_ShowMsg("DYNREC: code pages (page, policy, invalidations since review/total, policy changes)\n");
+	Bitu count=0;
+	for (CodePageHandlerDynRec * page=cache.used_pages;page;page=page->next) {
+		if (!page->smc_total && (page->smc_policy==SMC_BLOCKS)) continue;
+		DEBUG_ShowMsg("%05X %-9s %5u/%-8u %u\n",(unsigned int)page->PhysPage(),policies[page->smc_policy],
+			(unsigned int)page->smc_count,(unsigned int)page->smc_total,(unsigned int)page->smc_changes);
+		count++;
+	}
+	if (!count) DEBUG_ShowMsg("DYNREC: no code page has been modified.\n");
+}
+#endif
+//--End of modifications
+
 #endif
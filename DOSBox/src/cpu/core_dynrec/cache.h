@@ -19,6 +19,16 @@
 
 class CodePageHandlerDynRec;	// forward
 
+//--Added 2026-10-19 for adaptive self-modifying code handling
+// how the code in a page is run, pages whose code is modified too often
+// go down this list and come back up when they have been left alone
+enum SMCPolicy {
+	SMC_BLOCKS,			// translated blocks, writes to their code invalidate them
+	SMC_CHECKED,		// translated blocks that compare a hash of their code on entry
+	SMC_INTERPRET		// the normal core runs the code
+};
+//--End of modifications
+
 // basic cache block representation
 class CacheBlockDynRec {
 public:
@@ -55,6 +65,18 @@ public:
 		CacheBlockDynRec * from;	// the from-block can transfer control to this block
 	} link[2];	// maximal two links (conditional jumps)
 	CacheBlockDynRec * crossblock;
+	//--Added 2026-10-19 for superblocks
+	struct {
+		CodePageHandlerDynRec * handler;	// page containing the conditional jump that closes
+		Bit16u index;						// this block, if its exits are counted
+	} trace;
+	//--End of modifications
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	struct {
+		bool active;		// the block compares the hash on entry, so writes needn't clear it
+		Bit32u hash;		// hash of the code in the first page of the block
+	} check;
+	//--End of modifications
 };
 
 static struct {
@@ -79,6 +101,13 @@ static Bit8u * cache_code_link_blocks=NULL;
 static CacheBlockDynRec * cache_blocks=NULL;
 static CacheBlockDynRec link_blocks[2];		// default linking (specially marked)
 
+//--Added 2026-10-19 for superblocks
+// the exits left through either side of the conditional jump closing a block
+// before it is retranslated to continue through that side, counted down by
+// the translated code
+static Bit32u trace_counts[CACHE_BLOCKS][2];
+//--End of modifications
+
 
 // the CodePageHandlerDynRec class provides access to the contained
 // cache blocks and intercepts writes to the code for special treatment
@@ -86,6 +115,9 @@ class CodePageHandlerDynRec : public PageHandler {
 public:
 	CodePageHandlerDynRec() {
 		invalidation_map=NULL;
+		//--Added 2026-10-19 for superblocks
+		trace_map=NULL;
+		//--End of modifications
 	}
 
 	void SetupAt(Bitu _phys_page,PageHandler * _old_pagehandler) {
@@ -102,6 +134,14 @@ public:
 		active_blocks=0;
 		active_count=16;
 
+		//--Added 2026-10-19 for adaptive self-modifying code handling
+		smc_policy=SMC_BLOCKS;
+		smc_count=0;
+		smc_since=PIC_Ticks;
+		smc_total=0;
+		smc_changes=0;
+		//--End of modifications
+
 		// initialize the maps with zero (no cache blocks as well as code present)
 		memset(&hash_map,0,sizeof(hash_map));
 		memset(&write_map,0,sizeof(write_map));
@@ -109,7 +149,73 @@ public:
 			free(invalidation_map);
 			invalidation_map=NULL;
 		}
+		//--Added 2026-10-19 for superblocks
+		if (trace_map!=NULL) {
+			free(trace_map);
+			trace_map=NULL;
+		}
+		//--End of modifications
+	}
+
+	//--Added 2026-10-19 for superblocks
+	// note the side (0 not taken, 1 taken) of the conditional jump at index
+	// that the blocks translated from now on should continue through
+	void SetTraceSide(Bitu index,Bitu side) {
+		if (!trace_map) {
+			trace_map=(Bit8u*)malloc(4096);
+			memset(trace_map,0,4096);
+		}
+		trace_map[index]=(Bit8u)(1<<side);
+	}
+
+	// go back to counting the exits through both sides of the jump at index
+	void ClearTraceSide(Bitu index) {
+		if (trace_map) trace_map[index]=0;
+	}
+	//--End of modifications
+
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	// the code of this page has been modified, switch to a more careful
+	// policy if that happened too often since the last review
+	void NoteInvalidation(void) {
+		ReviewPolicy();
+		smc_total++;
+		//--Added 2026-10-19 for automatic core selection
+		core_dynrec.smc_invalidations++;
+		//--End of modifications
+		if ((++smc_count>=DYN_SMC_LIMIT) && (smc_policy!=SMC_INTERPRET))
+			SetPolicy((SMCPolicy)(smc_policy+1));
+	}
+	// reconsider the policy after a while, a page that has hardly
+	// been modified since goes back to a faster one
+	void ReviewPolicy(void) {
+		if ((Bitu)(PIC_Ticks-smc_since)<DYN_SMC_PERIOD) return;
+		if ((smc_policy!=SMC_BLOCKS) && (smc_count<DYN_SMC_LIMIT/4))
+			SetPolicy((SMCPolicy)(smc_policy-1));
+		else {
+			smc_count=0;
+			smc_since=PIC_Ticks;
+		}
+	}
+	// blocks that were translated before keep the policy they were
+	// translated with, InvalidateRange tells them apart
+	void SetPolicy(SMCPolicy policy) {
+		smc_policy=policy;
+		smc_count=0;
+		smc_since=PIC_Ticks;
+		smc_changes++;
+	}
+	// hash of the code in the given range of this page
+	Bit32u SourceHash(Bitu start,Bitu end) {
+		HostPt code=GetHostReadPt(phys_page);
+		Bit32u hash=2166136261u;
+		for (Bitu i=start;i<=end;i++) hash=(hash^host_readb(code+i))*16777619u;
+		return hash;
+	}
+	Bitu PhysPage(void) {
+		return phys_page;
 	}
+	//--End of modifications
 
 	// clear out blocks that contain code which has been modified
 	bool InvalidateRange(Bitu start,Bitu end) {
@@ -129,8 +235,16 @@ public:
 				CacheBlockDynRec * nextblock=block->hash.next;
 				// test if this block is in the range
 				if (start<=block->page.end && end>=block->page.start) {
-					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
-					block->Clear();		// clear the block, decrements the write_map accordingly
+					//--Modified 2026-10-19 to leave blocks that check their code on entry,
+					//unless the modification comes from within
+//					if (ip_point<=block->page.end && ip_point>=block->page.start) is_current_block=true;
+//					block->Clear();		// clear the block, decrements the write_map accordingly
+					bool is_current=(ip_point<=block->page.end && ip_point>=block->page.start);
+					if (is_current || !block->check.active) {
+						if (is_current) is_current_block=true;
+						block->Clear();		// clear the block, decrements the write_map accordingly
+					}
+					//--End of modifications
 				}
 				block=nextblock;
 			}
@@ -139,6 +253,34 @@ public:
 		return is_current_block;
 	}
 
+	//--Modified 2026-10-19 for adaptive self-modifying code handling: pages that
+	//aren't simply translated stay code pages after their blocks are gone, and
+	//writes to their code are left to the blocks' own checks
+
+	// a write missed the code in this page
+	void NoCodeWritten(void) {
+		if (active_blocks) return;		// still some blocks in this page
+		if (smc_policy!=SMC_BLOCKS) {
+			// keep the page and its policy until that is reviewed
+			ReviewPolicy();
+			return;
+		}
+		active_count--;
+		if (!active_count) Release();	// delay page releasing until active_count is zero
+	}
+	// a write hit the code in this page, returns true if the modified
+	// instructions should be noted in the invalidation map
+	bool CodeWritten(void) {
+		// whether the code really changed is found out when a block runs
+		if (smc_policy!=SMC_BLOCKS) return false;
+		NoteInvalidation();
+		if (!invalidation_map) {
+			invalidation_map=(Bit8u*)malloc(4096);
+			memset(invalidation_map,0,4096);
+		}
+		return true;
+	}
+
 	// the following functions will clean all cache blocks that are invalid now due to the write
 	void writeb(PhysPt addr,Bitu val){
 		addr&=4095;
@@ -146,15 +288,10 @@ public:
 		host_writeb(hostmem+addr,val);
 		// see if there's code where we are writing to
 		if (!host_readb(&write_map[addr])) {
-			if (active_blocks) return;		// still some blocks in this page
-			active_count--;
-			if (!active_count) Release();	// delay page releasing until active_count is zero
+			NoCodeWritten();
 			return;
-		} else if (!invalidation_map) {
-			invalidation_map=(Bit8u*)malloc(4096);
-			memset(invalidation_map,0,4096);
 		}
-		invalidation_map[addr]++;
+		if (CodeWritten()) invalidation_map[addr]++;
 		InvalidateRange(addr,addr);
 	}
 	void writew(PhysPt addr,Bitu val){
@@ -163,20 +300,17 @@ public:
 		host_writew(hostmem+addr,val);
 		// see if there's code where we are writing to
 		if (!host_readw(&write_map[addr])) {
-			if (active_blocks) return;		// still some blocks in this page
-			active_count--;
-			if (!active_count) Release();	// delay page releasing until active_count is zero
+			NoCodeWritten();
 			return;
-		} else if (!invalidation_map) {
-			invalidation_map=(Bit8u*)malloc(4096);
-			memset(invalidation_map,0,4096);
 		}
+		if (CodeWritten()) {
 #if defined(WORDS_BIGENDIAN) || !defined(C_UNALIGNED_MEMORY)
-		host_writew(&invalidation_map[addr],
-			host_readw(&invalidation_map[addr])+0x101);
+			host_writew(&invalidation_map[addr],
+				host_readw(&invalidation_map[addr])+0x101);
 #else
-		(*(Bit16u*)&invalidation_map[addr])+=0x101;
+			(*(Bit16u*)&invalidation_map[addr])+=0x101;
 #endif
+		}
 		InvalidateRange(addr,addr+1);
 	}
 	void writed(PhysPt addr,Bitu val){
@@ -185,20 +319,17 @@ public:
 		host_writed(hostmem+addr,val);
 		// see if there's code where we are writing to
 		if (!host_readd(&write_map[addr])) {
-			if (active_blocks) return;		// still some blocks in this page
-			active_count--;
-			if (!active_count) Release();	// delay page releasing until active_count is zero
+			NoCodeWritten();
 			return;
-		} else if (!invalidation_map) {
-			invalidation_map=(Bit8u*)malloc(4096);
-			memset(invalidation_map,0,4096);
 		}
+		if (CodeWritten()) {
 #if defined(WORDS_BIGENDIAN) || !defined(C_UNALIGNED_MEMORY)
-		host_writed(&invalidation_map[addr],
-			host_readd(&invalidation_map[addr])+0x1010101);
+			host_writed(&invalidation_map[addr],
+				host_readd(&invalidation_map[addr])+0x1010101);
 #else
-		(*(Bit32u*)&invalidation_map[addr])+=0x1010101;
+			(*(Bit32u*)&invalidation_map[addr])+=0x1010101;
 #endif
+		}
 		InvalidateRange(addr,addr+3);
 	}
 	bool writeb_checked(PhysPt addr,Bitu val) {
@@ -206,17 +337,10 @@ public:
 		if (host_readb(hostmem+addr)==(Bit8u)val) return false;
 		// see if there's code where we are writing to
 		if (!host_readb(&write_map[addr])) {
-			if (!active_blocks) {
-				// no blocks left in this page, still delay the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
-			}
+			// no blocks left in this page, still delay the page releasing a bit
+			NoCodeWritten();
 		} else {
-			if (!invalidation_map) {
-				invalidation_map=(Bit8u*)malloc(4096);
-				memset(invalidation_map,0,4096);
-			}
-			invalidation_map[addr]++;
+			if (CodeWritten()) invalidation_map[addr]++;
 			if (InvalidateRange(addr,addr)) {
 				cpu.exception.which=SMC_CURRENT_BLOCK;
 				return true;
@@ -230,22 +354,17 @@ public:
 		if (host_readw(hostmem+addr)==(Bit16u)val) return false;
 		// see if there's code where we are writing to
 		if (!host_readw(&write_map[addr])) {
-			if (!active_blocks) {
-				// no blocks left in this page, still delay the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
-			}
+			// no blocks left in this page, still delay the page releasing a bit
+			NoCodeWritten();
 		} else {
-			if (!invalidation_map) {
-				invalidation_map=(Bit8u*)malloc(4096);
-				memset(invalidation_map,0,4096);
-			}
+			if (CodeWritten()) {
 #if defined(WORDS_BIGENDIAN) || !defined(C_UNALIGNED_MEMORY)
-			host_writew(&invalidation_map[addr],
-				host_readw(&invalidation_map[addr])+0x101);
+				host_writew(&invalidation_map[addr],
+					host_readw(&invalidation_map[addr])+0x101);
 #else
-			(*(Bit16u*)&invalidation_map[addr])+=0x101;
+				(*(Bit16u*)&invalidation_map[addr])+=0x101;
 #endif
+			}
 			if (InvalidateRange(addr,addr+1)) {
 				cpu.exception.which=SMC_CURRENT_BLOCK;
 				return true;
@@ -259,22 +378,17 @@ public:
 		if (host_readd(hostmem+addr)==(Bit32u)val) return false;
 		// see if there's code where we are writing to
 		if (!host_readd(&write_map[addr])) {
-			if (!active_blocks) {
-				// no blocks left in this page, still delay the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
-			}
+			// no blocks left in this page, still delay the page releasing a bit
+			NoCodeWritten();
 		} else {
-			if (!invalidation_map) {
-				invalidation_map=(Bit8u*)malloc(4096);
-				memset(invalidation_map,0,4096);
-			}
+			if (CodeWritten()) {
 #if defined(WORDS_BIGENDIAN) || !defined(C_UNALIGNED_MEMORY)
-			host_writed(&invalidation_map[addr],
-				host_readd(&invalidation_map[addr])+0x1010101);
+				host_writed(&invalidation_map[addr],
+					host_readd(&invalidation_map[addr])+0x1010101);
 #else
-			(*(Bit32u*)&invalidation_map[addr])+=0x1010101;
+				(*(Bit32u*)&invalidation_map[addr])+=0x1010101;
 #endif
+			}
 			if (InvalidateRange(addr,addr+3)) {
 				cpu.exception.which=SMC_CURRENT_BLOCK;
 				return true;
@@ -283,6 +397,7 @@ public:
 		host_writed(hostmem+addr,val);
 		return false;
 	}
+	//--End of modifications
 
     // add a cache block to this page and note it in the hash map
 	void AddCacheBlock(CacheBlockDynRec * block) {
@@ -383,6 +498,16 @@ public:
 	// the write map, there are write_map[i] cache blocks that cover the byte at address i
 	Bit8u write_map[4096];
 	Bit8u * invalidation_map;
+	//--Added 2026-10-19 for superblocks
+	Bit8u * trace_map;		// bit 0 or 1 set for conditional jumps that are traced through
+	//--End of modifications
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	SMCPolicy smc_policy;	// how the code in this page is run
+	Bitu smc_count;			// invalidations since the policy was last reviewed
+	Bitu smc_since;			// PIC_Ticks at that review
+	Bitu smc_total;			// invalidations since this became a code page
+	Bitu smc_changes;		// policy changes since then
+	//--End of modifications
 	CodePageHandlerDynRec * next, * prev;	// page linking
 private:
 	PageHandler * old_pagehandler;
@@ -409,6 +534,9 @@ static CacheBlockDynRec * cache_getblock(void) {
 	if (!ret) E_Exit("Ran out of CacheBlocks" );
 	cache.block.free=ret->cache.next;
 	ret->cache.next=0;
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	ret->check.active=false;
+	//--End of modifications
 	return ret;
 }
 
@@ -47,10 +47,36 @@ static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,Phys
 
 	InitFlagsOptimization();
 
+	//--Added 2026-10-19 for superblocks
+	decode.traced=false;
+	decode.block->trace.handler=0;
+	//--End of modifications
+	//--Added 2026-10-19 for automatic core selection
+	core_dynrec.blocks_translated++;
+	//--End of modifications
+
+	//--Added 2026-10-19 for guest register caching
+#if defined(DRC_USE_REG_CACHE)
+	gen_regcache_start(core_dynrec.cache_regs);
+#endif
+	//--End of modifications
+
 	// every codeblock that is run sets cache.block.running to itself
 	// so the block linking knows the last executed block
 	gen_mov_direct_ptr(&cache.block.running,(DRC_PTR_SIZE_IM)decode.block);
 
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	// blocks in pages whose code is modified often make sure on entry
+	// that their code is still what it was when it was translated
+	decode.block->check.active=(codepage->smc_policy!=SMC_BLOCKS);
+	if (decode.block->check.active) {
+		gen_call_function_I((void *)&dynrec_check_block,(Bitu)(decode.block-cache_blocks));
+		DRC_PTR_SIZE_IM unchanged=gen_create_branch_on_zero(FC_RETOP,true);
+		dyn_return(BR_SMCCheck);
+		gen_fill_branch(unchanged);
+	}
+	//--End of modifications
+
 	// start with the cycles check
 	gen_mov_word_to_reg(FC_RETOP,&CPU_Cycles,true);
 	save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_leqzero(FC_RETOP);
@@ -195,8 +221,12 @@ restart_prefix:
 				// short conditional jumps
 				case 0x80:case 0x81:case 0x82:case 0x83:case 0x84:case 0x85:case 0x86:case 0x87:	
 				case 0x88:case 0x89:case 0x8a:case 0x8b:case 0x8c:case 0x8d:case 0x8e:case 0x8f:	
-					dyn_branched_exit((BranchTypes)(dual_code&0xf),
-						decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw());
+					//--Modified 2026-10-19 as the block may continue through the jump
+					//dyn_branched_exit((BranchTypes)(dual_code&0xf),
+					//	decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw());
+					if (dyn_branched_exit((BranchTypes)(dual_code&0xf),
+						decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw())) break;
+					//--End of modifications
 					goto finish_block;
 
 				// conditional byte set instructions
@@ -296,7 +326,10 @@ restart_prefix:
 		// short conditional jumps
 		case 0x70:case 0x71:case 0x72:case 0x73:case 0x74:case 0x75:case 0x76:case 0x77:	
 		case 0x78:case 0x79:case 0x7a:case 0x7b:case 0x7c:case 0x7d:case 0x7e:case 0x7f:	
-			dyn_branched_exit((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb());	
+			//--Modified 2026-10-19 as the block may continue through the jump
+			//dyn_branched_exit((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb());	
+			if (dyn_branched_exit((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb())) break;
+			//--End of modifications
 			goto finish_block;
 
 		// 'op []/reg8,imm8'
@@ -537,9 +570,15 @@ restart_prefix:
 			break;
 		case 0xf8:		//CLC
 			gen_call_function_raw((void*)dynrec_clc);
+			//--Added 2026-10-19 for per-flag liveness
+			InvalidateFlags(FLAG_CF);
+			//--End of modifications
 			break;
 		case 0xf9:		//STC
 			gen_call_function_raw((void*)dynrec_stc);
+			//--Added 2026-10-19 for per-flag liveness
+			InvalidateFlags(FLAG_CF);
+			//--End of modifications
 			break;
 
 		case 0xf6:dyn_grp3_eb();break;
@@ -606,6 +645,10 @@ finish_block:
 	// setup the correct end-address
 	decode.page.index--;
 	decode.active_block->page.end=(Bit16u)decode.page.index;
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+	if (decode.block->check.active)
+		decode.block->check.hash=codepage->SourceHash(decode.block->page.start,decode.block->page.end);
+	//--End of modifications
 //	LOG_MSG("Created block size %d start %d end %d",decode.block->cache.size,decode.block->page.start,decode.block->page.end);
 
 	return decode.block;
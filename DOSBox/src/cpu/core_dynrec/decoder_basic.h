@@ -104,6 +104,9 @@ static struct DynDecode {
 	Bitu cycles;			// number cycles used by currently translated code
 	bool seg_prefix_used;	// segment overridden
 	Bit8u seg_prefix;		// segment prefix (if seg_prefix_used==true)
+	//--Added 2026-10-19 for superblocks
+	bool traced;			// a conditional jump has been traced through in this block
+	//--End of modifications
 
 	// block that contains the first instruction translated
 	CacheBlockDynRec * block;
@@ -663,6 +666,16 @@ static void dyn_fill_blocks(void) {
 }
 
 
+//--Added 2026-10-19 for adaptive self-modifying code handling
+// called on entry of blocks that check their code, returns nonzero
+// if the code has been modified since the block was translated
+static Bit32u DRC_CALL_CONV dynrec_check_block(Bit32u index) DRC_FC;
+static Bit32u DRC_CALL_CONV dynrec_check_block(Bit32u index) {
+	CacheBlockDynRec * block=&cache_blocks[index];
+	return block->page.handler->SourceHash(block->page.start,block->page.end)!=block->check.hash;
+}
+//--End of modifications
+
 static void dyn_closeblock(void) {
 	//Shouldn't create empty block normally but let's do it like this
 	dyn_fill_blocks();
@@ -753,36 +766,63 @@ bool DRC_CALL_CONV mem_writed_checked_drc(PhysPt address,Bit32u val) {
 
 // functions that enable access to the memory
 
+//--Modified 2026-10-19 for inline TLB lookups: backends that define DRC_USE_INLINE_TLB
+//emit the TLB lookup of the memory helpers in front of the helper calls below,
+//and a hit jumps past the call
+static DRC_PTR_SIZE_IM dyn_inline_tlb_read(HostReg reg_dst,Bitu size) {
+#if defined(DRC_USE_INLINE_TLB)
+	if (core_dynrec.inline_tlb) return gen_inline_tlb_read(reg_dst,size);
+#endif
+	return 0;
+}
+static DRC_PTR_SIZE_IM dyn_inline_tlb_write(Bitu size) {
+#if defined(DRC_USE_INLINE_TLB)
+	if (core_dynrec.inline_tlb) return gen_inline_tlb_write(size);
+#endif
+	return 0;
+}
+static void dyn_inline_tlb_done(DRC_PTR_SIZE_IM hit) {
+	if (hit) gen_fill_branch(hit);
+}
+
 // read a byte from a given address and store it in reg_dst
 static void dyn_read_byte(HostReg reg_addr,HostReg reg_dst) {
 	gen_mov_regs(FC_OP1,reg_addr);
+	DRC_PTR_SIZE_IM hit=dyn_inline_tlb_read(reg_dst,1);
 	gen_call_function_raw((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low(reg_dst,&core_dynrec.readdata);
+	dyn_inline_tlb_done(hit);
 }
 static void dyn_read_byte_canuseword(HostReg reg_addr,HostReg reg_dst) {
 	gen_mov_regs(FC_OP1,reg_addr);
+	DRC_PTR_SIZE_IM hit=dyn_inline_tlb_read(reg_dst,1);
 	gen_call_function_raw((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low_canuseword(reg_dst,&core_dynrec.readdata);
+	dyn_inline_tlb_done(hit);
 }
 
 // write a byte from reg_val into the memory given by the address
 static void dyn_write_byte(HostReg reg_addr,HostReg reg_val) {
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
+	DRC_PTR_SIZE_IM hit=dyn_inline_tlb_write(1);
 	gen_call_function_raw((void *)&mem_writeb_checked_drc);
 	dyn_check_exception(FC_RETOP);
+	dyn_inline_tlb_done(hit);
 }
 
 // read a 32bit (dword=true) or 16bit (dword=false) value
 // from a given address and store it in reg_dst
 static void dyn_read_word(HostReg reg_addr,HostReg reg_dst,bool dword) {
 	gen_mov_regs(FC_OP1,reg_addr);
+	DRC_PTR_SIZE_IM hit=dyn_inline_tlb_read(reg_dst,dword?4:2);
 	if (dword) gen_call_function_raw((void *)&mem_readd_checked_drc);
 	else gen_call_function_raw((void *)&mem_readw_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_word_to_reg(reg_dst,&core_dynrec.readdata,dword);
+	dyn_inline_tlb_done(hit);
 }
 
 // write a 32bit (dword=true) or 16bit (dword=false) value
@@ -791,10 +831,13 @@ static void dyn_write_word(HostReg reg_addr,HostReg reg_val,bool dword) {
 //	if (!dword) gen_extend_word(false,reg_val);
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
+	DRC_PTR_SIZE_IM hit=dyn_inline_tlb_write(dword?4:2);
 	if (dword) gen_call_function_raw((void *)&mem_writed_checked_drc);
 	else gen_call_function_raw((void *)&mem_writew_checked_drc);
 	dyn_check_exception(FC_RETOP);
+	dyn_inline_tlb_done(hit);
 }
+//--End of modifications
 
 
 
@@ -1193,6 +1236,10 @@ static void gen_restore_reg(HostReg reg,HostReg dest_reg) {
 
 
 
+//--Modified 2026-10-19 for per-flag liveness: every queued function keeps
+//the set of flags it produced that may still be read, so that reading some
+//flags or overwriting some flags only affects the functions concerned
+
 // flags optimization functions
 // they try to find out if a function can be replaced by another
 // one that does not generate any flags at all
@@ -1202,21 +1249,99 @@ static struct {
 	Bit8u* pos;
 	void* fct_ptr;
 	Bitu ftype;
+	Bitu live;		// flags produced by the function that may still be read
 } mf_functions[64];
 
 static void InitFlagsOptimization(void) {
 	mf_functions_num=0;
 }
 
+//--Added 2026-10-19 for guest register caching
+#ifdef DRC_FLAGS_INVALIDATION
+// position of the call that is emitted next; cached guest registers are
+// written back first so the store can't end up inside the patched area
+static Bit8u* FlagsFunctionPos(void) {
+#if defined(DRC_USE_REG_CACHE)
+	gen_regcache_flush();
+#endif
+	return cache.pos;
+}
+#endif
+//--End of modifications
+
+#ifdef DRC_FLAGS_INVALIDATION
+// the condition flags a function of the given type always changes,
+// shifts and rotates leave them alone for a count of zero
+static Bitu FlagsWritten(Bitu flags_type) {
+	switch (flags_type) {
+		case t_INCb:case t_INCw:case t_INCd:
+		case t_DECb:case t_DECw:case t_DECd:
+			return FMASK_TEST & ~FLAG_CF;
+		case t_ROLb:case t_ROLw:case t_ROLd:
+		case t_RORb:case t_RORw:case t_RORd:
+		case t_SHLb:case t_SHLw:case t_SHLd:
+		case t_SHRb:case t_SHRw:case t_SHRd:
+		case t_SARb:case t_SARw:case t_SARd:
+		case t_DSHLw:case t_DSHLd:
+		case t_DSHRw:case t_DSHRd:
+			return 0;
+		default:
+			return FMASK_TEST;
+	}
+}
+
+// the condition flags a function of the given type may change,
+// the others are passed through from the previous flags state
+static Bitu FlagsProduced(Bitu flags_type) {
+	switch (flags_type) {
+		case t_INCb:case t_INCw:case t_INCd:
+		case t_DECb:case t_DECw:case t_DECd:
+			return FMASK_TEST & ~FLAG_CF;
+		case t_ROLb:case t_ROLw:case t_ROLd:
+		case t_RORb:case t_RORw:case t_RORd:
+			return FLAG_CF | FLAG_OF;
+		default:
+			return FMASK_TEST;
+	}
+}
+
+// the flags in flags_mask are overwritten, replace all queued functions
+// whose flags are now all overwritten before being read
+static void KillFlags(Bitu flags_mask) {
+	Bitu kept=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		mf_functions[ct].live&=~flags_mask;
+		if (mf_functions[ct].live) mf_functions[kept++]=mf_functions[ct];
+		else gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
+	}
+	mf_functions_num=kept;
+}
+
+static void QueueFlagsFunction(Bit8u* pos,void* current_simple_function,Bitu flags_type) {
+	// a function that doesn't fit stays as it is
+	if (mf_functions_num>=sizeof(mf_functions)/sizeof(mf_functions[0])) return;
+	mf_functions[mf_functions_num].pos=pos;
+	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
+	mf_functions[mf_functions_num].ftype=flags_type;
+	mf_functions[mf_functions_num].live=FlagsProduced(flags_type);
+	mf_functions_num++;
+}
+#endif
+
 // replace all queued functions with their simpler variants
 // because the current instruction destroys all condition flags and
 // the flags are not required before
 static void InvalidateFlags(void) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=0;
+	KillFlags(FMASK_TEST);
+#endif
+}
+
+// replace the queued functions whose flags are all overwritten now
+// because the current instruction destroys the condition flags in flags_mask
+static void InvalidateFlags(Bitu flags_mask) {
+#ifdef DRC_FLAGS_INVALIDATION
+	KillFlags(flags_mask);
 #endif
 }
 
@@ -1225,43 +1350,40 @@ static void InvalidateFlags(void) {
 // the flags are not required before
 static void InvalidateFlags(void* current_simple_function,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=1;
-	mf_functions[0].pos=cache.pos;
-	mf_functions[0].fct_ptr=current_simple_function;
-	mf_functions[0].ftype=flags_type;
+	KillFlags(FMASK_TEST);
+	QueueFlagsFunction(FlagsFunctionPos(),current_simple_function,flags_type);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
+// enqueue this instruction, if later instructions are encountered that
+// destroy all condition flags it changes and the flags weren't needed
+// in-between this function can be replaced by a simpler one as well
 static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cache.pos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	mf_functions_num++;
+	KillFlags(FlagsWritten(flags_type));
+	QueueFlagsFunction(FlagsFunctionPos(),current_simple_function,flags_type);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
+// enqueue this instruction, if later instructions are encountered that
+// destroy all condition flags it changes and the flags weren't needed
+// in-between this function can be replaced by a simpler one as well
 static void InvalidateFlagsPartially(void* current_simple_function,DRC_PTR_SIZE_IM cpos,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=(Bit8u*)cpos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	mf_functions_num++;
+	KillFlags(FlagsWritten(flags_type));
+	QueueFlagsFunction((Bit8u*)cpos,current_simple_function,flags_type);
 #endif
 }
 
-// the current function needs the condition flags thus reset the queue
+// the current function needs the condition flags in flags_mask thus
+// the functions that may have produced them have to stay as they are
 static void AcquireFlags(Bitu flags_mask) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions_num=0;
+	Bitu kept=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		if (!(mf_functions[ct].live & flags_mask)) mf_functions[kept++]=mf_functions[ct];
+	}
+	mf_functions_num=kept;
 #endif
 }
+//--End of modifications
@@ -1082,7 +1082,10 @@ static void dyn_cwd(void) {
 static void dyn_sahf(void) {
 	MOV_REG_WORD16_TO_HOST_REG(FC_OP1,DRC_REG_EAX);
 	gen_call_function_raw((void *)&dynrec_sahf);
-	InvalidateFlags();
+	//--Modified 2026-10-19 as SAHF keeps the overflow flag
+	//InvalidateFlags();
+	InvalidateFlags(FMASK_TEST & ~FLAG_OF);
+	//--End of modifications
 }
 
 
@@ -1094,8 +1097,104 @@ static void dyn_exit_link(Bits eip_change) {
 }
 
 
-static void dyn_branched_exit(BranchTypes btype,Bit32s eip_add) {
+//--Added 2026-10-19 for superblocks
+// the sides of the conditional jump just decoded that the block could continue
+// through: bit 0 for the fall-through, bit 1 for the jump, which has to go a
+// short way forward in the same page so the bytes in-between can be skipped
+static Bitu dyn_trace_sides(Bit32s eip_add) {
+	if (!core_dynrec.traces || decode.traced) return 0;
+	// the jump has to lie in one page to be noted there
+	if ((decode.op_start>>12)!=decode.page.first) return 0;
+	Bitu sides=0;
+	// a block doesn't cross into more than one other page
+	if ((decode.page.index<4096) || (decode.active_block==decode.block)) sides|=1;
+	if ((eip_add>0) && (eip_add<=DYN_TRACE_MAXSKIP) && (decode.page.index+eip_add<4096)) sides|=2;
+	return sides;
+}
+
+// count an exit through one side of the conditional jump that closes the block,
+// and return to the core when the side has been taken often enough to be traced
+static void dyn_trace_count(Bitu side,bool traceable) {
+	Bit32u * count=&trace_counts[decode.block-cache_blocks][side];
+	*count=DYN_TRACE_THRESHOLD;
+	gen_sub_direct_word(count,1,true);
+	if (!traceable) return;
+	gen_mov_word_to_reg(FC_RETOP,count,true);
+	DRC_PTR_SIZE_IM no_trace=gen_create_branch_on_nonzero(FC_RETOP,true);
+	dyn_return(side ? BR_Trace2 : BR_Trace1);
+	gen_fill_branch(no_trace);
+}
+
+// continue the block through one side of the conditional jump,
+// the other side leaves the block through the core
+// (this can't be a link, the block may already use both of them for its end)
+static void dyn_trace_through(BranchTypes btype,Bit32s eip_add,bool taken) {
 	Bitu eip_base=decode.code-decode.code_start;
+	decode.traced=true;
+	core_dynrec.trace_formed++;
+	// the code the side exit leads to may read any of the flags
+	AcquireFlags(FMASK_TEST);
+
+	dyn_branchflag_to_reg(btype);
+	DRC_PTR_SIZE_IM data;
+	if (taken) data=gen_create_branch_on_nonzero(FC_RETOP,true);
+	else data=gen_create_branch_on_zero(FC_RETOP,true);
+
+	// the exits through either side are counted again, so the core
+	// can check the jump still goes the same way (see UntraceBlock)
+	decode.block->trace.handler=decode.page.code;
+	decode.block->trace.index=(Bit16u)(decode.op_start&4095);
+	Bit32u * counts=trace_counts[decode.block-cache_blocks];
+	counts[0]=DYN_TRACE_THRESHOLD/16;
+	counts[1]=0;
+
+	// side exit
+	dyn_reduce_cycles();
+	gen_add_direct_word(&reg_eip,taken ? eip_base : eip_base+eip_add,decode.big_op);
+	gen_add_direct_word(&core_dynrec.trace_left,1,true);
+	gen_sub_direct_word(&counts[0],1,true);
+	gen_mov_word_to_reg(FC_RETOP,&counts[0],true);
+	DRC_PTR_SIZE_IM no_check=gen_create_branch_on_nonzero(FC_RETOP,true);
+	dyn_return(BR_TraceCheck);
+	gen_fill_branch(no_check);
+	dyn_return(BR_Normal);
+	gen_fill_branch(data);
+
+	gen_add_direct_word(&core_dynrec.trace_followed,1,true);
+	gen_add_direct_word(&counts[1],1,true);
+	if (taken) {
+		// move eip to the jump target, the rest of the block is relative to it
+		gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+		// the bytes jumped over don't belong to the block
+		for (Bits skip=eip_add;skip>0;skip--) {
+			decode_increase_wmapmask(1);
+			decode.page.index++;
+			decode.code++;
+		}
+		decode.code_start=decode.code;
+	}
+}
+//--End of modifications
+
+//--Modified 2026-10-19 to continue the block through the side of the jump
+//that is taken most, returns true if the block goes on
+static bool dyn_branched_exit(BranchTypes btype,Bit32s eip_add) {
+	Bitu eip_base=decode.code-decode.code_start;
+	Bitu sides=dyn_trace_sides(eip_add);
+	if (sides) {
+		Bit8u * trace_map=decode.page.code->trace_map;
+		Bitu hot=trace_map ? trace_map[decode.op_start&4095] : 0;
+		if (hot & sides) {
+			dyn_trace_through(btype,eip_add,hot==2);
+			return true;
+		}
+		// the hot side is known but can't be followed, stop counting
+		if (hot) sides=0;
+		else {
+			decode.block->trace.handler=decode.page.code;
+			decode.block->trace.index=(Bit16u)(decode.op_start&4095);
+		}
+	}
 	dyn_reduce_cycles();
 
 	dyn_branchflag_to_reg(btype);
@@ -1103,14 +1202,18 @@ static void dyn_branched_exit(BranchTypes btype,Bit32s eip_add) {
 
  	// Branch not taken
 	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
+	if (sides) dyn_trace_count(0,(sides&1)!=0);
  	gen_jmp_ptr(&decode.block->link[0].to,offsetof(CacheBlockDynRec,cache.start));
  	gen_fill_branch(data);
 
  	// Branch taken
 	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+	if (sides) dyn_trace_count(1,(sides&2)!=0);
  	gen_jmp_ptr(&decode.block->link[1].to,offsetof(CacheBlockDynRec,cache.start));
  	dyn_closeblock();
+	return false;
 }
+//--End of modifications
 
 /*
 static void dyn_set_byte_on_condition(BranchTypes btype) {
@@ -68,6 +68,138 @@ static INLINE void dyn_fpu_top_swapped() {
 	gen_mov_word_to_reg(FC_OP2,(void*)(&TOP),true);
 }
 
+//--Added 2026-10-19 for SSE2 FPU translation: backends that define
+//DRC_USE_SSE2_FPU translate the common arithmetic, compares and register
+//moves inline, everything else still calls the FPU functions
+#if defined(DRC_USE_SSE2_FPU)
+// FC_OP1 op= FC_OP2, with op numbered like the reg field of esc 0
+static void dyn_fpu_inline_arith(Bitu op) {
+	switch (op) {
+	case 0x00:gen_fpu_sse2_arith(SSE2_ADDSD,false);break;
+	case 0x01:gen_fpu_sse2_arith(SSE2_MULSD,false);break;
+	case 0x04:gen_fpu_sse2_arith(SSE2_SUBSD,false);break;
+	case 0x05:gen_fpu_sse2_arith(SSE2_SUBSD,true);break;
+	case 0x06:gen_fpu_sse2_arith(SSE2_DIVSD,false);break;
+	case 0x07:gen_fpu_sse2_arith(SSE2_DIVSD,true);break;
+	}
+}
+
+// FC_OP1 = ST, FC_OP2 = ST(1)
+static void dyn_fpu_top_next() {
+	gen_mov_word_to_reg(FC_OP2,(void*)(&TOP),true);
+	gen_add_imm(FC_OP2,1);
+	gen_and_imm(FC_OP2,7);
+	gen_mov_word_to_reg(FC_OP1,(void*)(&TOP),true);
+}
+
+// returns false if the instruction has to be translated the usual way
+static bool dyn_fpu_inline(Bitu esc) {
+	Bitu group=decode.modrm.reg;
+	if (decode.modrm.val < 0xc0) {
+		// the memory operand is loaded into fpu.regs[8] for the arithmetic
+		void * load;
+		switch (esc) {
+		case 0:load=(void*)&FPU_FLD_F32_EA;break;
+		case 2:load=(void*)&FPU_FLD_I32_EA;break;
+		case 4:load=(void*)&FPU_FLD_F64_EA;break;
+		case 6:load=(void*)&FPU_FLD_I16_EA;break;
+		default:return false;
+		}
+		dyn_fill_ea(FC_ADDR);
+		gen_call_function_R(load,FC_ADDR);
+		gen_mov_word_to_reg(FC_OP1,(void*)(&TOP),true);
+		gen_mov_dword_to_reg_imm(FC_OP2,8);
+		if (group==0x02 || group==0x03) {
+			gen_fpu_sse2_compare();		// FCOM, FCOMP
+			if (group==0x03) gen_fpu_pop();
+		} else dyn_fpu_inline_arith(group);
+		return true;
+	}
+	switch (esc) {
+	case 0:
+		dyn_fpu_top();
+		if (group==0x02 || group==0x03) {
+			gen_fpu_sse2_compare();		// FCOM, FCOMP STi
+			if (group==0x03) gen_fpu_pop();
+		} else dyn_fpu_inline_arith(group);	// op ST,STi
+		return true;
+	case 1:
+		switch (group) {
+		case 0x00:		// FLD STi
+			gen_mov_word_to_reg(FC_OP1,(void*)(&TOP),true);
+			gen_add_imm(FC_OP1,decode.modrm.rm);
+			gen_and_imm(FC_OP1,7);
+			gen_fpu_push();
+			gen_mov_regs(FC_OP2,FC_RETOP);
+			gen_fpu_move(false);
+			return true;
+		case 0x01:		// FXCH STi
+			dyn_fpu_top();
+			gen_fpu_move(true);
+			return true;
+		case 0x03:		// FSTP STi
+			dyn_fpu_top();
+			gen_fpu_move(false);
+			gen_fpu_pop();
+			return true;
+		}
+		return false;
+	case 2:
+		if (group!=0x05 || decode.modrm.rm!=0x01) return false;
+		dyn_fpu_top_next();		// FUCOMPP
+		gen_fpu_sse2_compare();
+		gen_fpu_pop();
+		gen_fpu_pop();
+		return true;
+	case 4:
+	case 6:
+		if (group==0x03) {
+			if (esc==4) dyn_fpu_top();		// FCOMP STi
+			else if (decode.modrm.rm==0x01) dyn_fpu_top_next();	// FCOMPP
+			else return false;
+			gen_fpu_sse2_compare();
+			gen_fpu_pop();
+		} else if (group==0x02) {
+			dyn_fpu_top();		// FCOM STi, FCOMP5
+			gen_fpu_sse2_compare();
+		} else {
+			// op STi,ST with sub and div the other way round from esc 0
+			dyn_fpu_top_swapped();
+			dyn_fpu_inline_arith(group>=0x04 ? group^1 : group);
+		}
+		if (esc==6) gen_fpu_pop();
+		return true;
+	case 5:
+		if (group<0x01 || group>0x05) return false;
+		dyn_fpu_top();
+		switch (group) {
+		case 0x01:gen_fpu_move(true);return true;			// FXCH STi
+		case 0x02:gen_fpu_move(false);return true;			// FST STi
+		case 0x03:gen_fpu_move(false);gen_fpu_pop();return true;	// FSTP STi
+		case 0x04:gen_fpu_sse2_compare();return true;		// FUCOM STi
+		case 0x05:gen_fpu_sse2_compare();gen_fpu_pop();return true;	// FUCOMP STi
+		}
+		break;
+	case 7:
+		switch (group) {
+		case 0x01:		// FXCH STi
+			dyn_fpu_top();
+			gen_fpu_move(true);
+			return true;
+		case 0x02:		// FSTP STi
+		case 0x03:
+			dyn_fpu_top();
+			gen_fpu_move(false);
+			gen_fpu_pop();
+			return true;
+		}
+		return false;
+	}
+	return false;
+}
+#endif
+//--End of modifications
+
 static void dyn_eatree() {
 	Bitu group=(decode.modrm.val >> 3) & 7;
 	switch (group){
@@ -103,6 +235,11 @@ static void dyn_eatree() {
 
 static void dyn_fpu_esc0(){
 	dyn_get_modrm(); 
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(0)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		dyn_fpu_top();
 		switch (decode.modrm.reg){
@@ -145,6 +282,11 @@ static void dyn_fpu_esc0(){
 
 static void dyn_fpu_esc1(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(1)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch (decode.modrm.reg){
 		case 0x00: /* FLD STi */
@@ -332,6 +474,11 @@ static void dyn_fpu_esc1(){
 
 static void dyn_fpu_esc2(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(2)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch(decode.modrm.reg){
 		case 0x05:
@@ -364,6 +511,11 @@ static void dyn_fpu_esc2(){
 
 static void dyn_fpu_esc3(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(3)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch (decode.modrm.reg) {
 		case 0x04:
@@ -428,6 +580,11 @@ static void dyn_fpu_esc3(){
 
 static void dyn_fpu_esc4(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(4)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch(decode.modrm.reg){
 		case 0x00:	/* FADD STi,ST*/
@@ -476,6 +633,11 @@ static void dyn_fpu_esc4(){
 
 static void dyn_fpu_esc5(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(5)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		dyn_fpu_top();
 		switch(decode.modrm.reg){
@@ -546,6 +708,11 @@ static void dyn_fpu_esc5(){
 
 static void dyn_fpu_esc6(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(6)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch(decode.modrm.reg){
 		case 0x00:	/*FADDP STi,ST*/
@@ -602,6 +769,11 @@ static void dyn_fpu_esc6(){
 
 static void dyn_fpu_esc7(){
 	dyn_get_modrm();  
+	//--Added 2026-10-19 for SSE2 FPU translation
+#if defined(DRC_USE_SSE2_FPU)
+	if (dyn_fpu_inline(7)) return;
+#endif
+	//--End of modifications
 	if (decode.modrm.val >= 0xc0) { 
 		switch (decode.modrm.reg){
 		case 0x00: /* FFREEP STi */
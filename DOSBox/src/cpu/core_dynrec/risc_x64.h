@@ -30,6 +30,11 @@
 // try to replace _simple functions by code
 #define DRC_FLAGS_INVALIDATION_DCODE
 
+//--Added 2026-10-19 for inline TLB lookups
+// look up host memory pages in the TLB inline instead of calling the memory helpers
+#define DRC_USE_INLINE_TLB
+//--End of modifications
+
 // type with the same size as a pointer
 #define DRC_PTR_SIZE_IM Bit64u
 
@@ -99,9 +104,165 @@ static INLINE void gen_memaddr(HostReg reg,void* data) {
 }
 
 
+//--Added 2026-10-19 for guest register caching
+// the guest registers most recently used in a block are kept in r12-r15,
+// which the C helpers preserve; memory is brought up to date before every
+// helper call, branch and block exit, and the cache is forgotten after calls
+// and at branch targets, where the code can be reached by more than one path
+#define DRC_USE_REG_CACHE
+
+#define REGCACHE_HOST_REGS 4
+#define REGCACHE_HOST_BASE 12		// r12
+
+static struct {
+	bool enabled;
+	Bits guest[REGCACHE_HOST_REGS];		// guest register in each host register, or -1
+	bool dirty[REGCACHE_HOST_REGS];		// host register has been changed since loading
+	Bitu used[REGCACHE_HOST_REGS];		// last use, for evicting the least recently used
+	Bitu clock;
+} regcache;
+
+// the guest register index of a pointer into cpu_regs.regs, or -1,
+// along with the offset of the pointer into the register
+static Bits gen_regcache_guest(void* data,Bitu & offset) {
+	if (!regcache.enabled) return -1;
+	Bitu diff=(Bitu)((Bit8u*)data-(Bit8u*)&cpu_regs.regs[0]);
+	if (diff>=sizeof(cpu_regs.regs)) return -1;
+	offset=diff%sizeof(GenReg32);
+	return (Bits)(diff/sizeof(GenReg32));
+}
+
+static void gen_regcache_store(Bitu slot) {
+	cache_addb(0x44);		// mov [data],r12d+slot
+	cache_addb(0x89);
+	gen_memaddr((HostReg)((REGCACHE_HOST_BASE+slot)&7),&cpu_regs.regs[regcache.guest[slot]].dword[0]);
+	regcache.dirty[slot]=false;
+}
+
+// write all changed guest registers back to memory
+static void gen_regcache_flush(void) {
+	for (Bitu slot=0;slot<REGCACHE_HOST_REGS;slot++) {
+		if (regcache.dirty[slot]) gen_regcache_store(slot);
+	}
+}
+
+// forget what the host registers hold, after writing them back
+static void gen_regcache_forget(void) {
+	gen_regcache_flush();
+	for (Bitu slot=0;slot<REGCACHE_HOST_REGS;slot++) regcache.guest[slot]=-1;
+}
+
+// write a guest register back if it's cached, and forget it, before
+// it is accessed in memory directly
+static void gen_regcache_evict(void* data) {
+	Bitu offset;
+	Bits guest=gen_regcache_guest(data,offset);
+	if (guest<0) return;
+	for (Bitu slot=0;slot<REGCACHE_HOST_REGS;slot++) {
+		if (regcache.guest[slot]==guest) {
+			if (regcache.dirty[slot]) gen_regcache_store(slot);
+			regcache.guest[slot]=-1;
+		}
+	}
+}
+
+// called at the start of every block
+static void gen_regcache_start(bool enabled) {
+	regcache.enabled=enabled;
+	for (Bitu slot=0;slot<REGCACHE_HOST_REGS;slot++) {
+		regcache.guest[slot]=-1;
+		regcache.dirty[slot]=false;
+	}
+}
+
+// get the host register (r8-r15 numbering) that caches a guest register,
+// loading it from memory if load is set and it isn't cached yet
+static HostReg gen_regcache_get(Bits guest,bool load) {
+	Bitu slot,victim=0;
+	for (slot=0;slot<REGCACHE_HOST_REGS;slot++) {
+		if (regcache.guest[slot]==guest) break;
+		if (regcache.guest[slot]<0) victim=slot;
+		else if (regcache.guest[victim]>=0 && regcache.used[slot]<regcache.used[victim]) victim=slot;
+	}
+	if (slot==REGCACHE_HOST_REGS) {
+		slot=victim;
+		if (regcache.dirty[slot]) gen_regcache_store(slot);
+		regcache.guest[slot]=guest;
+		if (load) {
+			cache_addb(0x44);		// mov r12d+slot,[data]
+			cache_addb(0x8b);
+			gen_memaddr((HostReg)((REGCACHE_HOST_BASE+slot)&7),&cpu_regs.regs[guest].dword[0]);
+		}
+	}
+	regcache.used[slot]=++regcache.clock;
+	return (HostReg)(REGCACHE_HOST_BASE+slot);
+}
+
+static void gen_regcache_changed(HostReg host) {
+	regcache.dirty[host-REGCACHE_HOST_BASE]=true;
+}
+
+// the accesses below return false if the guest register at data, if any,
+// has to be accessed in memory instead
+
+// mov dest_reg,<guest register at data>
+static bool gen_regcache_read(HostReg dest_reg,void* data) {
+	Bitu offset;
+	Bits guest=gen_regcache_guest(data,offset);
+	if (guest<0) return false;
+	if (offset) {
+		gen_regcache_evict(data);
+		return false;
+	}
+	HostReg host=gen_regcache_get(guest,true);
+	cache_addb(0x44);		// mov dest_reg,host
+	cache_addb(0x89);
+	cache_addb(0xc0+((host&7)<<3)+dest_reg);
+	return true;
+}
+
+// mov <guest register at data>,src_reg for size bytes
+static bool gen_regcache_write(HostReg src_reg,void* data,Bitu size) {
+	Bitu offset;
+	Bits guest=gen_regcache_guest(data,offset);
+	if (guest<0) return false;
+	if (offset) {
+		gen_regcache_evict(data);
+		return false;
+	}
+	HostReg host=gen_regcache_get(guest,size<4);
+	if (size==2) cache_addb(0x66);
+	cache_addb(0x41);		// mov host,src_reg
+	cache_addb(size==1 ? 0x88 : 0x89);
+	cache_addb(0xc0+(src_reg<<3)+(host&7));
+	gen_regcache_changed(host);
+	return true;
+}
+
+// add reg,<guest register at data>
+static bool gen_regcache_add(HostReg reg,void* data) {
+	Bitu offset;
+	Bits guest=gen_regcache_guest(data,offset);
+	if (guest<0) return false;
+	if (offset) {
+		gen_regcache_evict(data);
+		return false;
+	}
+	HostReg host=gen_regcache_get(guest,true);
+	cache_addb(0x44);		// add reg,host
+	cache_addb(0x01);
+	cache_addb(0xc0+((host&7)<<3)+reg);
+	return true;
+}
+//--End of modifications
+
+
 // move a 32bit (dword==true) or 16bit (dword==false) value from memory into dest_reg
 // 16bit moves may destroy the upper 16bit of the destination register
 static void gen_mov_word_to_reg(HostReg dest_reg,void* data,bool dword) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_read(dest_reg,data)) return;
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addb(0x8b); // mov reg,[data]
 	gen_memaddr(dest_reg,data);
@@ -123,6 +284,9 @@ static void gen_mov_dword_to_reg_imm(HostReg dest_reg,Bit32u imm) {
 
 // move 32bit (dword==true) or 16bit (dword==false) of a register into memory
 static void gen_mov_word_from_reg(HostReg src_reg,void* dest,bool dword) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_write(src_reg,dest,dword?4:2)) return;
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addb(0x89);	// mov [data],reg
 	gen_memaddr(src_reg,dest);
@@ -133,6 +297,9 @@ static void gen_mov_word_from_reg(HostReg src_reg,void* dest,bool dword) {
 // this function does not use FC_OP1/FC_OP2 as dest_reg as these
 // registers might not be directly byte-accessible on some architectures
 static void gen_mov_byte_to_reg_low(HostReg dest_reg,void* data) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_read(dest_reg,data)) return;
+	//--End of modifications
 	cache_addb(0x8a);	// mov reg,[data]
 	gen_memaddr(dest_reg,data);
 }
@@ -142,6 +309,9 @@ static void gen_mov_byte_to_reg_low(HostReg dest_reg,void* data) {
 // this function can use FC_OP1/FC_OP2 as dest_reg which are
 // not directly byte-accessible on some architectures
 static void gen_mov_byte_to_reg_low_canuseword(HostReg dest_reg,void* data) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_read(dest_reg,data)) return;
+	//--End of modifications
 	cache_addb(0x66);
 	cache_addb(0x8b);	// mov reg,[data]
 	gen_memaddr(dest_reg,data);
@@ -168,6 +338,9 @@ static void gen_mov_byte_to_reg_low_imm_canuseword(HostReg dest_reg,Bit8u imm) {
 
 // move the lowest 8bit of a register into memory
 static void gen_mov_byte_from_reg_low(HostReg src_reg,void* dest) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_write(src_reg,dest,1)) return;
+	//--End of modifications
 	cache_addb(0x88);	// mov [data],reg
 	gen_memaddr(src_reg,dest);
 }
@@ -192,6 +365,9 @@ static void gen_extend_word(bool sign,HostReg reg) {
 
 // add a 32bit value from memory to a full register
 static void gen_add(HostReg reg,void* op) {
+	//--Added 2026-10-19 for guest register caching
+	if (gen_regcache_add(reg,op)) return;
+	//--End of modifications
 	cache_addb(0x03);					// add reg,[data]
 	gen_memaddr(reg,op);
 }
@@ -212,6 +388,9 @@ static void gen_and_imm(HostReg reg,Bit32u imm) {
 
 // move a 32bit constant value into memory
 static void gen_mov_direct_dword(void* dest,Bit32u imm) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_evict(dest);
+	//--End of modifications
 	cache_addw(0x04c7);					// mov [data],imm
 	cache_addb(0x25);
 	cache_addd((Bit32u)(((Bit64u)dest)&0xffffffffLL));
@@ -229,12 +408,19 @@ static void gen_mov_reg_qword(HostReg dest_reg,Bit64u imm) {
 static void INLINE gen_mov_direct_ptr(void* dest,DRC_PTR_SIZE_IM imm) {
 	gen_mov_reg_qword(HOST_EAX,imm);
 	cache_addb(0x48);
-	gen_mov_word_from_reg(HOST_EAX,dest,true);
+	//--Modified 2026-10-19 for guest register caching: never a guest register
+	//gen_mov_word_from_reg(HOST_EAX,dest,true);
+	cache_addb(0x89);	// mov [data],rax
+	gen_memaddr(HOST_EAX,dest);
+	//--End of modifications
 }
 
 
 // add an 8bit constant value to a memory value
 static void gen_add_direct_byte(void* dest,Bit8s imm) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_evict(dest);
+	//--End of modifications
 	cache_addw(0x0483);					// add [data],imm
 	cache_addb(0x25);
 	cache_addd((Bit32u)(((Bit64u)dest)&0xffffffffLL));
@@ -247,6 +433,9 @@ static void gen_add_direct_word(void* dest,Bit32u imm,bool dword) {
 		gen_add_direct_byte(dest,(Bit8s)imm);
 		return;
 	}
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_evict(dest);
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addw(0x0481);					// add [data],imm
 	cache_addb(0x25);
@@ -257,6 +446,9 @@ static void gen_add_direct_word(void* dest,Bit32u imm,bool dword) {
 
 // subtract an 8bit constant value from a memory value
 static void gen_sub_direct_byte(void* dest,Bit8s imm) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_evict(dest);
+	//--End of modifications
 	cache_addw(0x2c83);					// sub [data],imm
 	cache_addb(0x25);
 	cache_addd((Bit32u)(((Bit64u)dest)&0xffffffffLL));
@@ -269,6 +461,9 @@ static void gen_sub_direct_word(void* dest,Bit32u imm,bool dword) {
 		gen_sub_direct_byte(dest,(Bit8s)imm);
 		return;
 	}
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_evict(dest);
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addw(0x2c81);					// sub [data],imm
 	cache_addb(0x25);
@@ -324,6 +519,9 @@ static INLINE void gen_lea(HostReg dest_reg,Bitu scale,Bits imm) {
 
 // generate a call to a parameterless function
 static void INLINE gen_call_function_raw(void * func) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 	cache_addb(0x48);
 	cache_addb(0xb8);	// mov reg,imm64
 	cache_addq((Bit64u)func);
@@ -334,6 +532,9 @@ static void INLINE gen_call_function_raw(void * func) {
 // note: the parameters are loaded in the architecture specific way
 // using the gen_load_param_ functions below
 static Bit64u INLINE gen_call_function_setup(void * func,Bitu paramcount,bool fastcall=false) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 	// align the stack
 	cache_addb(0x48);
 	cache_addw(0xc48b);		// mov rax,rsp
@@ -478,14 +679,20 @@ static void INLINE gen_load_param_mem(Bitu mem,Bitu param) {
 			gen_mov_word_to_reg(FC_OP2,(void*)mem,true);
 			break;
 #if defined (_MSC_VER)
+		//--Modified 2026-10-19 for guest register caching: load straight from memory
 		case 2:		// mov r8,[mem]
-			cache_addb(0x49);
-			gen_mov_word_to_reg(0,(void*)mem,true);
+			gen_regcache_evict((void*)mem);
+			cache_addb(0x4c);
+			cache_addb(0x8b);
+			gen_memaddr(0,(void*)mem);
 			break;
 		case 3:		// mov r9,[mem]
-			cache_addb(0x49);
-			gen_mov_word_to_reg(1,(void*)mem,true);
+			gen_regcache_evict((void*)mem);
+			cache_addb(0x4c);
+			cache_addb(0x8b);
+			gen_memaddr(1,(void*)mem);
 			break;
+		//--End of modifications
 #else
 		case 2:		// mov rdx,[mem]
 			gen_mov_word_to_reg(HOST_EDX,(void*)mem,true);
@@ -504,6 +711,9 @@ static void INLINE gen_load_param_mem(Bitu mem,Bitu param) {
 
 // jump to an address pointed at by ptr, offset is in imm
 static void gen_jmp_ptr(void * ptr,Bits imm=0) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 	cache_addw(0xa148);		// mov rax,[data]
 	cache_addq((Bit64u)ptr);
 
@@ -523,6 +733,9 @@ static void gen_jmp_ptr(void * ptr,Bits imm=0) {
 // short conditional jump (+-127 bytes) if register is zero
 // the destination is set by gen_fill_branch() later
 static Bit64u gen_create_branch_on_zero(HostReg reg,bool dword) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_flush();
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addb(0x0b);					// or reg,reg
 	cache_addb(0xc0+reg+(reg<<3));
@@ -534,6 +747,9 @@ static Bit64u gen_create_branch_on_zero(HostReg reg,bool dword) {
 // short conditional jump (+-127 bytes) if register is nonzero
 // the destination is set by gen_fill_branch() later
 static Bit64u gen_create_branch_on_nonzero(HostReg reg,bool dword) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_flush();
+	//--End of modifications
 	if (!dword) cache_addb(0x66);
 	cache_addb(0x0b);					// or reg,reg
 	cache_addb(0xc0+reg+(reg<<3));
@@ -544,6 +760,9 @@ static Bit64u gen_create_branch_on_nonzero(HostReg reg,bool dword) {
 
 // calculate relative offset and fill it into the location pointed to by data
 static void gen_fill_branch(DRC_PTR_SIZE_IM data) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 #if C_DEBUG
 	Bit64s len=(Bit64u)cache.pos-data;
 	if (len<0) len=-len;
@@ -556,6 +775,9 @@ static void gen_fill_branch(DRC_PTR_SIZE_IM data) {
 // for isdword==true the 32bit of the register are tested
 // for isdword==false the lowest 8bit of the register are tested
 static Bit64u gen_create_branch_long_nonzero(HostReg reg,bool isdword) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_flush();
+	//--End of modifications
 	// isdword: cmp reg32,0
 	// not isdword: cmp reg8,0
 	cache_addb(0x0a+(isdword?1:0));				// or reg,reg
@@ -568,6 +790,9 @@ static Bit64u gen_create_branch_long_nonzero(HostReg reg,bool isdword) {
 
 // compare 32bit-register against zero and jump if value less/equal than zero
 static Bit64u gen_create_branch_long_leqzero(HostReg reg) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_flush();
+	//--End of modifications
 	cache_addw(0xf883+(reg<<8));
 	cache_addb(0x00);		// cmp reg,0
 
@@ -578,18 +803,240 @@ static Bit64u gen_create_branch_long_leqzero(HostReg reg) {
 
 // calculate long relative offset and fill it into the location pointed to by data
 static void gen_fill_branch_long(Bit64u data) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 	*(Bit32u*)data=(Bit32u)((Bit64u)cache.pos-data-4);
 }
 
+//--Added 2026-10-19 for inline TLB lookups
+// look up the page of the address in FC_OP1 in the given TLB table, and branch
+// to the code that follows if it isn't backed by host memory or an access of
+// size bytes would cross into the next page
+// on a hit the host address of the page is left in rax
+static void gen_inline_tlb_lookup(HostPt * table,Bitu size,Bit64u * misses) {
+	gen_regcache_flush();
+	misses[0]=0;
+	if (size>1) {
+		gen_mov_regs(HOST_ECX,FC_OP1);
+		gen_and_imm(HOST_ECX,0xfff);
+		cache_addw(0xf981);		// cmp ecx,imm
+		cache_addd(0x1001-size);
+		cache_addw(0x0073);		// jae miss
+		misses[0]=(Bit64u)cache.pos-1;
+	}
+	gen_mov_regs(HOST_EAX,FC_OP1);
+	cache_addw(0xe8c1);			// shr eax,12
+	cache_addb(0x0c);
+	gen_mov_reg_qword(HOST_ECX,(Bit64u)table);
+	cache_addd(0xc1048b48);		// mov rax,[rcx+rax*8]
+	cache_addb(0x48);
+	cache_addw(0xc085);			// test rax,rax
+	cache_addw(0x0074);			// jz miss
+	misses[1]=(Bit64u)cache.pos-1;
+}
+
+// jump over the helper call that follows a hit, and point the misses to it
+static Bit64u gen_inline_tlb_hit(Bit64u * misses) {
+	cache_addw(0x00eb);			// jmp done
+	Bit64u hit=(Bit64u)cache.pos-1;
+	if (misses[0]) gen_fill_branch(misses[0]);
+	gen_fill_branch(misses[1]);
+	return hit;
+}
+
+// read size bytes from the address in FC_OP1 into dest_reg (zero-extended)
+// if its page is backed by host memory, otherwise fall through to the code
+// that follows; returns the branch to fill in at the end of that code
+static Bit64u gen_inline_tlb_read(HostReg dest_reg,Bitu size) {
+	Bit64u misses[2];
+	gen_inline_tlb_lookup(paging.tlb.read,size,misses);
+	switch (size) {
+		case 1:cache_addw(0xb60f);break;	// movzx dest_reg,byte [rax+FC_OP1]
+		case 2:cache_addw(0xb70f);break;	// movzx dest_reg,word [rax+FC_OP1]
+		default:cache_addb(0x8b);break;		// mov dest_reg,[rax+FC_OP1]
+	}
+	cache_addb(0x04+(dest_reg<<3));
+	cache_addb(FC_OP1<<3);
+	return gen_inline_tlb_hit(misses);
+}
+
+// write size bytes of FC_OP2 to the address in FC_OP1 if its page is backed
+// by host memory, otherwise fall through to the code that follows; returns
+// the branch to fill in at the end of that code
+static Bit64u gen_inline_tlb_write(Bitu size) {
+	Bit64u misses[2];
+	gen_inline_tlb_lookup(paging.tlb.write,size,misses);
+	switch (size) {
+		case 1:cache_addw(0x8840);break;	// mov [rax+FC_OP1],FC_OP2 (byte)
+		case 2:cache_addw(0x8966);break;	// mov [rax+FC_OP1],FC_OP2 (word)
+		default:cache_addb(0x89);break;		// mov [rax+FC_OP1],FC_OP2
+	}
+	cache_addb(0x04+(FC_OP2<<3));
+	cache_addb(FC_OP1<<3);
+	return gen_inline_tlb_hit(misses);
+}
+//--End of modifications
+
+//--Added 2026-10-19 for SSE2 FPU translation
+#if C_FPU && !C_FPU_X86
+// the double precision FPU core keeps its stack in fpu.regs, so the common
+// arithmetic, compares and moves can be done inline with SSE2 and give the
+// exact results of the C functions; rdx holds the address of fpu
+#define DRC_USE_SSE2_FPU
+
+#define SSE2_ADDSD 0x58
+#define SSE2_MULSD 0x59
+#define SSE2_SUBSD 0x5c
+#define SSE2_DIVSD 0x5e
+
+static void gen_fpu_base(void) {
+	cache_addw(0xba48);		// mov rdx,&fpu
+	cache_addq((Bit64u)&fpu);
+}
+
+// [rdx+index*(1<<scale)+offset]
+static void gen_fpu_memaddr(Bitu reg,HostReg index,Bitu scale,Bitu offset) {
+	cache_addb(0x84+(reg<<3));
+	cache_addb((scale<<6)+(index<<3)+HOST_EDX);
+	cache_addd((Bit32u)offset);
+}
+
+// fpu.regs[FC_OP1].d = fpu.regs[FC_OP1].d op fpu.regs[FC_OP2].d, or
+// fpu.regs[FC_OP1].d = fpu.regs[FC_OP2].d op fpu.regs[FC_OP1].d if reversed
+static void gen_fpu_sse2_arith(Bit8u sse_op,bool reversed) {
+	gen_fpu_base();
+	cache_addw(0x0ff2);		// movsd xmm0,first
+	cache_addb(0x10);
+	gen_fpu_memaddr(0,reversed ? FC_OP2 : FC_OP1,3,offsetof(FPU_rec,regs));
+	cache_addw(0x0ff2);		// op xmm0,second
+	cache_addb(sse_op);
+	gen_fpu_memaddr(0,reversed ? FC_OP1 : FC_OP2,3,offsetof(FPU_rec,regs));
+	cache_addw(0x0ff2);		// movsd fpu.regs[FC_OP1],xmm0
+	cache_addb(0x11);
+	gen_fpu_memaddr(0,FC_OP1,3,offsetof(FPU_rec,regs));
+}
+
+// compare fpu.regs[FC_OP1] with fpu.regs[FC_OP2] into C3/C2/C0 the way
+// FPU_FCOM does: registers that aren't valid or zero compare as unordered,
+// NaNs compare as greater
+static void gen_fpu_sse2_compare(void) {
+	gen_fpu_base();
+	cache_addb(0x8b);		// mov ecx,fpu.tags[FC_OP1]
+	gen_fpu_memaddr(HOST_ECX,FC_OP1,2,offsetof(FPU_rec,tags));
+	cache_addb(0x0b);		// or ecx,fpu.tags[FC_OP2]
+	gen_fpu_memaddr(HOST_ECX,FC_OP2,2,offsetof(FPU_rec,tags));
+	cache_addb(0xb8);		// mov eax,C3|C2|C0
+	cache_addd(0x4500);
+	cache_addw(0xf983);		// cmp ecx,TAG_Zero
+	cache_addb(TAG_Zero);
+	cache_addw(0x1f77);		// ja done
+	cache_addw(0x0ff2);		// movsd xmm0,fpu.regs[FC_OP1]
+	cache_addb(0x10);
+	gen_fpu_memaddr(0,FC_OP1,3,offsetof(FPU_rec,regs));
+	cache_addw(0x0f66);		// ucomisd xmm0,fpu.regs[FC_OP2]
+	cache_addb(0x2e);
+	gen_fpu_memaddr(0,FC_OP2,3,offsetof(FPU_rec,regs));
+	cache_addb(0xb8);		// mov eax,0
+	cache_addd(0);
+	cache_addw(0x067a);		// jp done
+	cache_addb(0x9f);		// lahf
+	cache_addb(0x25);		// and eax,C3|C0
+	cache_addd(0x4100);
+	// done:
+	cache_addw(0x8166);		// and word fpu.sw,~(C3|C2|C0)
+	cache_addb(0xa2);
+	cache_addd((Bit32u)offsetof(FPU_rec,sw));
+	cache_addw(0xbaff);
+	cache_addw(0x0966);		// or fpu.sw,ax
+	cache_addb(0x82);
+	cache_addd((Bit32u)offsetof(FPU_rec,sw));
+}
+
+// copy fpu.regs and fpu.tags of FC_OP1 to FC_OP2 like FPU_FST,
+// or exchange them like FPU_FXCH
+static void gen_fpu_move(bool exchange) {
+	gen_fpu_base();
+	cache_addw(0x8b48);		// mov rax,fpu.regs[FC_OP1]
+	gen_fpu_memaddr(HOST_EAX,FC_OP1,3,offsetof(FPU_rec,regs));
+	if (exchange) {
+		cache_addw(0x8b48);	// mov rcx,fpu.regs[FC_OP2]
+		gen_fpu_memaddr(HOST_ECX,FC_OP2,3,offsetof(FPU_rec,regs));
+		cache_addw(0x8948);	// mov fpu.regs[FC_OP1],rcx
+		gen_fpu_memaddr(HOST_ECX,FC_OP1,3,offsetof(FPU_rec,regs));
+	}
+	cache_addw(0x8948);		// mov fpu.regs[FC_OP2],rax
+	gen_fpu_memaddr(HOST_EAX,FC_OP2,3,offsetof(FPU_rec,regs));
+	cache_addb(0x8b);		// mov eax,fpu.tags[FC_OP1]
+	gen_fpu_memaddr(HOST_EAX,FC_OP1,2,offsetof(FPU_rec,tags));
+	if (exchange) {
+		cache_addb(0x8b);	// mov ecx,fpu.tags[FC_OP2]
+		gen_fpu_memaddr(HOST_ECX,FC_OP2,2,offsetof(FPU_rec,tags));
+		cache_addb(0x89);	// mov fpu.tags[FC_OP1],ecx
+		gen_fpu_memaddr(HOST_ECX,FC_OP1,2,offsetof(FPU_rec,tags));
+	}
+	cache_addb(0x89);		// mov fpu.tags[FC_OP2],eax
+	gen_fpu_memaddr(HOST_EAX,FC_OP2,2,offsetof(FPU_rec,tags));
+}
+
+// FPU_PREP_PUSH, leaving the new TOP in FC_RETOP
+static void gen_fpu_push(void) {
+	gen_fpu_base();
+	cache_addw(0x828b);		// mov eax,fpu.top
+	cache_addd((Bit32u)offsetof(FPU_rec,top));
+	cache_addw(0xc8ff);		// dec eax
+	cache_addw(0xe083);		// and eax,7
+	cache_addb(7);
+	cache_addw(0x8948);		// mov fpu.top,rax
+	cache_addb(0x82);
+	cache_addd((Bit32u)offsetof(FPU_rec,top));
+	cache_addb(0xc7);		// mov fpu.tags[rax],TAG_Valid
+	gen_fpu_memaddr(0,HOST_EAX,2,offsetof(FPU_rec,tags));
+	cache_addd(TAG_Valid);
+}
+
+// FPU_FPOP
+static void gen_fpu_pop(void) {
+	gen_fpu_base();
+	cache_addw(0x828b);		// mov eax,fpu.top
+	cache_addd((Bit32u)offsetof(FPU_rec,top));
+	cache_addb(0xc7);		// mov fpu.tags[rax],TAG_Empty
+	gen_fpu_memaddr(0,HOST_EAX,2,offsetof(FPU_rec,tags));
+	cache_addd(TAG_Empty);
+	cache_addw(0xc0ff);		// inc eax
+	cache_addw(0xe083);		// and eax,7
+	cache_addb(7);
+	cache_addw(0x8948);		// mov fpu.top,rax
+	cache_addb(0x82);
+	cache_addd((Bit32u)offsetof(FPU_rec,top));
+}
+#endif
+//--End of modifications
+
 
 static void gen_run_code(void) {
 	cache_addb(0x53);					// push rbx
+	//--Added 2026-10-19 for guest register caching
+	cache_addw(0x5441);					// push r12
+	cache_addw(0x5541);					// push r13
+	cache_addw(0x5641);					// push r14
+	cache_addw(0x5741);					// push r15
+	//--End of modifications
 	cache_addw(0xd0ff+(FC_OP1<<8));		// call rdi
+	//--Added 2026-10-19 for guest register caching
+	cache_addw(0x5f41);					// pop  r15
+	cache_addw(0x5e41);					// pop  r14
+	cache_addw(0x5d41);					// pop  r13
+	cache_addw(0x5c41);					// pop  r12
+	//--End of modifications
 	cache_addb(0x5b);					// pop  rbx
 }
 
 // return from a function
 static void gen_return_function(void) {
+	//--Added 2026-10-19 for guest register caching
+	gen_regcache_forget();
+	//--End of modifications
 	cache_addb(0xc3);		// ret
 }
 
@@ -30,6 +30,11 @@
 // try to replace _simple functions by code
 #define DRC_FLAGS_INVALIDATION_DCODE
 
+//--Added 2026-10-19 for inline TLB lookups
+// look up host memory pages in the TLB inline instead of calling the memory helpers
+#define DRC_USE_INLINE_TLB
+//--End of modifications
+
 // type with the same size as a pointer
 #define DRC_PTR_SIZE_IM Bit32u
 
@@ -423,6 +428,74 @@ static void gen_fill_branch_long(Bit32u data) {
 	*(Bit32u*)data=((Bit32u)cache.pos-data-4);
 }
 
+//--Added 2026-10-19 for inline TLB lookups
+// look up the page of the address in FC_OP1 in the given TLB table, and branch
+// to the code that follows if it isn't backed by host memory or an access of
+// size bytes would cross into the next page
+// on a hit the host address of the page is left in eax
+static void gen_inline_tlb_lookup(HostPt * table,Bitu size,Bit32u * misses) {
+	misses[0]=0;
+	if (size>1) {
+		gen_mov_regs(HOST_EAX,FC_OP1);
+		gen_and_imm(HOST_EAX,0xfff);
+		cache_addw(0xf881);		// cmp eax,imm
+		cache_addd(0x1001-size);
+		cache_addw(0x0073);		// jae miss
+		misses[0]=(Bit32u)cache.pos-1;
+	}
+	gen_mov_regs(HOST_EAX,FC_OP1);
+	cache_addw(0xe8c1);			// shr eax,12
+	cache_addb(0x0c);
+	cache_addw(0x048b);			// mov eax,[table+eax*4]
+	cache_addb(0x85);
+	cache_addd((Bit32u)table);
+	cache_addw(0xc085);			// test eax,eax
+	cache_addw(0x0074);			// jz miss
+	misses[1]=(Bit32u)cache.pos-1;
+}
+
+// jump over the helper call that follows a hit, and point the misses to it
+static Bit32u gen_inline_tlb_hit(Bit32u * misses) {
+	cache_addw(0x00eb);			// jmp done
+	Bit32u hit=(Bit32u)cache.pos-1;
+	if (misses[0]) gen_fill_branch(misses[0]);
+	gen_fill_branch(misses[1]);
+	return hit;
+}
+
+// read size bytes from the address in FC_OP1 into dest_reg (zero-extended)
+// if its page is backed by host memory, otherwise fall through to the code
+// that follows; returns the branch to fill in at the end of that code
+static Bit32u gen_inline_tlb_read(HostReg dest_reg,Bitu size) {
+	Bit32u misses[2];
+	gen_inline_tlb_lookup(paging.tlb.read,size,misses);
+	switch (size) {
+		case 1:cache_addw(0xb60f);break;	// movzx dest_reg,byte [eax+FC_OP1]
+		case 2:cache_addw(0xb70f);break;	// movzx dest_reg,word [eax+FC_OP1]
+		default:cache_addb(0x8b);break;		// mov dest_reg,[eax+FC_OP1]
+	}
+	cache_addb(0x04+(dest_reg<<3));
+	cache_addb(FC_OP1<<3);
+	return gen_inline_tlb_hit(misses);
+}
+
+// write size bytes of FC_OP2 to the address in FC_OP1 if its page is backed
+// by host memory, otherwise fall through to the code that follows; returns
+// the branch to fill in at the end of that code
+static Bit32u gen_inline_tlb_write(Bitu size) {
+	Bit32u misses[2];
+	gen_inline_tlb_lookup(paging.tlb.write,size,misses);
+	switch (size) {
+		case 1:cache_addb(0x88);break;		// mov [eax+FC_OP1],FC_OP2 (byte)
+		case 2:cache_addw(0x8966);break;	// mov [eax+FC_OP1],FC_OP2 (word)
+		default:cache_addb(0x89);break;		// mov [eax+FC_OP1],FC_OP2
+	}
+	cache_addb(0x04+(FC_OP2<<3));
+	cache_addb(FC_OP1<<3);
+	return gen_inline_tlb_hit(misses);
+}
+//--End of modifications
+
 
 static void gen_run_code(void) {
 	cache_addd(0x0424448b);		// mov eax,[esp+4]
@@ -17,6 +17,9 @@
  */
 
 #include <stdio.h>
+//--Added 2026-10-19 for bulk string operations
+#include <string.h>
+//--End of modifications
 
 #include "dosbox.h"
 #include "mem.h"
@@ -10,6 +10,274 @@ enum STRING_OP {
 
 #define LoadD(_BLAH) _BLAH
 
+//--Added 2026-10-19 for bulk string operations
+/* Long REP MOVS/STOS/SCAS/CMPS runs are done a page at a time straight on host
+   memory, when the TLB has a host pointer for the page. Anything else, like
+   handler pages, elements straddling a page and address wraparound, goes
+   through the ordinary memory functions one element at a time. */
+#define STRING_BULK_MIN 16
+
+/* How many elements of size bytes, starting at base+index and moving by step,
+   stay within one page without the index wrapping round add_mask */
+static INLINE Bitu StringSpan(PhysPt base,Bitu index,Bits step,Bitu add_mask,Bitu size) {
+	Bitu offset=(base+index) & 4095;
+	if (offset+size>4096) return 0;
+	Bitu n,left;
+	if (step>0) {
+		n=(4096-offset)/size;
+		left=(add_mask-index)/size;
+		if (left<n) n=left+1;
+	} else {
+		n=offset/size+1;
+		left=index/size+1;
+		if (left<n) n=left;
+	}
+	return n;
+}
+
+static INLINE Bit32u StringHostRead(HostPt p,Bitu size) {
+	switch (size) {
+	case 1:return host_readb(p);
+	case 2:return host_readw(p);
+	default:return host_readd(p);
+	}
+}
+
+static INLINE Bit32u StringMemRead(PhysPt addr,Bitu size) {
+	switch (size) {
+	case 1:return LoadMb(addr);
+	case 2:return LoadMw(addr);
+	default:return LoadMd(addr);
+	}
+}
+
+static INLINE void StringMemWrite(PhysPt addr,Bitu size,Bit32u val) {
+	switch (size) {
+	case 1:SaveMb(addr,(Bit8u)val);break;
+	case 2:SaveMw(addr,(Bit16u)val);break;
+	default:SaveMd(addr,val);break;
+	}
+}
+
+static void StringBulkMovs(Bitu size,Bits step,PhysPt si_base,Bitu & si_index,PhysPt di_base,Bitu & di_index,Bitu add_mask,Bitu & count) {
+	while (count) {
+		Bitu n=0;
+		HostPt src=get_tlb_read(si_base+si_index);
+		HostPt dst=get_tlb_write(di_base+di_index);
+		if (src && dst) {
+			n=StringSpan(si_base,si_index,step,add_mask,size);
+			Bitu dn=StringSpan(di_base,di_index,step,add_mask,size);
+			if (dn<n) n=dn;
+			if (n>count) n=count;
+		}
+		if (n<2) {
+			StringMemWrite(di_base+di_index,size,StringMemRead(si_base+si_index,size));
+			si_index=(si_index+step) & add_mask;
+			di_index=(di_index+step) & add_mask;
+			count--;
+			continue;
+		}
+		Bitu bytes=n*size;
+		src+=si_base+si_index;
+		dst+=di_base+di_index;
+		if (step<0) {
+			src-=bytes-size;
+			dst-=bytes-size;
+		}
+		/* memmove only gives the same result as copying element by element
+		   if no element is read after the copy has already overwritten it */
+		if (step>0 ? (dst<=src || dst>=src+bytes) : (dst>=src || dst+bytes<=src)) {
+			memmove(dst,src,bytes);
+		} else {
+			Bit32u val;
+			if (step>0) for (Bitu i=0;i<bytes;i+=size) {
+				memcpy(&val,src+i,size);memcpy(dst+i,&val,size);
+			} else for (Bitu i=bytes;i>0;i-=size) {
+				memcpy(&val,src+i-size,size);memcpy(dst+i-size,&val,size);
+			}
+		}
+		si_index=(si_index+step*(Bits)n) & add_mask;
+		di_index=(di_index+step*(Bits)n) & add_mask;
+		count-=n;
+	}
+}
+
+static void StringBulkStos(Bitu size,Bits step,Bit32u val,PhysPt di_base,Bitu & di_index,Bitu add_mask,Bitu & count) {
+	/* Words and dwords made of one repeated byte can be filled like bytes */
+	bool fill=(size==1) || (size==2 && (val>>8)==(val&0xff)) || (size==4 && val==(val&0xff)*0x01010101);
+	while (count) {
+		Bitu n=0;
+		HostPt dst=get_tlb_write(di_base+di_index);
+		if (dst) {
+			n=StringSpan(di_base,di_index,step,add_mask,size);
+			if (n>count) n=count;
+		}
+		if (n<2) {
+			StringMemWrite(di_base+di_index,size,val);
+			di_index=(di_index+step) & add_mask;
+			count--;
+			continue;
+		}
+		Bitu bytes=n*size;
+		dst+=di_base+di_index;
+		if (step<0) dst-=bytes-size;
+		if (fill) memset(dst,val&0xff,bytes);
+		else if (size==2) for (Bitu i=0;i<bytes;i+=2) host_writew(dst+i,(Bit16u)val);
+		else for (Bitu i=0;i<bytes;i+=4) host_writed(dst+i,val);
+		di_index=(di_index+step*(Bits)n) & add_mask;
+		count-=n;
+	}
+}
+
+/* Scans until an element breaks the repeat condition, counting a cycle per element
+   like the ordinary loop does. Returns the last element read. */
+static Bit32u StringBulkScas(Bitu size,Bits step,Bit32u acc,PhysPt di_base,Bitu & di_index,Bitu add_mask,Bitu & count) {
+	Bit32u val2=0;
+	while (count) {
+		Bitu n=0;
+		HostPt dst=get_tlb_read(di_base+di_index);
+		if (dst) {
+			n=StringSpan(di_base,di_index,step,add_mask,size);
+			if (n>count) n=count;
+		}
+		if (n<2) {
+			count--;CPU_Cycles--;
+			val2=StringMemRead(di_base+di_index,size);
+			di_index=(di_index+step) & add_mask;
+			if ((acc==val2)!=core.rep_zero) break;
+			continue;
+		}
+		dst+=di_base+di_index;
+		Bitu done=n;bool stop=false;
+		if (size==1 && step>0 && !core.rep_zero) {
+			HostPt found=(HostPt)memchr(dst,(int)acc,n);
+			if (found) {
+				done=(Bitu)(found-dst)+1;
+				stop=true;
+			}
+			val2=host_readb(dst+(done-1));
+		} else {
+			for (Bitu i=0;i<n;i++) {
+				val2=StringHostRead(dst,size);
+				dst+=step;
+				if ((acc==val2)!=core.rep_zero) {
+					done=i+1;
+					stop=true;
+					break;
+				}
+			}
+		}
+		count-=done;CPU_Cycles-=done;
+		di_index=(di_index+step*(Bits)done) & add_mask;
+		if (stop) break;
+	}
+	return val2;
+}
+
+static void StringBulkCmps(Bitu size,Bits step,PhysPt si_base,Bitu & si_index,PhysPt di_base,Bitu & di_index,Bitu add_mask,Bitu & count,Bit32u & val1,Bit32u & val2) {
+	while (count) {
+		Bitu n=0;
+		HostPt src=get_tlb_read(si_base+si_index);
+		HostPt dst=get_tlb_read(di_base+di_index);
+		if (src && dst) {
+			n=StringSpan(si_base,si_index,step,add_mask,size);
+			Bitu dn=StringSpan(di_base,di_index,step,add_mask,size);
+			if (dn<n) n=dn;
+			if (n>count) n=count;
+		}
+		if (n<2) {
+			count--;CPU_Cycles--;
+			val1=StringMemRead(si_base+si_index,size);
+			val2=StringMemRead(di_base+di_index,size);
+			si_index=(si_index+step) & add_mask;
+			di_index=(di_index+step) & add_mask;
+			if ((val1==val2)!=core.rep_zero) break;
+			continue;
+		}
+		src+=si_base+si_index;
+		dst+=di_base+di_index;
+		Bitu done=n;bool stop=false;
+		/* REPE over two identical blocks is the common case */
+		HostPt lo_src=src,lo_dst=dst;
+		if (step<0) {
+			lo_src-=(n-1)*size;
+			lo_dst-=(n-1)*size;
+		}
+		if (core.rep_zero && !memcmp(lo_src,lo_dst,n*size)) {
+			val1=val2=StringHostRead(src+step*(Bits)(n-1),size);
+		} else {
+			for (Bitu i=0;i<n;i++) {
+				val1=StringHostRead(src,size);
+				val2=StringHostRead(dst,size);
+				src+=step;dst+=step;
+				if ((val1==val2)!=core.rep_zero) {
+					done=i+1;
+					stop=true;
+					break;
+				}
+			}
+		}
+		count-=done;CPU_Cycles-=done;
+		si_index=(si_index+step*(Bits)done) & add_mask;
+		di_index=(di_index+step*(Bits)done) & add_mask;
+		if (stop) break;
+	}
+}
+
+static bool DoStringBulk(STRING_OP type,PhysPt si_base,Bitu & si_index,PhysPt di_base,Bitu & di_index,Bitu add_mask,Bitu & count) {
+	Bitu size;
+	switch (type) {
+	case R_MOVSB:case R_STOSB:case R_SCASB:case R_CMPSB:size=1;break;
+	case R_MOVSW:case R_STOSW:case R_SCASW:case R_CMPSW:size=2;break;
+	case R_MOVSD:case R_STOSD:case R_SCASD:case R_CMPSD:size=4;break;
+	default:return false;
+	}
+	Bits step=cpu.direction*(Bits)size;
+	Bit32u val1,val2;
+	switch (type) {
+	case R_MOVSB:case R_MOVSW:case R_MOVSD:
+		StringBulkMovs(size,step,si_base,si_index,di_base,di_index,add_mask,count);
+		break;
+	case R_STOSB:
+		StringBulkStos(size,step,reg_al,di_base,di_index,add_mask,count);
+		break;
+	case R_STOSW:
+		StringBulkStos(size,step,reg_ax,di_base,di_index,add_mask,count);
+		break;
+	case R_STOSD:
+		StringBulkStos(size,step,reg_eax,di_base,di_index,add_mask,count);
+		break;
+	case R_SCASB:
+		val2=StringBulkScas(size,step,reg_al,di_base,di_index,add_mask,count);
+		CMPB(reg_al,(Bit8u)val2,LoadD,0);
+		break;
+	case R_SCASW:
+		val2=StringBulkScas(size,step,reg_ax,di_base,di_index,add_mask,count);
+		CMPW(reg_ax,(Bit16u)val2,LoadD,0);
+		break;
+	case R_SCASD:
+		val2=StringBulkScas(size,step,reg_eax,di_base,di_index,add_mask,count);
+		CMPD(reg_eax,val2,LoadD,0);
+		break;
+	case R_CMPSB:
+		StringBulkCmps(size,step,si_base,si_index,di_base,di_index,add_mask,count,val1,val2);
+		CMPB((Bit8u)val1,(Bit8u)val2,LoadD,0);
+		break;
+	case R_CMPSW:
+		StringBulkCmps(size,step,si_base,si_index,di_base,di_index,add_mask,count,val1,val2);
+		CMPW((Bit16u)val1,(Bit16u)val2,LoadD,0);
+		break;
+	case R_CMPSD:
+		StringBulkCmps(size,step,si_base,si_index,di_base,di_index,add_mask,count,val1,val2);
+		CMPD(val1,val2,LoadD,0);
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+//--End of modifications
+
 static void DoString(STRING_OP type) {
 	PhysPt  si_base,di_base;
 	Bitu	si_index,di_index;
@@ -41,7 +309,11 @@ static void DoString(STRING_OP type) {
 		}
 	}
 	add_index=cpu.direction;
-	if (count) switch (type) {
+	//--Modified 2026-10-19 for bulk string operations
+	//if (count) switch (type) {
+	if (count && !(TEST_PREFIX_REP && count>=STRING_BULK_MIN &&
+		DoStringBulk(type,si_base,si_index,di_base,di_index,add_mask,count))) switch (type) {
+	//--End of modifications
 	case R_OUTSB:
 		for (;count>0;count--) {
 			IO_WriteB(reg_dx,LoadMb(si_base+si_index));
@@ -19,6 +19,9 @@
 /* $Id: core_prefetch.cpp,v 1.3 2009-06-26 16:43:30 c2woody Exp $ */
 
 #include <stdio.h>
+//--Added 2026-10-19 for bulk string operations
+#include <string.h>
+//--End of modifications
 
 #include "dosbox.h"
 #include "mem.h"
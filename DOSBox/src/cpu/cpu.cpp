@@ -29,7 +29,15 @@
 #include "programs.h"
 #include "paging.h"
 #include "lazyflags.h"
+//--Added 2026-10-19 to save and load the processor state
+#include "savestate.h"
+#include "fpu.h"
+//--End of modifications
 #include "support.h"
+//--Added 2026-10-19 for automatic core selection
+#include "pic.h"
+#include "timer.h"
+//--End of modifications
 
 Bitu DEBUG_EnableDebugger(void);
 extern void GFX_SetTitle(Bit32s cycles ,Bits frameskip,bool paused);
@@ -2169,6 +2177,193 @@ void CPU_Reset_AutoAdjust(void) {
 	ticksScheduled = 0;
 }
 
+//--Added 2026-10-19 for automatic core selection
+/* With core=auto the cores are measured against each other while the program
+   runs. Every decoder call charges the cycles it ran and the host time it took
+   to the core that ran it, and every AUTOCORE_WINDOW emulated milliseconds the
+   other core may be tried out. It is kept if it ran at least AUTOCORE_MARGIN
+   percent more instructions per millisecond, otherwise the previous core comes
+   back and the next try waits twice as long. The first window after a switch
+   is not measured, as the recompiler spends it translating. Entering protected
+   mode still switches to the dynamic core, which now is only a first guess. */
+#define AUTOCORE_WINDOW		250		// emulated ms between reviews
+#define AUTOCORE_MIN_CYCLES	100000	// cycles a window must have run to be measured
+#define AUTOCORE_MARGIN		20		// percent a tried core must be faster by to be kept
+#define AUTOCORE_MIN_STAY	4		// windows to stay with a core before trying the other
+#define AUTOCORE_RETRY		8		// windows before the other core is tried again
+#define AUTOCORE_RETRY_MAX	256		// at most, after it has lost a few times
+#define AUTOCORE_MIN_REUSE	1000	// cycles run per block translated below which the recompiler thrashes
+#define AUTOCORE_MIN_BLOCKS	64		// blocks translated before invalidations count as thrashing
+
+bool CPU_AutoCoreActive = false;
+
+#if (C_DYNAMIC_X86) || (C_DYNREC)
+enum { AUTOCORE_NORMAL, AUTOCORE_DYNAMIC, AUTOCORE_CORES };
+
+static const char * autocore_names[AUTOCORE_CORES]={ "normal","dynamic" };
+
+static struct {
+	Bitu current;					// the core that was running at the last review
+	bool trial;						// the current core is being tried out
+	const char * reason;			// and why
+	Bitu since_switch;				// reviews since the current core was switched to
+	Bitu since_trial;				// reviews since the other core was last tried
+	Bitu retry;						// reviews to wait before trying it again
+	Bitu rate[AUTOCORE_CORES];		// instructions per host ms last measured, 0 if unknown
+	Bit64u cycles[AUTOCORE_CORES];	// cycles run in this window
+	Bit64u micros[AUTOCORE_CORES];	// host microseconds they took
+	Bitu window_start;				// PIC_Ticks at the start of this window
+} autocore;
+
+static Bitu CPU_AutoCore_Index(CPU_Decoder * decoder) {
+	if (decoder==&CPU_Core_Normal_Run) return AUTOCORE_NORMAL;
+#if (C_DYNAMIC_X86)
+	if (decoder==&CPU_Core_Dyn_X86_Run) return AUTOCORE_DYNAMIC;
+#elif (C_DYNREC)
+	if (decoder==&CPU_Core_Dynrec_Run) return AUTOCORE_DYNAMIC;
+#endif
+	return AUTOCORE_CORES;
+}
+
+static void CPU_AutoCore_Switch(Bitu core) {
+	if (core==AUTOCORE_DYNAMIC) {
+#if (C_DYNAMIC_X86)
+		CPU_Core_Dyn_X86_Cache_Init(true);
+		cpudecoder=&CPU_Core_Dyn_X86_Run;
+#elif (C_DYNREC)
+		CPU_Core_Dynrec_Cache_Init(true);
+		cpudecoder=&CPU_Core_Dynrec_Run;
+#endif
+	} else cpudecoder=&CPU_Core_Normal_Run;
+	autocore.current=core;
+	autocore.since_switch=0;
+	//Lets Boxer pick up on the change like on the protected mode switch
+	GFX_SetTitle(-1,-1,false);
+}
+
+void CPU_AutoCore_Reset(bool active) {
+	autocore.current=CPU_AutoCore_Index(cpudecoder);
+	autocore.trial=false;
+	autocore.since_switch=0;
+	autocore.since_trial=0;
+	autocore.retry=AUTOCORE_RETRY;
+	for (Bitu i=0;i<AUTOCORE_CORES;i++) {
+		autocore.rate[i]=0;
+		autocore.cycles[i]=autocore.micros[i]=0;
+	}
+	autocore.window_start=PIC_Ticks;
+#if (C_DYNREC)
+	Bitu translated,invalidated;
+	CPU_Core_Dynrec_GetCodeStats(translated,invalidated,true);
+#endif
+	CPU_AutoCoreActive=active;
+}
+
+static void CPU_AutoCore_Review(void) {
+	Bitu core=CPU_AutoCore_Index(cpudecoder);
+	//Halted or single-stepping, look again once the core is back
+	if (core>=AUTOCORE_CORES) return;
+	if (core!=autocore.current) {
+		//Switched by something else, like entering protected mode or loading a state
+		autocore.current=core;
+		autocore.trial=false;
+		autocore.since_switch=0;
+	}
+	Bitu other=core^1;
+
+	Bit64u cycles=autocore.cycles[core];
+	Bit64u micros=autocore.micros[core];
+	for (Bitu i=0;i<AUTOCORE_CORES;i++) autocore.cycles[i]=autocore.micros[i]=0;
+	autocore.window_start=PIC_Ticks;
+
+	Bitu translated=0,invalidated=0;
+#if (C_DYNREC)
+	CPU_Core_Dynrec_GetCodeStats(translated,invalidated,true);
+#endif
+	if (autocore.since_switch && (cycles>=AUTOCORE_MIN_CYCLES) && micros) {
+		Bitu rate=(Bitu)(cycles*1000/micros);
+		//Smooth over the windows since the switch, but forget earlier stays
+		if ((autocore.since_switch>1) && autocore.rate[core]) rate=(rate+autocore.rate[core])/2;
+		autocore.rate[core]=rate;
+	}
+	autocore.since_switch++;
+
+	if (autocore.trial) {
+		if (autocore.since_switch<2) return;
+		autocore.trial=false;
+		autocore.since_trial=0;
+		Bitu tried=autocore.rate[core];
+		Bitu before=autocore.rate[other];
+		if (tried && ((Bit64u)tried*100>=(Bit64u)before*(100+AUTOCORE_MARGIN))) {
+			LOG_MSG("CPU: core=auto tried the %s core (%s): %u instructions/ms against %u with the %s core, switching.",
+				autocore_names[core],autocore.reason,(unsigned int)tried,(unsigned int)before,autocore_names[other]);
+			autocore.retry=AUTOCORE_RETRY;
+		} else {
+			LOG_MSG("CPU: core=auto tried the %s core (%s): %u instructions/ms against %u with the %s core, staying.",
+				autocore_names[core],autocore.reason,(unsigned int)tried,(unsigned int)before,autocore_names[other]);
+			if (autocore.retry<AUTOCORE_RETRY_MAX) autocore.retry*=2;
+			CPU_AutoCore_Switch(other);
+			//The core comes back warm, no need to skip a window
+			autocore.since_switch=1;
+		}
+		return;
+	}
+
+	autocore.since_trial++;
+	if (autocore.since_switch<AUTOCORE_MIN_STAY) return;
+
+	//Hints that the other core would do better make it come up sooner
+	const char * reason="not tried for a while";
+	Bitu wait=autocore.retry;
+	if ((core==AUTOCORE_DYNAMIC) && (translated>=AUTOCORE_MIN_BLOCKS) &&
+		(invalidated*4>=translated || cycles<(Bit64u)translated*AUTOCORE_MIN_REUSE)) {
+		reason="translated code was modified or hardly reused";
+		wait/=4;
+	} else if (autocore.rate[core] && ((Bit64u)autocore.rate[other]*100>=(Bit64u)autocore.rate[core]*(100+AUTOCORE_MARGIN))) {
+		reason="it was faster when last tried";
+		wait/=4;
+	}
+	if (autocore.since_trial<wait) return;
+
+	autocore.trial=true;
+	autocore.reason=reason;
+	CPU_AutoCore_Switch(other);
+}
+
+Bits CPU_AutoCore_Run(void) {
+	CPU_Decoder * decoder=cpudecoder;
+	Bit64s budget=(Bit64s)CPU_Cycles+CPU_CycleLeft;
+	Bit64u start=GetMicroTicks();
+	Bits ret=(*decoder)();
+	Bit64u took=GetMicroTicks()-start;
+	//Calls that halted or single-stepped say nothing about how fast the core is
+	if (cpudecoder==decoder) {
+		Bitu core=CPU_AutoCore_Index(decoder);
+		Bit64s ran=budget-((Bit64s)CPU_Cycles+CPU_CycleLeft);
+		if ((core<AUTOCORE_CORES) && (ran>0)) {
+			autocore.cycles[core]+=(Bit64u)ran;
+			autocore.micros[core]+=took;
+		}
+	}
+	if (GCC_UNLIKELY(PIC_Ticks-autocore.window_start>=AUTOCORE_WINDOW)) {
+		//The core has been chosen by other means since, leave it be
+		if (!(CPU_AutoDetermineMode&(CPU_AUTODETERMINE_CORE|(CPU_AUTODETERMINE_CORE<<CPU_AUTODETERMINE_SHIFT)))) {
+			CPU_AutoCore_Reset(false);
+		} else CPU_AutoCore_Review();
+	}
+	return ret;
+}
+#else
+void CPU_AutoCore_Reset(bool active) {
+	CPU_AutoCoreActive=false;
+}
+
+Bits CPU_AutoCore_Run(void) {
+	return (*cpudecoder)();
+}
+#endif
+//--End of modifications
+
 class CPU: public Module_base {
 private:
 	static bool inited;
@@ -2232,6 +2427,53 @@ public:
 		Change_Config(configuration);	
 		CPU_JMP(false,0,0,0);					//Setup the first cpu core
 	}
+	//--Added 2026-10-19 to save and load the processor state
+	const char * GetStateName(void) { return "CPU"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(&cpu_regs,sizeof(cpu_regs));
+		state.WriteBlock(&Segs,sizeof(Segs));
+		state.WriteBlock(&lflags,sizeof(lflags));
+		state.WriteBlock(&cpu,sizeof(cpu));
+		state.WriteFunction(cpu.hlt.old_decoder);
+		state.WriteBlock(&cpu_tss,sizeof(cpu_tss));
+#if C_FPU
+		state.WriteBlock(&fpu,sizeof(fpu));
+#endif
+		state.WriteFunction(cpudecoder);
+		state.WriteD((Bit32u)CPU_Cycles);
+		state.WriteD((Bit32u)CPU_CycleLeft);
+		state.WriteD((Bit32u)CPU_AutoDetermineMode);
+		state.WriteD((Bit32u)CPU_flag_id_toggle);
+		state.WriteB(lastint);
+	}
+	bool LoadState(SaveStateReader & state) {
+		state.ReadBlock(&cpu_regs,sizeof(cpu_regs));
+		state.ReadBlock(&Segs,sizeof(Segs));
+		state.ReadBlock(&lflags,sizeof(lflags));
+		state.ReadBlock(&cpu,sizeof(cpu));
+		CPU_Decoder * old_decoder=state.ReadFunction<CPU_Decoder *>();
+		state.ReadBlock(&cpu_tss,sizeof(cpu_tss));
+#if C_FPU
+		state.ReadBlock(&fpu,sizeof(fpu));
+#endif
+		CPU_Decoder * decoder=state.ReadFunction<CPU_Decoder *>();
+		Bit32s cycles=(Bit32s)state.ReadD();
+		Bit32s cycle_left=(Bit32s)state.ReadD();
+		Bitu auto_determine=state.ReadD();
+		Bitu id_toggle=state.ReadD();
+		Bit8u last=state.ReadB();
+		if (state.Failed() || !decoder) return false;
+		if (state.Checking()) return true;
+		cpu.hlt.old_decoder=old_decoder;
+		cpudecoder=decoder;
+		CPU_Cycles=cycles;
+		CPU_CycleLeft=cycle_left;
+		CPU_AutoDetermineMode=auto_determine;
+		CPU_flag_id_toggle=id_toggle;
+		lastint=last;
+		return true;
+	}
+	//--End of modifications
 	bool Change_Config(Section* newconfig){
 		Section_prop * section=static_cast<Section_prop *>(newconfig);
 		CPU_AutoDetermineMode=CPU_AUTODETERMINE_NONE;
@@ -2390,6 +2632,10 @@ public:
 			CPU_ArchitectureType = CPU_ARCHTYPE_PENTIUMSLOW;
 		}
 
+		//--Added 2026-10-19 for automatic core selection
+		CPU_AutoCore_Reset((CPU_AutoDetermineMode&CPU_AUTODETERMINE_CORE)!=0);
+		//--End of modifications
+
 		if (CPU_ArchitectureType>=CPU_ARCHTYPE_486NEWSLOW) CPU_flag_id_toggle=FLAG_ID;
 		else CPU_flag_id_toggle=0;
 
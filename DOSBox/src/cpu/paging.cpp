@@ -30,6 +30,9 @@
 #include "cpu.h"
 #include "debug.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the paging state
+#include "savestate.h"
+//--End of modifications
 
 #define LINK_TOTAL		(64*1024)
 
@@ -882,6 +885,32 @@ public:
 		}
 		pf_queue.used=0;
 	}
+	//--Added 2026-10-19 to save and load the paging state
+	const char * GetStateName(void) { return "PAGING"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteD((Bit32u)paging.cr3);
+		state.WriteD((Bit32u)paging.cr2);
+		state.WriteBool(paging.enabled);
+		state.WriteBlock(paging.firstmb,sizeof(paging.firstmb));
+	}
+	bool LoadState(SaveStateReader & state) {
+		if (!state.Checking()) {
+			//Drop every page currently linked before the tables they came from change
+			PAGING_ClearTLB();
+		}
+		Bitu cr3=state.ReadD();
+		Bitu cr2=state.ReadD();
+		bool enabled=state.ReadBool();
+		state.ReadBlock(paging.firstmb,sizeof(paging.firstmb));
+		if (state.Failed()) return false;
+		if (state.Checking()) return true;
+		paging.cr2=cr2;
+		paging.enabled=enabled;
+		PAGING_SetDirBase(cr3);
+		PAGING_ClearTLB();
+		return true;
+	}
+	//--End of modifications
 	~PAGING(){}
 };
 
@@ -49,6 +49,9 @@ using namespace std;
 #include "../cpu/lazyflags.h"
 #include "keyboard.h"
 #include "setup.h"
+//--Added 2026-10-19 to show where the time of each frame goes
+#include "profile.h"
+//--End of modifications
 
 #ifdef WIN32
 void WIN32_Console();
@@ -1241,6 +1244,30 @@ bool ParseCommand(char* str) {
 		return true;
 	};
 
+	//--Added 2026-10-19 to show where the time of each frame goes
+	if (command == "PROFILE") {
+		if (!strcmp(found,"ON")) PROFILE_Start();
+		else if (!strcmp(found,"OFF")) PROFILE_Stop();
+		else if (!strcmp(found,"RESET")) PROFILE_Reset();
+		if (!profile_enabled) {
+			DEBUG_ShowMsg("DEBUG: Profiling is off.\n");
+			return true;
+		}
+		string report;
+		PROFILE_Report(report,PROFILE_TEXT);
+		istringstream lines(report);
+		string line;
+		while (getline(lines,line)) DEBUG_ShowMsg("%s\n",line.c_str());
+		return true;
+	};
+	//--End of modifications
+
+	//--Added 2026-10-19 for adaptive self-modifying code handling
+#if (C_DYNREC)
+	if (command == "CODEPAGES") {CPU_Core_Dynrec_ShowCodePages(); return true;}
+#endif
+	//--End of modifications
+
 
 #if C_HEAVY_DEBUG
 	if (command == "HEAVYLOG") { // Create Cpu log file
@@ -1308,6 +1335,14 @@ bool ParseCommand(char* str) {
 		DEBUG_ShowMsg("PAGING [page]             - Display content of page table.\n");
 		DEBUG_ShowMsg("EXTEND                    - Toggle additional info.\n");
 		DEBUG_ShowMsg("TIMERIRQ                  - Run the system timer.\n");
+		//--Added 2026-10-19 to show where the time of each frame goes
+		DEBUG_ShowMsg("PROFILE [ON/OFF/RESET]    - Show where the time of each frame goes.\n");
+		//--End of modifications
+		//--Added 2026-10-19 for adaptive self-modifying code handling
+#if (C_DYNREC)
+		DEBUG_ShowMsg("CODEPAGES                 - List modified code pages of the dynamic core.\n");
+#endif
+		//--End of modifications
 
 		DEBUG_ShowMsg("HELP                      - Help\n");
 		
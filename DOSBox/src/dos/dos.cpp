@@ -29,6 +29,9 @@
 #include "regs.h"
 #include "dos_inc.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the DOS state
+#include "savestate.h"
+//--End of modifications
 #include "support.h"
 #include "serialport.h"
 
@@ -1178,6 +1181,116 @@ public:
 		Bit32u ticks=(Bit32u)((loctime->tm_hour*3600+loctime->tm_min*60+loctime->tm_sec)*(float)PIT_TICK_RATE/65536.0);
 		mem_writed(BIOS_TIMER,ticks);
 	}
+	//--Added 2026-10-19 to save and load the kernel variables and open files.
+	//Files are matched up with the ones currently open by name, or else reopened
+	//by name: those that can no longer be found are left closed.
+	const char * GetStateName(void) { return "DOS"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(&dos.date,sizeof(dos.date));
+		state.WriteBlock(&dos.version,sizeof(dos.version));
+		state.WriteW(dos.firstMCB);
+		state.WriteW(dos.errorcode);
+		state.WriteW(dos.env);
+		state.WriteD(dos.cpmentry);
+		state.WriteB(dos.return_code);
+		state.WriteB(dos.return_mode);
+		state.WriteB(dos.current_drive);
+		state.WriteBool(dos.verify);
+		state.WriteBool(dos.breakcheck);
+		state.WriteBool(dos.echo);
+		state.WriteW(dos.loaded_codepage);
+
+		for (Bitu i=0;i<DOS_FILES;i++) {
+			DOS_File * file=Files[i];
+			state.WriteBool(file!=0);
+			if (!file) continue;
+			Bit32u pos=0;
+			bool device=(file->GetInformation() & 0x80)!=0;
+			if (!device) file->Seek(&pos,DOS_SEEK_CUR);
+			state.WriteBool(device);
+			state.WriteString(file->GetName() ? file->GetName() : "");
+			state.WriteB(file->GetDrive());
+			state.WriteD(file->flags);
+			state.WriteD((Bit32u)file->refCtr);
+			state.WriteD(pos);
+		}
+	}
+	bool LoadState(SaveStateReader & state) {
+		state.ReadBlock(&dos.date,sizeof(dos.date));
+		state.ReadBlock(&dos.version,sizeof(dos.version));
+		Bit16u firstMCB=state.ReadW();
+		Bit16u errorcode=state.ReadW();
+		Bit16u env=state.ReadW();
+		RealPt cpmentry=state.ReadD();
+		Bit8u return_code=state.ReadB();
+		Bit8u return_mode=state.ReadB();
+		Bit8u current_drive=state.ReadB();
+		bool verify=state.ReadBool();
+		bool breakcheck=state.ReadBool();
+		bool echo=state.ReadBool();
+		Bit16u loaded_codepage=state.ReadW();
+		if (!state.Checking()) {
+			dos.firstMCB=firstMCB;
+			dos.errorcode=errorcode;
+			dos.env=env;
+			dos.cpmentry=cpmentry;
+			dos.return_code=return_code;
+			dos.return_mode=return_mode;
+			dos.current_drive=current_drive;
+			dos.verify=verify;
+			dos.breakcheck=breakcheck;
+			dos.echo=echo;
+			dos.loaded_codepage=loaded_codepage;
+		}
+
+		for (Bitu i=0;i<DOS_FILES;i++) {
+			std::string name;
+			bool used=state.ReadBool();
+			bool device=false;
+			Bit8u drive=0xff;
+			Bit32u flags=0,refs=0,pos=0;
+			if (used) {
+				device=state.ReadBool();
+				name=state.ReadString();
+				drive=state.ReadB();
+				flags=state.ReadD();
+				refs=state.ReadD();
+				pos=state.ReadD();
+			}
+			if (state.Failed()) return false;
+			if (state.Checking()) continue;
+
+			DOS_File * file=Files[i];
+			bool matches=used && file && file->IsName(name.c_str()) &&
+				file->GetDrive()==drive && ((file->GetInformation() & 0x80)!=0)==device;
+			if (file && !matches) {
+				file->Close();
+				delete file;
+				Files[i]=0;
+			}
+			if (!used) continue;
+			if (!matches) {
+				if (device) {
+					Bit8u devnum=DOS_FindDevice(name.c_str());
+					if (devnum<DOS_DEVICES) Files[i]=new DOS_Device(*Devices[devnum]);
+				} else if (drive<DOS_DRIVES && Drives[drive] && Drives[drive]->FileOpen(&Files[i],name.c_str(),flags)) {
+					Files[i]->SetDrive(drive);
+				} else {
+					Files[i]=0;
+				}
+				if (!Files[i]) {
+					LOG_MSG("SAVESTATE:Could not reopen %s",name.c_str());
+					continue;
+				}
+			}
+			Files[i]->flags=flags;
+			Files[i]->refCtr=(Bits)refs;
+			if (!device) Files[i]->Seek(&pos,DOS_SEEK_SET);
+		}
+		return true;
+	}
+	//--End of modifications
+
 	~DOS(){
 		//--Modified 2009-12-20 by Alun Bestor to properly clear the devices list on shutdown.
 		//We could also do this with Files, but DOS_SetupFiles() already does this.
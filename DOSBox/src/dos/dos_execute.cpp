@@ -152,6 +152,10 @@ void DOS_Terminate(Bit16u pspseg,bool tsr,Bit8u exitcode) {
 		//--Added 2010-07-02 by Alun Bestor to notify Boxer when the core mode changes
 		GFX_SetTitle(-1,-1,false);
 		//--End of modifications
+		//--Added 2026-10-19 for automatic core selection: what was measured
+		//for the program that exited says nothing about the next one
+		CPU_AutoCore_Reset(true);
+		//--End of modifications
 	}
 #endif
 
@@ -418,6 +418,14 @@ bool DOS_CloseFile(Bit16u entry) {
 		DOS_SetError(DOSERR_INVALID_HANDLE);
 		return false;
 	};
+	//--Added 2026-10-19 so that buffered data that can't be written back fails
+	//the call; the handle is still released, as DOS does
+	bool flushed=true;
+	if (Files[handle]->IsOpen() && !Files[handle]->Flush()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		flushed=false;
+	}
+	//--End of modifications
 	if (Files[handle]->IsOpen()) {
 		Files[handle]->Close();
 	}
@@ -427,7 +435,10 @@ bool DOS_CloseFile(Bit16u entry) {
 		delete Files[handle];
 		Files[handle]=0;
 	}
-	return true;
+	//--Modified 2026-10-19 so that buffered data that can't be written back fails the call
+	//return true;
+	return flushed;
+	//--End of modifications
 }
 
 bool DOS_FlushFile(Bit16u entry) {
@@ -441,7 +452,14 @@ bool DOS_FlushFile(Bit16u entry) {
 		return false;
 	};
 	LOG(LOG_DOSMISC,LOG_NORMAL)("FFlush used.");
+	//--Modified 2026-10-19 to write back buffered file data
+	//return true;
+	if (!Files[handle]->Flush()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
 	return true;
+	//--End of modifications
 }
 
 static bool PathExists(char const * const name) {
@@ -45,10 +45,44 @@ public:
     //that their physical backing media will be removed.
     void willBecomeUnavailable(void);
     //--End of modifications
+    
+    //--Added 2026-10-19 to write back buffered data when DOS commits the file
+    bool Flush(void);
+    ~localFile();
+    //--End of modifications
 private:
 	FILE * fhandle;
 	bool read_only_medium;
-	enum { NONE,READ,WRITE } last_action;
+    
+    //--Replaced 2026-10-19 with block-level I/O: the FILE handle is now only used
+    //for opening and closing the file, and all reads and writes go through pread/pwrite
+    //on the underlying descriptor. Small reads are served from an aligned read-ahead
+    //window and sequential small writes are coalesced into a write-back buffer.
+	//enum { NONE,READ,WRITE } last_action;
+    
+    enum { BLOCK_SIZE = 16384 };
+    
+    bool FillReadBuffer(Bit32u start);
+    bool FlushWriteBuffer(void);
+    void InvalidateReadBuffer(void) { read_len = 0; }
+    Bit32u FileSize(void);
+    
+    int fd;
+    Bit32u filepos;
+    
+    Bit8u * read_buf;
+    Bit32u read_start, read_len, read_generation;
+    
+    Bit8u * write_buf;
+    Bit32u write_start, write_len;
+    
+    //Whether we have already faked drive motion for this file.
+    bool faked_motion;
+    
+    //Bumped whenever any local file writes to disk, so that read-ahead windows
+    //of other handles onto the same file are discarded.
+    static Bit32u write_generation;
+    //--End of modifications
 };
 
 
@@ -550,7 +584,52 @@ localDrive::localDrive(const char * startdir,Bit16u _bytes_sector,Bit8u _sectors
 }
 
 
-//TODO Maybe use fflush, but that seemed to fuck up in visual c
+Bit32u localFile::write_generation = 0;
+
+bool localFile::FillReadBuffer(Bit32u start) {
+	if (!read_buf) read_buf = new Bit8u[BLOCK_SIZE];
+	read_start = start;
+	read_len = 0;
+	read_generation = write_generation;
+	while (read_len < BLOCK_SIZE) {
+		ssize_t got = pread(fd, read_buf + read_len, BLOCK_SIZE - read_len, (off_t)(read_start + read_len));
+		if (got < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		if (got == 0) break;
+		read_len += (Bit32u)got;
+	}
+	return true;
+}
+
+bool localFile::FlushWriteBuffer(void) {
+	if (!write_len) return true;
+	Bit32u done = 0;
+	while (done < write_len) {
+		ssize_t put = pwrite(fd, write_buf + done, write_len - done, (off_t)(write_start + done));
+		if (put <= 0) {
+			if (put < 0 && errno == EINTR) continue;
+			//Out of space or failed outright: the rest of the buffer is lost
+			break;
+		}
+		done += (Bit32u)put;
+	}
+	bool success = (done == write_len);
+	write_len = 0;
+	write_generation++;
+	return success;
+}
+
+Bit32u localFile::FileSize(void) {
+	struct stat temp_stat;
+	Bit32u size = 0;
+	if (fstat(fd, &temp_stat) == 0) size = (Bit32u)temp_stat.st_size;
+	//Pending writes may extend the file beyond what is on disk
+	if (write_len && write_start + write_len > size) size = write_start + write_len;
+	return size;
+}
+
 bool localFile::Read(Bit8u * data,Bit16u * size) {
 	if ((this->flags & 0xf) == OPEN_WRITE) {	// check if file opened in write-only mode
 		DOS_SetError(DOSERR_ACCESS_DENIED);
@@ -569,14 +648,57 @@ bool localFile::Read(Bit8u * data,Bit16u * size) {
     }
     //--End of modifications
     
-	if (last_action==WRITE) fseek(fhandle,ftell(fhandle),SEEK_SET);
-	last_action=READ;
-	*size=(Bit16u)fread(data,1,*size,fhandle);
+    //--Replaced 2026-10-19 with buffered block reads
+	//if (last_action==WRITE) fseek(fhandle,ftell(fhandle),SEEK_SET);
+	//last_action=READ;
+	//*size=(Bit16u)fread(data,1,*size,fhandle);
+    
+    //Write back anything pending first so that we read what was written
+    if (!FlushWriteBuffer()) {
+        *size = 0;
+        DOS_SetError(DOSERR_ACCESS_DENIED);
+        return false;
+    }
+    if (read_generation != write_generation) InvalidateReadBuffer();
+    
+	Bit32u want = *size;
+	Bit32u done = 0;
+	while (done < want) {
+		//Serve as much as we can from the read-ahead window
+		if (read_len && filepos >= read_start && filepos < read_start + read_len) {
+			Bit32u avail = read_start + read_len - filepos;
+			Bit32u chunk = (want - done < avail) ? (want - done) : avail;
+			memcpy(data + done, read_buf + (filepos - read_start), chunk);
+			done += chunk;
+			filepos += chunk;
+			continue;
+		}
+		//Large reads bypass the window entirely
+		if (want - done >= BLOCK_SIZE) {
+			ssize_t got = pread(fd, data + done, want - done, (off_t)filepos);
+			if (got < 0 && errno == EINTR) continue;
+			if (got <= 0) break;
+			done += (Bit32u)got;
+			filepos += (Bit32u)got;
+			continue;
+		}
+		//Otherwise refill the window from the enclosing aligned block
+		if (!FillReadBuffer(filepos & ~(Bit32u)(BLOCK_SIZE - 1))) break;
+		if (filepos >= read_start + read_len) break;	//End of file
+	}
+	*size = (Bit16u)done;
+    //--End of modifications
+    
 	/* Fake harddrive motion. Inspector Gadget with soundblaster compatible */
 	/* Same for Igor */
 	/* hardrive motion => unmask irq 2. Only do it when it's masked as unmasking is realitively heavy to emulate */
-	Bit8u mask = IO_Read(0x21);
-	if(mask & 0x4 ) IO_Write(0x21,mask&0xfb);
+    //--Modified 2026-10-19 to only fake drive motion once per file rather than on every read
+    if (!faked_motion) {
+        faked_motion = true;
+        Bit8u mask = IO_Read(0x21);
+        if(mask & 0x4 ) IO_Write(0x21,mask&0xfb);
+    }
+    //--End of modifications
 	return true;
 }
 
@@ -598,16 +720,56 @@ bool localFile::Write(Bit8u * data,Bit16u * size) {
     }
     //--End of modifications
     
-	if (last_action==READ) fseek(fhandle,ftell(fhandle),SEEK_SET);
-	last_action=WRITE;
+    //--Replaced 2026-10-19 with coalesced block writes
+	//if (last_action==READ) fseek(fhandle,ftell(fhandle),SEEK_SET);
+	//last_action=WRITE;
 	if(*size==0){  
-        return (!ftruncate(fileno(fhandle),ftell(fhandle)));
+        //return (!ftruncate(fileno(fhandle),ftell(fhandle)));
+        if (!FlushWriteBuffer()) {
+            DOS_SetError(DOSERR_ACCESS_DENIED);
+            return false;
+        }
+        InvalidateReadBuffer();
+        write_generation++;
+        return (!ftruncate(fd,(off_t)filepos));
     }
-    else 
-    {
-		*size=(Bit16u)fwrite(data,1,*size,fhandle);
-		return true;
+    
+    Bit32u len = *size;
+    
+    //Discard the read-ahead window if this write lands inside it
+    if (read_len && filepos < read_start + read_len && filepos + len > read_start)
+        InvalidateReadBuffer();
+    
+    //Non-sequential writes flush whatever we had pending
+    if (write_len && (filepos != write_start + write_len || write_len + len > BLOCK_SIZE)) {
+        if (!FlushWriteBuffer()) {
+            *size = 0;
+            DOS_SetError(DOSERR_ACCESS_DENIED);
+            return false;
+        }
+    }
+    
+    if (len >= BLOCK_SIZE) {
+        Bit32u done = 0;
+        while (done < len) {
+            ssize_t put = pwrite(fd, data + done, len - done, (off_t)(filepos + done));
+            if (put < 0 && errno == EINTR) continue;
+            if (put <= 0) break;
+            done += (Bit32u)put;
+        }
+        write_generation++;
+        filepos += done;
+        *size = (Bit16u)done;
+        return true;
     }
+    
+    if (!write_buf) write_buf = new Bit8u[BLOCK_SIZE];
+    if (!write_len) write_start = filepos;
+    memcpy(write_buf + write_len, data, len);
+    write_len += len;
+    filepos += len;
+    return true;
+    //--End of modifications
 }
 
 bool localFile::Seek(Bit32u * pos,Bit32u type) {
@@ -634,27 +796,52 @@ bool localFile::Seek(Bit32u * pos,Bit32u type) {
     }
     //--End of modifications
     
-	int ret=fseek(fhandle,*reinterpret_cast<Bit32s*>(pos),seektype);
-	if (ret!=0) {
+    //--Replaced 2026-10-19 to track the file position ourselves
+	//int ret=fseek(fhandle,*reinterpret_cast<Bit32s*>(pos),seektype);
+	//if (ret!=0) {
+	//	// Out of file range, pretend everythings ok 
+	//	// and move file pointer top end of file... ?! (Black Thorne)
+	//	fseek(fhandle,0,SEEK_END);
+	//};
+    Bit64s base = 0;
+    switch (seektype) {
+    case SEEK_CUR: base = filepos; break;
+    case SEEK_END: base = FileSize(); break;
+    }
+    Bit64s newpos = base + *reinterpret_cast<Bit32s*>(pos);
+	if (newpos < 0 || newpos > 0xFFFFFFFFLL) {
 		// Out of file range, pretend everythings ok 
 		// and move file pointer top end of file... ?! (Black Thorne)
-		fseek(fhandle,0,SEEK_END);
+		newpos = FileSize();
 	};
+    filepos = (Bit32u)newpos;
+    //--End of modifications
 #if 0
 	fpos_t temppos;
 	fgetpos(fhandle,&temppos);
 	Bit32u * fake_pos=(Bit32u*)&temppos;
 	*pos=*fake_pos;
 #endif
-	*pos=(Bit32u)ftell(fhandle);
-	last_action=NONE;
+	*pos=filepos;
 	return true;
 }
 
+//--Added 2026-10-19 to write back buffered data when DOS commits the file
+bool localFile::Flush(void) {
+    if (!fhandle) return true;
+    return FlushWriteBuffer();
+}
+//--End of modifications
+
 bool localFile::Close() {
 	// only close if one reference left
 	if (refCtr==1) {
-		if(fhandle) fclose(fhandle);
+        //--Modified 2026-10-19 to write back buffered data before closing
+		if(fhandle) {
+            FlushWriteBuffer();
+            fclose(fhandle);
+        }
+        //--End of modifications
 		fhandle = 0;
 		open = false;
 	};
@@ -669,16 +856,39 @@ Bit16u localFile::GetInformation(void) {
 localFile::localFile(const char* _name, FILE * handle) {
 	fhandle=handle;
 	open=true;
+    
+    //--Modified 2026-10-19 for block-level I/O
+    fd=fileno(handle);
+    filepos=0;
+    read_buf=0;
+    read_start=read_len=0;
+    read_generation=write_generation;
+    write_buf=0;
+    write_start=write_len=0;
+    faked_motion=false;
+    //--End of modifications
+    
 	UpdateDateTimeFromHost();
 
 	attr=DOS_ATTR_ARCHIVE;
-	last_action=NONE;
+	//last_action=NONE;
 	read_only_medium=false;
 
 	name=0;
 	SetName(_name);
 }
 
+//--Added 2026-10-19 to release our I/O buffers
+localFile::~localFile() {
+    if (fhandle) {
+        FlushWriteBuffer();
+        fclose(fhandle);
+    }
+    delete[] read_buf;
+    delete[] write_buf;
+}
+//--End of modifications
+
 void localFile::FlagReadOnlyMedium(void) {
 	read_only_medium = true;
 }
@@ -688,10 +898,14 @@ bool localFile::UpdateDateTimeFromHost(void) {
     
     //--Added 2011-11-03 by Alun Bestor to avoid errors on closed files
     if (!fhandle) return false;
+    //--End of modifications
+    
+    //--Added 2026-10-19 so that the timestamp reflects any buffered writes
+    FlushWriteBuffer();
     //--End of modifications
     
 	struct stat temp_stat;
-	fstat(fileno(fhandle),&temp_stat);
+	fstat(fd,&temp_stat);
 	struct tm * ltime;
 	if((ltime=localtime(&temp_stat.st_mtime))!=0) {
 		time=DOS_PackTime((Bit16u)ltime->tm_hour,(Bit16u)ltime->tm_min,(Bit16u)ltime->tm_sec);
@@ -710,6 +924,8 @@ void localFile::willBecomeUnavailable()
     //our file handle but leave the DOS file flagged as 'open'.
     if (fhandle)
     {
+        FlushWriteBuffer();
+        InvalidateReadBuffer();
 		fclose(fhandle);
 		fhandle = 0;
     }
@@ -42,6 +42,12 @@
 #include "mapper.h"
 #include "ints/int10.h"
 #include "render.h"
+#include "savestate.h"
+#include "replay.h"
+//--Added 2026-10-19 to measure where the time of each frame goes
+#include "profile.h"
+#include "benchmark.h"
+//--End of modifications
 
 Config * control;
 MachineType machine;
@@ -98,6 +104,14 @@ void TIMER_Init(Section*);
 void BIOS_Init(Section*);
 void DEBUG_Init(Section*);
 void CMOS_Init(Section*);
+//--Added 2026-10-19 to save, load and replay machine states
+void SAVESTATE_Init(Section*);
+void REPLAY_Init(Section*);
+//--End of modifications
+//--Added 2026-10-19 to measure emulation speed
+void BENCHMARK_Init(Section*);
+void PROFILE_Init(Section*);
+//--End of modifications
 
 void MSCDEX_Init(Section*);
 void DRIVES_Init(Section*);
@@ -124,6 +138,9 @@ static Bit32u ticksAdded;
 Bit32s ticksDone;
 Bit32u ticksScheduled;
 bool ticksLocked;
+//--Added 2026-10-19 to benchmark the emulation
+static bool ticksPaced=true;
+//--End of modifications
 
 static Bitu Normal_Loop(void) {
 	Bits ret;
@@ -132,10 +149,41 @@ static Bitu Normal_Loop(void) {
 		if (!boxer_runLoopShouldContinue()) return 1;
 		//--End of modifications
 		
-		if (PIC_RunQueue()) {
-			ret=(*cpudecoder)();
+		//--Modified 2026-10-19 to measure where the time of each frame goes, to let core=auto
+		//and benchmarks time the cores, to save or load states between ticks (where the machine
+		//state is consistent) and to record and replay input deterministically
+		//if (PIC_RunQueue()) {
+		//	ret=(*cpudecoder)();
+		//	if (GCC_UNLIKELY(ret<0)) return 1;
+		//	if (ret>0) {
+		//		Bitu blah=(*CallBack_Handlers[ret])();
+		//		if (GCC_UNLIKELY(blah)) return blah;
+		//	}
+//#if C_DEBUG
+		//	if (DEBUG_ExitLoop()) return 0;
+//#endif
+		//} else {
+		//	GFX_Events();
+		//	if (ticksRemain>0) {
+		//		TIMER_AddTick();
+		//		ticksRemain--;
+		//	} else goto increaseticks;
+		//}
+		bool run;
+		{
+			ProfileScope scope(PROFILE_EVENTS);
+			run=PIC_RunQueue();
+		}
+		if (run) {
+			{
+				ProfileScope scope(PROFILE_CPU);
+				BenchmarkCoreScope bench_scope;
+				if (GCC_UNLIKELY(CPU_AutoCoreActive)) ret=CPU_AutoCore_Run();
+				else ret=(*cpudecoder)();
+			}
 			if (GCC_UNLIKELY(ret<0)) return 1;
 			if (ret>0) {
+				ProfileScope scope(PROFILE_CALLBACKS);
 				Bitu blah=(*CallBack_Handlers[ret])();
 				if (GCC_UNLIKELY(blah)) return blah;
 			}
@@ -143,15 +191,28 @@ static Bitu Normal_Loop(void) {
 			if (DEBUG_ExitLoop()) return 0;
 #endif
 		} else {
-			GFX_Events();
+			{
+				ProfileScope scope(PROFILE_HOST);
+				GFX_Events();
+				SAVESTATE_RunRequests();
+			}
 			if (ticksRemain>0) {
-				TIMER_AddTick();
+				REPLAY_Tick();
+				{
+					ProfileScope scope(PROFILE_TICKS);
+					TIMER_AddTick();
+				}
+				PROFILE_Tick();
 				ticksRemain--;
 			} else goto increaseticks;
 		}
+		//--End of modifications
 	}
 increaseticks:
-	if (GCC_UNLIKELY(ticksLocked)) {
+	//--Modified 2026-10-19 to run replays and benchmarks without waiting on the host clock
+	//if (GCC_UNLIKELY(ticksLocked)) {
+	if (GCC_UNLIKELY(ticksLocked || !ticksPaced || REPLAY_IsPlaying())) {
+	//--End of modifications
 		ticksRemain=5;
 		/* Reset any auto cycle guessing for this frame */
 		ticksLast = GetTicks();
@@ -167,6 +228,9 @@ increaseticks:
 			ticksLast = ticksNew;
 			ticksDone += ticksRemain;
 			if ( ticksRemain > 20 ) {
+				//--Added 2026-10-19 to count the milliseconds the emulation can't catch up on
+				PROFILE_DropTicks(ticksRemain-20);
+				//--End of modifications
 				ticksRemain = 20;
 			}
 			ticksAdded = ticksRemain;
@@ -225,7 +289,13 @@ increaseticks:
 			}
 		} else {
 			ticksAdded = 0;
-			SDL_Delay(1);
+			//--Modified 2026-10-19 to measure where the time of each frame goes
+			//SDL_Delay(1);
+			{
+				ProfileScope scope(PROFILE_IDLE);
+				SDL_Delay(1);
+			}
+			//--End of modifications
 			ticksDone -= GetTicks() - ticksNew;
 			if (ticksDone < 0)
 				ticksDone = 0;
@@ -242,6 +312,12 @@ void DOSBOX_SetNormalLoop() {
 	loop=Normal_Loop;
 }
 
+//--Added 2026-10-19 to benchmark the emulation
+void DOSBOX_SetPacing(bool paced) {
+	ticksPaced=paced;
+}
+//--End of modifications
+
 void DOSBOX_RunMachine(void){
 	Bitu ret;
 	do {
@@ -374,6 +450,14 @@ void DOSBOX_Init(void) {
 	secprop->AddInitFunction(&PROGRAMS_Init);
 	secprop->AddInitFunction(&TIMER_Init);//done
 	secprop->AddInitFunction(&CMOS_Init);//done
+	//--Added 2026-10-19 to save, load and replay machine states
+	secprop->AddInitFunction(&SAVESTATE_Init);
+	secprop->AddInitFunction(&REPLAY_Init);
+	//--End of modifications
+	//--Added 2026-10-19 to measure emulation speed
+	secprop->AddInitFunction(&BENCHMARK_Init);
+	secprop->AddInitFunction(&PROFILE_Init);
+	//--End of modifications
 
 	secprop=control->AddSection_prop("render",&RENDER_Init,true);
 	Pint = secprop->Add_int("frameskip",Property::Changeable::Always,0);
@@ -412,7 +496,11 @@ void DOSBOX_Init(void) {
 		"normal", "simple",0 };
 	Pstring = secprop->Add_string("core",Property::Changeable::WhenIdle,"auto");
 	Pstring->Set_values(cores);
-	Pstring->Set_help("CPU Core used in emulation. auto will switch to dynamic if available and appropriate.");
+	//--Modified 2026-10-19 for automatic core selection
+	//Pstring->Set_help("CPU Core used in emulation. auto will switch to dynamic if available and appropriate.");
+	Pstring->Set_help("CPU Core used in emulation. auto will switch between normal and dynamic if available,\n"
+		"depending on which of them runs the program faster.");
+	//--End of modifications
 
 	const char* cputype_values[] = { "auto", "386", "386_slow", "486_slow", "pentium_slow", "386_prefetch", 0};
 	Pstring = secprop->Add_string("cputype",Property::Changeable::Always,"auto");
@@ -32,6 +32,9 @@
 #include "pic.h"
 #include "hardware.h"
 #include "timer.h"
+//--Added 2026-10-19 for the MIDI dispatch thread
+#include "SDL_thread.h"
+//--End of modifications
 
 //--Added 2011-09-25 by Alun Bestor to let Boxer hook into MIDI messaging
 #include "BXCoalfaceAudio.h"
@@ -111,6 +114,10 @@ MidiHandler Midi_none;
 
 //--End of modifications
 
+//--Added 2026-10-19 for an MT-32 synth built into the emulator
+#include "midi_mt32.h"
+//--End of modifications
+
 
 static struct {
 	Bitu status;
@@ -128,18 +135,171 @@ static struct {
 	MidiHandler * handler;
 } midi;
 
+//--Added 2026-10-19 to send MIDI from its own thread, so that waiting on a slow MIDI device
+//(such as a real MT-32 digesting a sysex upload) never holds up the emulation.
+#define MIDI_QUEUE_SIZE (256*1024)
+#define MIDI_QUEUE_MASK (MIDI_QUEUE_SIZE-1)
+/* How far ahead of the host clock a message may be scheduled before we give up on
+   keeping its emulated timing, e.g. when the emulation is running faster than realtime */
+#define MIDI_MAX_AHEAD 50000
+
+struct MidiQueueEntry {
+	double time;	//Emulated time in milliseconds, from PIC_FullIndex
+	Bit16u len;
+	bool sysex;
+};
+
+/* Messages are written into a ring buffer as an entry followed by the message itself.
+   Only the emulation thread moves head and only the dispatch thread moves tail and sent,
+   so neither side needs a lock; the semaphore counts the messages waiting. */
+static struct {
+	Bit8u buf[MIDI_QUEUE_SIZE];
+	volatile Bitu head,tail;
+	volatile Bitu sent;		//How far the messages that reached the device go
+	SDL_sem * pending;
+	SDL_Thread * thread;
+	volatile bool quit;
+} midi_queue;
+
+static void MIDI_QueueWrite(Bitu pos,const void * data,Bitu len) {
+	const Bit8u * src=(const Bit8u *)data;
+	pos&=MIDI_QUEUE_MASK;
+	Bitu first=MIDI_QUEUE_SIZE-pos;
+	if (first>len) first=len;
+	memcpy(&midi_queue.buf[pos],src,first);
+	memcpy(midi_queue.buf,src+first,len-first);
+}
+
+static void MIDI_QueueRead(Bitu pos,void * data,Bitu len) {
+	Bit8u * dest=(Bit8u *)data;
+	pos&=MIDI_QUEUE_MASK;
+	Bitu first=MIDI_QUEUE_SIZE-pos;
+	if (first>len) first=len;
+	memcpy(dest,&midi_queue.buf[pos],first);
+	memcpy(dest+first,midi_queue.buf,len-first);
+}
+
+static void MIDI_Send(Bit8u * msg,Bitu len,bool sysex) {
+	/* The built-in synth takes its messages right away and keeps its own time */
+	if (midi.handler && midi.handler!=&Midi_none) {
+		if (sysex) midi.handler->PlaySysex(msg,len);
+		else midi.handler->PlayMsg(msg);
+		return;
+	}
+	if (GCC_UNLIKELY(!midi_queue.thread)) {
+		if (sysex) boxer_sendMIDISysex(msg,len);
+		else boxer_sendMIDIMessage(msg);
+		return;
+	}
+	/* Attaching the device, MT-32 detection and anything else that may wait on the frontend
+	   happen here on the emulation thread. Synths that render into the mixer are fed right
+	   away, as the mixer runs on this thread too. Only what is left goes into the queue. */
+	if (sysex ? !boxer_prepareMIDISysex(msg,len) : !boxer_prepareMIDIMessage(msg)) return;
+	MidiQueueEntry entry;
+	entry.time=PIC_FullIndex();
+	entry.len=(Bit16u)len;
+	entry.sysex=sysex;
+	Bitu needed=sizeof(entry)+len;
+	/* Only a sysex upload far bigger than any device takes in at once can fill the queue:
+	   rather than drop any of it, hold the emulation until the device catches up. */
+	while (MIDI_QUEUE_SIZE-(midi_queue.head-midi_queue.tail)<needed) SDL_Delay(1);
+	MIDI_QueueWrite(midi_queue.head,&entry,sizeof(entry));
+	MIDI_QueueWrite(midi_queue.head+sizeof(entry),msg,len);
+	/* The message must be in place before the dispatch thread can see the new head */
+	__sync_synchronize();
+	midi_queue.head+=needed;
+	SDL_SemPost(midi_queue.pending);
+}
+
+static int MIDI_DispatchThread(void * /*data*/) {
+	Bit8u msg[SYSEX_SIZE];
+	MidiQueueEntry entry;
+	double emulated_base=0;
+	Bit64u host_base=0;
+	bool synced=false;
+	while (true) {
+		SDL_SemWait(midi_queue.pending);
+		if (midi_queue.quit) break;
+		__sync_synchronize();
+		MIDI_QueueRead(midi_queue.tail,&entry,sizeof(entry));
+		MIDI_QueueRead(midi_queue.tail+sizeof(entry),msg,entry.len);
+		__sync_synchronize();
+		midi_queue.tail+=sizeof(entry)+entry.len;
+
+		/* Keep the spacing the messages had in emulated time, which smooths out the bursts
+		   the emulation produces them in. If we have fallen behind or are too far ahead,
+		   start again from this message. */
+		Bit64u now=GetMicroTicks();
+		Bit64s due=(Bit64s)host_base+(Bit64s)((entry.time-emulated_base)*1000.0);
+		if (!synced || due<(Bit64s)now || due>(Bit64s)(now+MIDI_MAX_AHEAD)) {
+			host_base=now;
+			emulated_base=entry.time;
+			synced=true;
+		} else if (due>(Bit64s)now) {
+			SDL_Delay((Bit32u)((due-now)/1000));
+		}
+		/* Then give the device as long as it needs for any earlier sysex */
+		double wait;
+		while (!midi_queue.quit && (wait=boxer_secondsUntilMIDIDeviceIsReady())>0) {
+			SDL_Delay((Bit32u)(wait*1000)+1);
+		}
+		if (midi_queue.quit) break;
+		if (entry.sysex) boxer_dispatchMIDISysex(msg,entry.len);
+		else boxer_dispatchMIDIMessage(msg);
+		midi_queue.sent=midi_queue.tail;
+	}
+	return 0;
+}
+
+/* Called by the frontend before it swaps the MIDI device, so that nothing meant for the
+   old device is still on its way. Returns at once when there is no dispatch thread. */
+void MIDI_WaitForDispatch(void) {
+	Bitu target=midi_queue.head;
+	while (midi_queue.thread && !midi_queue.quit && (Bits)(target-midi_queue.sent)>0) SDL_Delay(1);
+}
+
+static void MIDI_StartDispatch(void) {
+	midi_queue.head=midi_queue.tail=midi_queue.sent=0;
+	midi_queue.quit=false;
+	midi_queue.pending=SDL_CreateSemaphore(0);
+	midi_queue.thread=midi_queue.pending ? SDL_CreateThread(MIDI_DispatchThread,0) : 0;
+	if (!midi_queue.thread) LOG_MSG("MIDI:Can't start dispatch thread, sending MIDI directly");
+}
+
+static void MIDI_StopDispatch(void) {
+	if (midi_queue.thread) {
+		/* Anything still queued is dropped */
+		midi_queue.quit=true;
+		SDL_SemPost(midi_queue.pending);
+		SDL_WaitThread(midi_queue.thread,0);
+		midi_queue.thread=0;
+	}
+	if (midi_queue.pending) {
+		SDL_DestroySemaphore(midi_queue.pending);
+		midi_queue.pending=0;
+	}
+}
+//--End of modifications
+
 void MIDI_RawOutByte(Bit8u data) {
+	//--Disabled 2026-10-19: sysex pacing is now done by the dispatch thread against the host clock,
+	//instead of by sleeping the emulation thread
+	/*
 	if (midi.sysex.start) {
 		Bit32u passed_ticks = GetTicks() - midi.sysex.start;
 		if (passed_ticks < midi.sysex.delay) SDL_Delay(midi.sysex.delay - passed_ticks);
 	}
+	*/
+	//--End of modifications
 
 	/* Test for a realtime MIDI message */
 	if (data>=0xf8) {
 		midi.rt_buf[0]=data;
         //--Replaced 2011-09-25 by Alun Bestor to pass messages on to our own MIDI handling
         //midi.handler->PlayMsg(midi.rt_buf);
-        boxer_sendMIDIMessage(midi.rt_buf);
+        //--Modified 2026-10-19 to queue messages for the dispatch thread
+        //boxer_sendMIDIMessage(midi.rt_buf);
+        MIDI_Send(midi.rt_buf,1,false);
         //--End of modifications
 		return;
 	}	 
@@ -158,7 +318,9 @@ void MIDI_RawOutByte(Bit8u data) {
                 
                 //--Replaced 2011-09-25 by Alun Bestor to pass messages on to our own MIDI handling
 				//midi.handler->PlaySysex(midi.sysex.buf, midi.sysex.used);
-                boxer_sendMIDISysex(midi.sysex.buf, midi.sysex.used);
+                //--Modified 2026-10-19 to queue messages for the dispatch thread
+                //boxer_sendMIDISysex(midi.sysex.buf, midi.sysex.used);
+                MIDI_Send(midi.sysex.buf, midi.sysex.used, true);
                 //--End of modifications
                 
 				if (midi.sysex.start) {
@@ -203,7 +365,9 @@ void MIDI_RawOutByte(Bit8u data) {
             
             //--Replaced 2011-09-25 by Alun Bestor to pass messages on to our own MIDI handling
             //midi.handler->PlayMsg(midi.cmd_buf);
-            boxer_sendMIDIMessage(midi.cmd_buf);
+            //--Modified 2026-10-19 to queue messages for the dispatch thread
+            //boxer_sendMIDIMessage(midi.cmd_buf);
+            MIDI_Send(midi.cmd_buf, midi.cmd_len, false);
             //--End of modifications
             
 			midi.cmd_pos=1;		//Use Running status
@@ -253,7 +417,9 @@ public:
         
         //--Modified 2011-09-25 by Alun Bestor: DOSBox's MIDI handlers are all disabled,
         //so skip straight to the 'none' handler.
-        goto getdefault;
+        //--Modified 2026-10-19: except for the built-in MT-32, which is only used when asked for by name
+        //goto getdefault;
+        if (strcasecmp(dev,"mt32")) goto getdefault;
         //--End of modifications
         
 		if (!strcasecmp(dev,"default")) goto getdefault;
@@ -275,7 +441,10 @@ public:
 getdefault:	
 		handler=handler_list;
 		while (handler) {
-			if (handler->Open(conf)) {
+			//--Modified 2026-10-19 to keep the built-in MT-32 from being picked as a default
+			//if (handler->Open(conf)) {
+			if (handler!=&Midi_mt32 && handler->Open(conf)) {
+			//--End of modifications
 				midi.available=true;	
 				midi.handler=handler;
 				LOG_MSG("MIDI:Opened device:%s",handler->GetName());
@@ -296,8 +465,14 @@ getdefault:
 static MIDI* test;
 void MIDI_Destroy(Section* /*sec*/){
 	delete test;
+	//--Added 2026-10-19 for the MIDI dispatch thread
+	MIDI_StopDispatch();
+	//--End of modifications
 }
 void MIDI_Init(Section * sec) {
 	test = new MIDI(sec);
+	//--Added 2026-10-19 for the MIDI dispatch thread
+	MIDI_StartDispatch();
+	//--End of modifications
 	sec->AddDestroyFunction(&MIDI_Destroy,true);
 }
@@ -0,0 +1,328 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* An MT-32 synthesizer inside the emulator, rather than behind the frontend's MIDI handling.
+   Selected with mididevice=mt32; midiconfig gives the directory holding the MT-32 (or CM-32L)
+   ROMs, optionally followed by ",inline".
+
+   Each message is given the frame of the output it should sound at, worked out from its
+   emulated time, so that it lands where it was played rather than wherever the next
+   block of audio happens to start. By default a worker thread renders up to
+   MT32_LATENCY_FRAMES ahead of the mixer into a ring buffer, which the mixer channel
+   just copies out of; with "inline" the mixer channel renders the synth itself, which
+   needs no latency but puts all of the synth's work on the emulation thread. Both
+   report their rendering cost and event latency to the log when closed, for comparison. */
+
+#include "MT32Emu/mt32emu.h"
+#include "mixer.h"
+#include "SDL_thread.h"
+
+#define MT32_SAMPLE_RATE 32000
+/* Frames rendered ahead of the mixer in threaded mode: 32ms */
+#define MT32_LATENCY_FRAMES 1024
+#define MT32_RING_FRAMES 8192
+#define MT32_RING_MASK (MT32_RING_FRAMES-1)
+#define MT32_RENDER_CHUNK 256
+#define MT32_EVENT_SLOTS 4096
+#define MT32_EVENT_MASK (MT32_EVENT_SLOTS-1)
+
+class MidiHandler_mt32 : public MidiHandler {
+private:
+	struct Event {
+		Bitu frame;			//Output frame to play the event at
+		Bitu delay;			//How many frames after its emulated time that is
+		Bit32u msg;
+		Bit8u * sysex;		//Owned by the queue until played
+		Bitu sysex_len;
+	};
+
+	MT32Emu::Synth * synth;
+	MixerChannel * chan;
+	bool threaded;
+
+	/* Written by the emulation thread, read by the renderer */
+	Event events[MT32_EVENT_SLOTS];
+	volatile Bitu event_write,event_read;
+	/* Frames the mixer has taken so far, and the emulated time it last took any */
+	volatile Bitu mixer_pos;
+	double mixer_time;
+
+	/* Rendered frames waiting for the mixer; ring_write is also how far the synth has got */
+	Bit16s ring[MT32_RING_FRAMES][2];
+	volatile Bitu ring_write,ring_read;
+
+	SDL_Thread * thread;
+	SDL_sem * wake;			//Posted when the mixer has taken some frames
+	SDL_sem * rendered;		//Posted when the renderer has added some
+	volatile bool quit;
+
+	struct {
+		Bit64u micros;
+		Bit64u frames;
+		Bit64u events;
+		Bit64u delay;
+		Bitu late;
+		Bitu underruns;
+	} stats;
+
+	static MidiHandler_mt32 * active;
+
+	static int ReportHandler(void * /*userData*/,MT32Emu::ReportType type,const void * reportData) {
+		switch (type) {
+		case MT32Emu::ReportType_lcdMessage:
+			LOG_MSG("MT32:LCD-Display: %s",(const char *)reportData);
+			break;
+		case MT32Emu::ReportType_errorControlROM:
+			LOG_MSG("MT32:Couldn't open control ROM");
+			break;
+		case MT32Emu::ReportType_errorPCMROM:
+			LOG_MSG("MT32:Couldn't open PCM ROM");
+			break;
+		default:
+			break;
+		}
+		return 0;
+	}
+
+	static void DebugHandler(void * /*userData*/,const char * /*fmt*/,va_list /*list*/) {
+	}
+
+	void QueueEvent(Bit32u msg,Bit8u * sysex,Bitu sysex_len) {
+		/* Place the event as far after the mixer's last block as it came in emulated time */
+		Bitu delay=(threaded ? MT32_LATENCY_FRAMES : 0);
+		double since=PIC_FullIndex()-mixer_time;
+		if (since>0) delay+=(Bitu)(since*MT32_SAMPLE_RATE/1000.0);
+		while (event_write-event_read>=MT32_EVENT_SLOTS) {
+			if (!threaded) {
+				LOG(LOG_MISC,LOG_WARN)("MT32:Event queue full, dropping message");
+				delete[] sysex;
+				return;
+			}
+			SDL_Delay(1);
+		}
+		Event & event=events[event_write&MT32_EVENT_MASK];
+		event.frame=mixer_pos+delay;
+		event.delay=delay;
+		event.msg=msg;
+		event.sysex=sysex;
+		event.sysex_len=sysex_len;
+		__sync_synchronize();
+		event_write++;
+	}
+
+	/* Renders frames starting at ring_write, playing each event on its frame */
+	void Render(Bit16s * buffer,Bitu frames) {
+		Bit64u start=GetMicroTicks();
+		Bitu pos=ring_write;
+		while (frames) {
+			Bitu todo=frames;
+			while (event_read!=event_write) {
+				__sync_synchronize();
+				Event & event=events[event_read&MT32_EVENT_MASK];
+				Bits ahead=(Bits)(event.frame-pos);
+				if (ahead>0) {
+					if ((Bitu)ahead<todo) todo=(Bitu)ahead;
+					break;
+				}
+				if (event.sysex) {
+					synth->playSysex(event.sysex,(Bit32u)event.sysex_len);
+					delete[] event.sysex;
+				} else synth->playMsg(event.msg);
+				stats.events++;
+				stats.delay+=event.delay-ahead;
+				if (ahead<0) stats.late++;
+				event_read++;
+			}
+			synth->render(buffer,(Bit32u)todo);
+			buffer+=todo*2;
+			pos+=todo;
+			frames-=todo;
+		}
+		stats.frames+=pos-ring_write;
+		stats.micros+=GetMicroTicks()-start;
+	}
+
+	static int RenderThread(void * data) {
+		MidiHandler_mt32 * handler=(MidiHandler_mt32 *)data;
+		Bit16s buffer[MT32_RENDER_CHUNK][2];
+		while (!handler->quit) {
+			/* Every event for a frame before mixer_pos+MT32_LATENCY_FRAMES is queued by now */
+			Bitu horizon=handler->mixer_pos+MT32_LATENCY_FRAMES;
+			__sync_synchronize();
+			Bits todo=(Bits)(horizon-handler->ring_write);
+			/* After an underrun the mixer has moved on without some frames, so they'll be played late: don't overrun the ring while it catches up */
+			Bits space=(Bits)(MT32_RING_FRAMES-(handler->ring_write-handler->ring_read));
+			if (todo>space) todo=space;
+			if (todo>MT32_RENDER_CHUNK) todo=MT32_RENDER_CHUNK;
+			if (todo<=0) {
+				SDL_SemWaitTimeout(handler->wake,10);
+				continue;
+			}
+			handler->Render(&buffer[0][0],(Bitu)todo);
+			for (Bits i=0;i<todo;i++) {
+				Bitu pos=(handler->ring_write+i)&MT32_RING_MASK;
+				handler->ring[pos][0]=buffer[i][0];
+				handler->ring[pos][1]=buffer[i][1];
+			}
+			__sync_synchronize();
+			handler->ring_write+=(Bitu)todo;
+			SDL_SemPost(handler->rendered);
+		}
+		return 0;
+	}
+
+	static void MixerCallBack(Bitu len) {
+		active->Mix(len);
+	}
+
+	void Mix(Bitu len) {
+		Bit16s * buffer=(Bit16s *)MixTemp;
+		if (len>MIXER_BUFSIZE/4) len=MIXER_BUFSIZE/4;
+		if (threaded) {
+			/* The renderer normally has these ready; give it a little while if not */
+			Bitu tries=0;
+			while (ring_write-ring_read<len && tries++<20) {
+				SDL_SemPost(wake);
+				SDL_SemWaitTimeout(rendered,1);
+			}
+			__sync_synchronize();
+			Bitu available=ring_write-ring_read;
+			if (available<len) stats.underruns++;
+			for (Bitu i=0;i<len;i++) {
+				if (i<available) {
+					Bitu pos=(ring_read+i)&MT32_RING_MASK;
+					buffer[i*2]=ring[pos][0];
+					buffer[i*2+1]=ring[pos][1];
+				} else buffer[i*2]=buffer[i*2+1]=0;
+			}
+			if (available>len) available=len;
+			__sync_synchronize();
+			ring_read+=available;
+		} else {
+			Render(buffer,len);
+			ring_write+=len;
+			ring_read+=len;
+		}
+		mixer_pos+=len;
+		mixer_time=PIC_FullIndex();
+		if (threaded) SDL_SemPost(wake);
+		chan->AddSamples_s16(len,buffer);
+	}
+
+public:
+	MidiHandler_mt32() : synth(0),chan(0),threaded(true),thread(0),wake(0),rendered(0) {}
+	const char * GetName(void) { return "mt32"; }
+
+	bool Open(const char * conf) {
+		std::string romdir=conf;
+		threaded=true;
+		std::string::size_type option=romdir.rfind(',');
+		if (option!=std::string::npos) {
+			if (!strcasecmp(romdir.c_str()+option+1,"inline")) threaded=false;
+			romdir.erase(option);
+		}
+		if (!romdir.empty() && romdir[romdir.size()-1]!=CROSS_FILESPLIT) romdir+=CROSS_FILESPLIT;
+
+		MT32Emu::SynthProperties properties;
+		memset(&properties,0,sizeof(properties));
+		properties.sampleRate=MT32_SAMPLE_RATE;
+		properties.baseDir=romdir.empty() ? 0 : romdir.c_str();
+		properties.userData=this;
+		properties.report=&ReportHandler;
+		properties.printDebug=&DebugHandler;
+
+		synth=new MT32Emu::Synth();
+		if (!synth->open(properties)) {
+			LOG_MSG("MT32:Can't open synth with ROMs from %s",romdir.empty() ? "the current directory" : romdir.c_str());
+			delete synth;
+			synth=0;
+			return false;
+		}
+
+		memset(&stats,0,sizeof(stats));
+		event_write=event_read=0;
+		ring_write=ring_read=0;
+		mixer_pos=0;
+		mixer_time=PIC_FullIndex();
+		quit=false;
+		active=this;
+		chan=MIXER_AddChannel(&MixerCallBack,MT32_SAMPLE_RATE,"MT32");
+		chan->Enable(true);
+
+		if (threaded) {
+			wake=SDL_CreateSemaphore(0);
+			rendered=SDL_CreateSemaphore(0);
+			thread=(wake && rendered) ? SDL_CreateThread(RenderThread,this) : 0;
+			if (!thread) {
+				LOG_MSG("MT32:Can't start render thread, rendering inline");
+				threaded=false;
+			}
+		}
+		return true;
+	}
+
+	void Close(void) {
+		if (!synth) return;
+		if (thread) {
+			quit=true;
+			SDL_SemPost(wake);
+			SDL_WaitThread(thread,0);
+			thread=0;
+		}
+		if (wake) { SDL_DestroySemaphore(wake); wake=0; }
+		if (rendered) { SDL_DestroySemaphore(rendered); rendered=0; }
+		MIXER_DelChannel(chan);
+		chan=0;
+		for (;event_read!=event_write;event_read++) delete[] events[event_read&MT32_EVENT_MASK].sysex;
+
+		if (stats.frames) {
+			double rendered_ms=(double)stats.frames*1000.0/MT32_SAMPLE_RATE;
+			LOG_MSG("MT32:%s rendering took %.1f ms for %.1f ms of audio (%.2f%%), %u underruns",
+				threaded ? "Threaded" : "Inline",(double)stats.micros/1000.0,rendered_ms,
+				(double)stats.micros/10.0/rendered_ms,(unsigned int)stats.underruns);
+		}
+		if (stats.events) {
+			LOG_MSG("MT32:%u events played %.2f ms after their emulated time on average, %u late",
+				(unsigned int)stats.events,(double)stats.delay*1000.0/MT32_SAMPLE_RATE/(double)stats.events,
+				(unsigned int)stats.late);
+		}
+		synth->close();
+		delete synth;
+		synth=0;
+		active=0;
+	}
+
+	void PlayMsg(Bit8u * msg) {
+		Bitu len=MIDI_evt_len[msg[0]];
+		Bit32u packed=msg[0];
+		if (len>1) packed|=msg[1]<<8;
+		if (len>2) packed|=msg[2]<<16;
+		QueueEvent(packed,0,0);
+	}
+
+	void PlaySysex(Bit8u * sysex,Bitu len) {
+		/* The caller reuses its buffer, so the queue takes a copy */
+		Bit8u * copy=new Bit8u[len];
+		memcpy(copy,sysex,len);
+		QueueEvent(0,copy,len);
+	}
+};
+
+MidiHandler_mt32 * MidiHandler_mt32::active=0;
+
+MidiHandler_mt32 Midi_mt32;
@@ -31,6 +31,12 @@
 #include "cross.h"
 #include "hardware.h"
 #include "support.h"
+//--Added 2026-10-19 to drop frames when benchmarking headless
+#include "benchmark.h"
+//--End of modifications
+//--Added 2026-10-19 to measure where the time of each frame goes
+#include "profile.h"
+//--End of modifications
 
 #include "render_scalers.h"
 
@@ -105,6 +111,11 @@ static void RENDER_StartLineHandler(const void * s) {
 			if (GCC_UNLIKELY(src[0] != cache[0])) {
 				if (!GFX_StartUpdate(&render.scale.outWrite, &render.scale.outPitch )) {
 					RENDER_DrawLine = RENDER_EmptyLineHandler;
+					//--Added 2026-10-19: the rest of the frame won't reach the cache, so it
+					//can't be trusted to tell which lines changed; start over from scratch.
+					//(The VGA leaves out lines whose video memory hasn't been written to.)
+					render.scale.clearCache = true;
+					//--End of modifications
 					return;
 				}
 				render.scale.outWrite += render.scale.outPitch * Scaler_ChangedLines[0];
@@ -150,6 +161,10 @@ bool RENDER_StartUpdate(void) {
 		return false;
 	if (GCC_UNLIKELY(!render.active))
 		return false;
+	//--Added 2026-10-19 to count frames and drop them when benchmarking headless
+	if (GCC_UNLIKELY(!BENCHMARK_StartFrame()))
+		return false;
+	//--End of modifications
 	if (GCC_UNLIKELY(render.frameskip.count<render.frameskip.max)) {
 		render.frameskip.count++;
 		return false;
@@ -221,7 +236,13 @@ void RENDER_EndUpdate( bool abort ) {
 			flags, fps, (Bit8u *)&scalerSourceCache, (Bit8u*)&render.pal.rgb );
 	}
 	if ( render.scale.outWrite ) {
-		GFX_EndUpdate( abort? NULL : Scaler_ChangedLines );
+		//--Modified 2026-10-19 to measure where the time of each frame goes
+		//GFX_EndUpdate( abort? NULL : Scaler_ChangedLines );
+		{
+			ProfileScope scope(PROFILE_PRESENT);
+			GFX_EndUpdate( abort? NULL : Scaler_ChangedLines );
+		}
+		//--End of modifications
 		render.frameskip.hadSkip[render.frameskip.index] = 0;
 	} else {
 #if 0
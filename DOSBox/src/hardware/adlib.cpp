@@ -28,6 +28,11 @@
 #include "mapper.h"
 #include "mem.h"
 #include "dbopl.h"
+//--Added 2026-10-19 for the DRO benchmark
+#include <vector>
+#include "timer.h"
+#include "benchmark.h"
+//--End of modifications
 
 namespace OPL2 {
 	#include "opl.cpp"
@@ -449,6 +454,11 @@ void Module::PortWrite( Bitu port, Bitu val, Bitu iolen ) {
 	if ( !mixerChan->enabled ) {
 		mixerChan->Enable(true);
 	}
+	//--Added 2026-10-19 for idle channels
+	if ( mixerChan->sleeping ) {
+		handler->Resume( mixerChan->WakeUp() );
+	}
+	//--End of modifications
 	if ( port&1 ) {
 		switch ( mode ) {
 		case MODE_OPL2:
@@ -539,14 +549,77 @@ void Module::Init( Mode m ) {
 	}
 }
 
+//--Added 2026-10-19 to save and load the register state of the chips.
+//The synthesis state isn't saved: instead the registers are written back to
+//the handler, which brings every voice back with its last settings.
+void Module::SaveState( SaveStateWriter& state ) {
+	state.WriteD( mode );
+	state.WriteD( reg.normal );
+	state.WriteD( lastUsed );
+	state.WriteBytes( cache, sizeof( cache ) );
+	state.WriteBlock( chip, sizeof( chip ) );
+}
+
+bool Module::LoadState( SaveStateReader& state ) {
+	if ( state.ReadD() != (Bit32u)mode ) {
+		LOG_MSG( "SAVESTATE:OPL mode does not match" );
+		return false;
+	}
+	Bit32u normal = state.ReadD();
+	Bit32u used = state.ReadD();
+	if ( !state.ReadBytes( cache, sizeof( cache ) ) ) 
+		return false;
+	if ( !state.ReadBlock( chip, sizeof( chip ) ) )
+		return false;
+	if ( state.Checking() )
+		return true;
+	reg.normal = normal;
+	lastUsed = used;
+	//--Added 2026-10-19 for idle channels
+	if ( mixerChan->sleeping ) {
+		handler->Resume( mixerChan->WakeUp() );
+	}
+	//--End of modifications
+	//Enable opl3 mode first so the second register set can be reached
+	handler->WriteReg( 0x105, cache[ 0x105 ] );
+	for ( Bit32u i = 0; i < 512; i++ ) {
+		//Skip the timer registers, which never reach the handler
+		if ( i == 0x105 || ( i >= 0x02 && i <= 0x04 ) || ( i >= 0x102 && i <= 0x103 ) )
+			continue;
+		handler->WriteReg( i, cache[ i ] );
+	}
+	return true;
+}
+//--End of modifications
+
 }; //namespace
 
 
 
 static Adlib::Module* module = 0;
 
+//--Added 2026-10-19: the mixer also calls this while the channel sleeps
+static void OPL_IdleCheck(void) {
+	//Disable the sound generation after 30 seconds of silence
+	if ((PIC_Ticks - module->lastUsed) > 30000) {
+		Bitu i;
+		for (i=0xb0;i<0xb9;i++) if (module->cache[i]&0x20||module->cache[i+0x100]&0x20) break;
+		if (i==0xb9) module->mixerChan->Enable(false);
+		else module->lastUsed = PIC_Ticks;
+	}
+}
+//--End of modifications
+
 static void OPL_CallBack(Bitu len) {
 	module->handler->Generate( module->mixerChan, len );
+	//--Added 2026-10-19: let the mixer fill in silence until the next write
+	if ( module->handler->Idle() ) {
+		module->mixerChan->Sleep( OPL_IdleCheck );
+	}
+	//--End of modifications
+	//--Modified 2026-10-19 to share the idle check with the sleeping channel
+	OPL_IdleCheck();
+	/*
 	//Disable the sound generation after 30 seconds of silence
 	if ((PIC_Ticks - module->lastUsed) > 30000) {
 		Bitu i;
@@ -554,6 +627,8 @@ static void OPL_CallBack(Bitu len) {
 		if (i==0xb9) module->mixerChan->Enable(false);
 		else module->lastUsed = PIC_Ticks;
 	}
+	*/
+	//--End of modifications
 }
 
 static Bitu OPL_Read(Bitu port,Bitu iolen) {
@@ -706,3 +781,95 @@ void OPL_ShutDown(Section* sec){
 	module = 0;
 
 }
+
+//--Added 2026-10-19: replay a DRO capture through DBOPL as fast as possible, once with
+//the operator pipeline and once without, to time the two and check they sound the same
+static bool OPL_RenderDRO(const Bit8u * data,Bitu size,bool pipeline,Bit64u & micros,Bit32u & hash,Bitu & samples) {
+	const Bitu rate=49716;
+	Bit8u hardware=data[0x14];
+	Bit8u delay256=data[0x17];
+	Bit8u delayShift8=data[0x18];
+	Bitu tableSize=data[0x19];
+	const Bit8u * table=data+sizeof(Adlib::RawHeader);
+	const Bit8u * cmd=table+tableSize;
+	const Bit8u * end=data+size;
+	if (tableSize>127 || cmd>end) return false;
+	bool stereo=(hardware!=HW_OPL2);
+
+	DBOPL::Handler handler;
+	handler.Init(rate);
+	handler.chip.pipeline=pipeline;
+	if (stereo) handler.chip.WriteReg(0x105,1);
+
+	Bit32s buf[512*2];
+	double pending=0;
+	hash=2166136261u;
+	samples=0;
+	Bit64u start=GetMicroTicks();
+	for (;cmd+2<=end;cmd+=2) {
+		Bit8u raw=cmd[0];
+		Bit8u val=cmd[1];
+		Bitu ms;
+		if (raw==delay256) ms=val+1;
+		else if (raw==delayShift8) ms=(val+1)<<8;
+		else {
+			if ((raw&127)>=tableSize) continue;
+			Bit32u reg=table[raw&127]+((raw&128) ? 0x100 : 0);
+			handler.chip.WriteReg(reg,val);
+			continue;
+		}
+		pending+=(double)ms*rate/1000.0;
+		Bitu todo=(Bitu)pending;
+		pending-=todo;
+		samples+=todo;
+		while (todo) {
+			Bitu block=todo>512 ? 512 : todo;
+			memset(buf,0,sizeof(Bit32s)*block*(stereo ? 2 : 1));
+			if (stereo) handler.chip.GenerateBlock3(block,buf);
+			else handler.chip.GenerateBlock2(block,buf);
+			for (Bitu i=0;i<block*(stereo ? 2 : 1);i++) hash=(hash^(Bit32u)buf[i])*16777619u;
+			todo-=block;
+		}
+	}
+	micros=GetMicroTicks()-start;
+	return true;
+}
+
+bool OPL_BenchmarkDRO(const char * filename,char * report,Bitu size) {
+	FILE * f=fopen(filename,"rb");
+	if (!f) {
+		snprintf(report,size,"Can't open %s.\n",filename);
+		return false;
+	}
+	std::vector<Bit8u> data;
+	Bit8u chunk[4096];
+	size_t len;
+	while ((len=fread(chunk,1,sizeof(chunk),f))>0) data.insert(data.end(),chunk,chunk+len);
+	fclose(f);
+	if (data.size()<sizeof(Adlib::RawHeader) || memcmp(&data[0],"DBRAWOPL",8) || host_readw(&data[8])!=2 || data[0x16]!=0) {
+		snprintf(report,size,"%s is not an uncompressed version 2 DRO capture.\n",filename);
+		return false;
+	}
+	Bit64u scalar_us,pipeline_us;
+	Bit32u scalar_hash,pipeline_hash;
+	Bitu samples;
+	if (!OPL_RenderDRO(&data[0],data.size(),false,scalar_us,scalar_hash,samples) ||
+		!OPL_RenderDRO(&data[0],data.size(),true,pipeline_us,pipeline_hash,samples)) {
+		snprintf(report,size,"%s is damaged.\n",filename);
+		return false;
+	}
+	if (!scalar_us) scalar_us=1;
+	if (!pipeline_us) pipeline_us=1;
+	snprintf(report,size,
+		"DRO replay: %lu samples (%.1f s of music)\n"
+		"  one sample at a time: %8.1f ms, %6.1fx realtime\n"
+		"  operator pipeline:    %8.1f ms, %6.1fx realtime\n"
+		"  speedup %.2fx, output %s\n",
+		(unsigned long)samples,samples/49716.0,
+		scalar_us/1000.0,samples*1000000.0/49716.0/scalar_us,
+		pipeline_us/1000.0,samples*1000000.0/49716.0/pipeline_us,
+		(double)scalar_us/pipeline_us,
+		scalar_hash==pipeline_hash ? "identical" : "DIFFERENT");
+	return scalar_hash==pipeline_hash;
+}
+//--End of modifications
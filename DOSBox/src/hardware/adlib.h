@@ -27,6 +27,9 @@
 #include "setup.h"
 #include "pic.h"
 #include "hardware.h"
+//--Added 2026-10-19 to save and load the register state of the chips
+#include "savestate.h"
+//--End of modifications
 
 
 namespace Adlib {
@@ -104,6 +107,15 @@ public:
 	virtual void Generate( MixerChannel* chan, Bitu samples ) = 0;
 	//Initialize at a specific sample rate and mode
 	virtual void Init( Bitu rate ) = 0;
+	//--Added 2026-10-19 for idle channels
+	//Whether the chip will only produce silence until it's next written to
+	virtual bool Idle() {
+		return false;
+	}
+	//Catch up after the mixer has filled in this many samples of silence
+	virtual void Resume( Bitu /*samples*/ ) {
+	}
+	//--End of modifications
 	virtual ~Handler() {
 	}
 };
@@ -145,6 +157,12 @@ public:
 
 	Module( Section* configuration); 
 	~Module();
+
+	//--Added 2026-10-19 to save and load the register state of the chips
+	const char * GetStateName( void ) { return "ADLIB"; }
+	void SaveState( SaveStateWriter& state );
+	bool LoadState( SaveStateReader& state );
+	//--End of modifications
 };
 
 
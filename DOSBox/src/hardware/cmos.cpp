@@ -28,6 +28,10 @@
 #include "mem.h"
 #include "bios_disk.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the CMOS state, and to replay recordings
+#include "savestate.h"
+#include "replay.h"
+//--End of modifications
 #include "cross.h" //fmod on certain platforms
 
 static struct {
@@ -134,7 +138,10 @@ static Bitu cmos_readreg(Bitu port,Bitu iolen) {
 	time_t curtime;
 	struct tm *loctime;
 	/* Get the current time. */
-	curtime = time (NULL);
+	//--Modified 2026-10-19 so that recordings see the same time when replayed
+	//curtime = time (NULL);
+	curtime = REPLAY_HostTime();
+	//--End of modifications
 
 	/* Convert it to local time representation. */
 	loctime = localtime (&curtime);
@@ -316,7 +323,19 @@ public:
 		cmos.regs[0x18]=(Bit8u)(exsize >> 8);
 		cmos.regs[0x30]=(Bit8u)exsize;
 		cmos.regs[0x31]=(Bit8u)(exsize >> 8);
+		//--Added 2026-10-19 to save and load the CMOS registers and RTC state
+		PIC_AddStateEvent(cmos_timerevent);
+		//--End of modifications
 	}
+	//--Added 2026-10-19 to save and load the CMOS registers and RTC state
+	const char * GetStateName(void) { return "CMOS"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(&cmos,sizeof(cmos));
+	}
+	bool LoadState(SaveStateReader & state) {
+		return state.ReadBlock(&cmos,sizeof(cmos));
+	}
+	//--End of modifications
 };
 
 static CMOS* test;
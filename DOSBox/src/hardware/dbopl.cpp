@@ -40,6 +40,14 @@
 #include <string.h>
 #include "dosbox.h"
 #include "dbopl.h"
+//--Added 2026-10-19 for the operator pipeline
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+//--End of modifications
+//--Added 2026-10-19 for timestamped register writes
+#include "pic.h"
+//--End of modifications
 
 
 #ifndef PI
@@ -600,6 +608,71 @@ Bits INLINE Operator::GetSample( Bits modulation ) {
 	}
 }
 
+//--Added 2026-10-19 for the operator pipeline
+//Samples each operator works through at a time
+#define PIPELINE_BLOCK 64
+
+void Operator::GetBlock( Bitu samples, const Bit32s* modulation, Bit32s* output ) {
+	Bit32s vol[ PIPELINE_BLOCK ];
+	//The envelope can change state on any sample, so it still steps one at a time
+	for ( Bitu i = 0; i < samples; i++ ) {
+		vol[ i ] = (Bit32s)ForwardVolume();
+	}
+	//Silent or not, every sample moves the wave on by waveCurrent
+	Bit32u index = waveIndex;
+	Bitu i = 0;
+#if defined(__SSE2__) && ( DBOPL_WAVE == WAVE_TABLEMUL )
+	const __m128i mask = _mm_set1_epi32( (int)waveMask );
+	const __m128i step = _mm_set1_epi32( (int)( waveCurrent * 4 ) );
+	__m128i counter = _mm_setr_epi32( (int)( index + waveCurrent ), (int)( index + waveCurrent * 2 ),
+		(int)( index + waveCurrent * 3 ), (int)( index + waveCurrent * 4 ) );
+	for ( ; i + 8 <= samples; i += 8 ) {
+		//Table positions for 8 samples, as ForwardWave plus the modulation
+		__m128i pos0 = _mm_srli_epi32( counter, WAVE_SH );
+		counter = _mm_add_epi32( counter, step );
+		__m128i pos1 = _mm_srli_epi32( counter, WAVE_SH );
+		counter = _mm_add_epi32( counter, step );
+		if ( modulation ) {
+			pos0 = _mm_add_epi32( pos0, _mm_loadu_si128( (const __m128i*)( modulation + i ) ) );
+			pos1 = _mm_add_epi32( pos1, _mm_loadu_si128( (const __m128i*)( modulation + i + 4 ) ) );
+		}
+		Bit32u pos[ 8 ];
+		_mm_storeu_si128( (__m128i*)pos, _mm_and_si128( pos0, mask ) );
+		_mm_storeu_si128( (__m128i*)( pos + 4 ), _mm_and_si128( pos1, mask ) );
+		//SSE2 has no gather, so the table lookups are done one by one. Silent samples use
+		//a multiplier of 0, which is what makes them come out as 0 like in GetSample.
+		Bit16u mul[ 8 ];
+		Bit16s wave[ 8 ];
+		for ( Bitu j = 0; j < 8; j++ ) {
+			wave[ j ] = waveBase[ pos[ j ] ];
+			mul[ j ] = ENV_SILENT( vol[ i + j ] ) ? 0 : MulTable[ vol[ i + j ] >> ENV_EXTRA ];
+		}
+		__m128i w = _mm_loadu_si128( (const __m128i*)wave );
+		__m128i m = _mm_loadu_si128( (const __m128i*)mul );
+		//(wave * mul) >> MUL_SH is the top half of a signed by unsigned 16 bit multiply:
+		//mulhi treats mul as signed, which is 65536 too little whenever its top bit is set
+		__m128i result = _mm_add_epi16( _mm_mulhi_epi16( w, m ), _mm_and_si128( w, _mm_srai_epi16( m, 15 ) ) );
+		//Sign extend back out to 32 bits
+		_mm_storeu_si128( (__m128i*)( output + i ), _mm_srai_epi32( _mm_unpacklo_epi16( result, result ), 16 ) );
+		_mm_storeu_si128( (__m128i*)( output + i + 4 ), _mm_srai_epi32( _mm_unpackhi_epi16( result, result ), 16 ) );
+	}
+	index += (Bit32u)i * waveCurrent;
+#endif
+	for ( ; i < samples; i++ ) {
+		index += waveCurrent;
+		if ( ENV_SILENT( vol[ i ] ) ) {
+			output[ i ] = 0;
+		} else {
+			Bitu pos = index >> WAVE_SH;
+			if ( modulation )
+				pos += modulation[ i ];
+			output[ i ] = (Bit32s)GetWave( pos, vol[ i ] );
+		}
+	}
+	waveIndex = index;
+}
+//--End of modifications
+
 Operator::Operator() {
 	chanData = 0;
 	freqMul = 0;
@@ -899,6 +972,10 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
+	//--Added 2026-10-19 to generate the melodic modes through the operator pipeline
+	if ( mode < sm2Percussion && chip->pipeline )
+		return PipelineTemplate< mode >( chip, samples, output );
+	//--End of modifications
 	for ( Bitu i = 0; i < samples; i++ ) {
 		//Early out for percussion handlers
 		if ( mode == sm2Percussion ) {
@@ -975,6 +1052,99 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 	return 0;
 }
 
+//--Added 2026-10-19 for the operator pipeline
+template<SynthMode mode>
+Channel* Channel::PipelineTemplate( Chip* /*chip*/, Bit32u samples, Bit32s* output ) {
+	Bit32s out0[ PIPELINE_BLOCK ];
+	Bit32s first[ PIPELINE_BLOCK ];
+	Bit32s second[ PIPELINE_BLOCK ];
+	while ( samples > 0 ) {
+		Bitu todo = samples > PIPELINE_BLOCK ? PIPELINE_BLOCK : samples;
+		//The first operator feeds back into itself, so that one still goes sample by sample
+		for ( Bitu i = 0; i < todo; i++ ) {
+			Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
+			old[0] = old[1];
+			old[1] = Op(0)->GetSample( mod );
+			out0[ i ] = old[0];
+		}
+		//The others only depend on the operator before them on the same sample,
+		//so each can work through the whole block before the next one starts
+		switch ( mode ) {
+		case sm2AM:
+		case sm3AM:
+			Op(1)->GetBlock( todo, 0, first );
+			for ( Bitu i = 0; i < todo; i++ )
+				first[ i ] += out0[ i ];
+			break;
+		case sm2FM:
+		case sm3FM:
+			Op(1)->GetBlock( todo, out0, first );
+			break;
+		case sm3FMFM:
+			Op(1)->GetBlock( todo, out0, first );
+			Op(2)->GetBlock( todo, first, second );
+			Op(3)->GetBlock( todo, second, first );
+			break;
+		case sm3AMFM:
+			Op(1)->GetBlock( todo, 0, first );
+			Op(2)->GetBlock( todo, first, second );
+			Op(3)->GetBlock( todo, second, first );
+			for ( Bitu i = 0; i < todo; i++ )
+				first[ i ] += out0[ i ];
+			break;
+		case sm3FMAM:
+			Op(1)->GetBlock( todo, out0, first );
+			Op(2)->GetBlock( todo, 0, second );
+			Op(3)->GetBlock( todo, second, second );
+			for ( Bitu i = 0; i < todo; i++ )
+				first[ i ] += second[ i ];
+			break;
+		case sm3AMAM:
+			Op(1)->GetBlock( todo, 0, first );
+			Op(2)->GetBlock( todo, first, first );
+			Op(3)->GetBlock( todo, 0, second );
+			for ( Bitu i = 0; i < todo; i++ )
+				first[ i ] += out0[ i ] + second[ i ];
+			break;
+		default:
+			break;
+		}
+		switch( mode ) {
+		case sm2AM:
+		case sm2FM:
+			for ( Bitu i = 0; i < todo; i++ )
+				output[ i ] += first[ i ];
+			output += todo;
+			break;
+		case sm3AM:
+		case sm3FM:
+		case sm3FMFM:
+		case sm3AMFM:
+		case sm3FMAM:
+		case sm3AMAM:
+			for ( Bitu i = 0; i < todo; i++ ) {
+				output[ i * 2 + 0 ] += first[ i ] & maskLeft;
+				output[ i * 2 + 1 ] += first[ i ] & maskRight;
+			}
+			output += todo * 2;
+			break;
+		default:
+			break;
+		}
+		samples -= (Bit32u)todo;
+	}
+	switch( mode ) {
+	case sm3FMFM:
+	case sm3AMFM:
+	case sm3FMAM:
+	case sm3AMAM:
+		return( this + 2 );
+	default:
+		return ( this + 1 );
+	}
+}
+//--End of modifications
+
 /*
 	Chip
 */
@@ -985,6 +1155,13 @@ Chip::Chip() {
 	regBD = 0;
 	reg104 = 0;
 	opl3Active = 0;
+	//--Added 2026-10-19 for the operator pipeline
+	pipeline = true;
+	//--End of modifications
+	//--Added 2026-10-19 for timestamped register writes
+	writeCount = 0;
+	writeDone = 0;
+	//--End of modifications
 }
 
 INLINE Bit32u Chip::ForwardNoise() {
@@ -1180,9 +1357,51 @@ Bit32u Chip::WriteAddr( Bit32u port, Bit8u val ) {
 	return 0;
 }
 
+//--Added 2026-10-19 for timestamped register writes
+void Chip::QueueWrite( Bit32u sample, Bit32u reg, Bit8u val ) {
+	//Out of room: play what's queued now rather than reorder anything
+	if ( writeCount == WRITE_QUEUE_SIZE )
+		FlushWrites();
+	//Keep them in order even if the clock got adjusted in between
+	if ( writeCount > writeDone && sample < writeQueue[ writeCount - 1 ].sample )
+		sample = writeQueue[ writeCount - 1 ].sample;
+	QueuedWrite& write = writeQueue[ writeCount++ ];
+	write.sample = sample;
+	write.reg = reg;
+	write.val = val;
+}
+
+void Chip::PlayWrites( Bitu sample ) {
+	while ( writeDone < writeCount && writeQueue[ writeDone ].sample <= sample ) {
+		WriteReg( writeQueue[ writeDone ].reg, writeQueue[ writeDone ].val );
+		writeDone++;
+	}
+	if ( writeDone == writeCount ) {
+		writeCount = 0;
+		writeDone = 0;
+	}
+}
+
+void Chip::FlushWrites() {
+	PlayWrites( ~(Bitu)0 );
+}
+//--End of modifications
+
 void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
+	//--Modified 2026-10-19 to play queued register writes at their sample, instead of all at the start
+	/*
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
+	*/
+	Bitu done = 0;
+	while ( total > 0 ) {
+		PlayWrites( done );
+		Bitu todo = total;
+		if ( writeDone < writeCount && writeQueue[ writeDone ].sample - done < todo )
+			todo = writeQueue[ writeDone ].sample - done;
+		Bit32u samples = ForwardLFO( (Bit32u)todo );
+		done += samples;
+	//--End of modifications
 		memset(output, 0, sizeof(Bit32s) * samples);
 		int count = 0;
 		for( Channel* ch = chan; ch < chan + 9; ) {
@@ -1192,11 +1411,26 @@ void Chip::GenerateBlock2( Bitu total, Bit32s* output ) {
 		total -= samples;
 		output += samples;
 	}
+	//--Added 2026-10-19: writes timed past the end of the block still happened before now
+	FlushWrites();
+	//--End of modifications
 }
 
 void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
+	//--Modified 2026-10-19 to play queued register writes at their sample, instead of all at the start
+	/*
 	while ( total > 0 ) {
 		Bit32u samples = ForwardLFO( total );
+	*/
+	Bitu done = 0;
+	while ( total > 0 ) {
+		PlayWrites( done );
+		Bitu todo = total;
+		if ( writeDone < writeCount && writeQueue[ writeDone ].sample - done < todo )
+			todo = writeQueue[ writeDone ].sample - done;
+		Bit32u samples = ForwardLFO( (Bit32u)todo );
+		done += samples;
+	//--End of modifications
 		memset(output, 0, sizeof(Bit32s) * samples *2);
 		int count = 0;
 		for( Channel* ch = chan; ch < chan + 18; ) {
@@ -1206,7 +1440,40 @@ void Chip::GenerateBlock3( Bitu total, Bit32s* output  ) {
 		total -= samples;
 		output += samples * 2;
 	}
+	//--Added 2026-10-19: writes timed past the end of the block still happened before now
+	FlushWrites();
+	//--End of modifications
+}
+
+//--Added 2026-10-19 for idle channels
+bool Chip::Idle() const {
+	if ( writeDone < writeCount )
+		return false;
+	for ( const Channel* ch = chan; ch < chan + 18; ch++ ) {
+		if ( !ch->op[0].Silent() || !ch->op[1].Silent() )
+			return false;
+	}
+	return true;
+}
+
+void Chip::Skip( Bitu samples ) {
+	//Silent operators still run through their waves, just without vibrato
+	for ( Channel* ch = chan; ch < chan + 18; ch++ ) {
+		ch->old[0] = ch->old[1] = 0;
+		ch->op[0].waveIndex += ch->op[0].waveAdd * (Bit32u)samples;
+		ch->op[1].waveIndex += ch->op[1].waveAdd * (Bit32u)samples;
+	}
+	//The percussion channels step the noise generator once a sample, silent or not
+	if ( regBD & 0x20 ) {
+		for ( Bitu i = 0; i < samples; i++ )
+			ForwardNoise();
+	}
+	while ( samples > 0 ) {
+		Bit32u todo = samples > 0x10000 ? 0x10000 : (Bit32u)samples;
+		samples -= ForwardLFO( todo );
+	}
 }
+//--End of modifications
 
 void Chip::Setup( Bit32u rate ) {
 	double original = OPLRATE;
@@ -1493,13 +1760,28 @@ Bit32u Handler::WriteAddr( Bit32u port, Bit8u val ) {
 
 }
 void Handler::WriteReg( Bit32u addr, Bit8u val ) {
-	chip.WriteReg( addr, val );
+	//--Modified 2026-10-19 to queue writes for the sample they were made on,
+	//so that several writes within one millisecond don't all land at once
+	//chip.WriteReg( addr, val );
+	if ( addr == 0x105 ) {
+		//Switching between OPL2 and OPL3 changes the kind of block generated, so do it right away
+		chip.FlushWrites();
+		chip.WriteReg( addr, val );
+		return;
+	}
+	double since = PIC_FullIndex() - lastGenerate;
+	Bit32u sample = since > 0 ? (Bit32u)( since * rate / 1000.0 ) : 0;
+	chip.QueueWrite( sample, addr, val );
+	//--End of modifications
 }
 
 void Handler::Generate( MixerChannel* chan, Bitu samples ) {
 	Bit32s buffer[ 512 * 2 ];
 	if ( GCC_UNLIKELY(samples > 512) )
 		samples = 512;
+	//--Added 2026-10-19 for timestamped register writes: the block ends now
+	lastGenerate = PIC_FullIndex();
+	//--End of modifications
 	if ( !chip.opl3Active ) {
 		chip.GenerateBlock2( samples, buffer );
 		chan->AddSamples_m32( samples, buffer );
@@ -1509,9 +1791,25 @@ void Handler::Generate( MixerChannel* chan, Bitu samples ) {
 	}
 }
 
+//--Added 2026-10-19 for idle channels
+bool Handler::Idle() {
+	return chip.Idle();
+}
+
+void Handler::Resume( Bitu samples ) {
+	chip.Skip( samples );
+	//The silence the mixer filled in ends now
+	lastGenerate = PIC_FullIndex();
+}
+//--End of modifications
+
 void Handler::Init( Bitu rate ) {
 	InitTables();
 	chip.Setup( rate );
+	//--Added 2026-10-19 for timestamped register writes
+	this->rate = rate;
+	lastGenerate = PIC_FullIndex();
+	//--End of modifications
 }
 
 
@@ -151,6 +151,10 @@ public:
 
 	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+	//--Added 2026-10-19 for the operator pipeline
+	//GetSample for a whole block at once; modulation may be 0 for none
+	void GetBlock( Bitu samples, const Bit32s* modulation, Bit32s* output );
+	//--End of modifications
 public:
 	Operator();
 };
@@ -188,6 +192,10 @@ struct Channel {
 	//Generate blocks of data in specific modes
 	template<SynthMode mode>
 	Channel* BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output );
+	//--Added 2026-10-19: BlockTemplate one operator at a time instead of one sample at a time
+	template<SynthMode mode>
+	Channel* PipelineTemplate( Chip* chip, Bit32u samples, Bit32s* output );
+	//--End of modifications
 	Channel();
 };
 
@@ -226,6 +234,28 @@ struct Chip {
 	Bit8u waveFormMask;
 	//0 or -1 when enabled
 	Bit8s opl3Active;
+	//--Added 2026-10-19: generate melodic channels through the operator pipeline,
+	//which gives the same output; only turned off to benchmark against it
+	bool pipeline;
+	//--End of modifications
+
+	//--Added 2026-10-19 to play register writes at the sample they were made on
+	//Writes waiting for the next generated block, in order, each with the sample
+	//offset into that block it should take effect at
+	struct QueuedWrite {
+		Bit32u sample;
+		Bit32u reg;
+		Bit8u val;
+	};
+	enum { WRITE_QUEUE_SIZE = 1024 };
+	QueuedWrite writeQueue[ WRITE_QUEUE_SIZE ];
+	Bitu writeCount;
+	Bitu writeDone;
+	void QueueWrite( Bit32u sample, Bit32u reg, Bit8u val );
+	//Play every queued write up to the given sample offset, or all of them
+	void PlayWrites( Bitu sample );
+	void FlushWrites();
+	//--End of modifications
 
 	//Return the maximum amount of samples before and LFO change
 	Bit32u ForwardLFO( Bit32u samples );
@@ -238,6 +268,12 @@ struct Chip {
 
 	void GenerateBlock2( Bitu samples, Bit32s* output );
 	void GenerateBlock3( Bitu samples, Bit32s* output );
+	//--Added 2026-10-19 for idle channels
+	//Every operator is silent and will stay that way until a register changes
+	bool Idle() const;
+	//Move the waves and LFO on as if this many silent samples had been generated
+	void Skip( Bitu samples );
+	//--End of modifications
 
 	void Generate( Bit32u samples );
 	void Setup( Bit32u r );
@@ -247,10 +283,19 @@ struct Chip {
 
 struct Handler : public Adlib::Handler {
 	DBOPL::Chip chip;
+	//--Added 2026-10-19 for timestamped register writes
+	Bitu rate;
+	//Emulated time the last generated block ended at
+	double lastGenerate;
+	//--End of modifications
 	virtual Bit32u WriteAddr( Bit32u port, Bit8u val );
 	virtual void WriteReg( Bit32u addr, Bit8u val );
 	virtual void Generate( MixerChannel* chan, Bitu samples );
 	virtual void Init( Bitu rate );
+	//--Added 2026-10-19 for idle channels
+	virtual bool Idle();
+	virtual void Resume( Bitu samples );
+	//--End of modifications
 };
 
 
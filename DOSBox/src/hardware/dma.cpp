@@ -26,6 +26,9 @@
 #include "pic.h"
 #include "paging.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the DMA controllers
+#include "savestate.h"
+//--End of modifications
 
 DmaController *DmaControllers[2];
 
@@ -279,6 +282,62 @@ DmaChannel::DmaChannel(Bit8u num, bool dma16) {
 	request = false;
 }
 
+//--Added 2026-10-19 to save and load controller state.
+//Channel callbacks belong to the devices using them and are left in place.
+void DmaController::SaveState(SaveStateWriter & state) {
+	state.WriteBool(flipflop);
+	for (Bitu i=0;i<4;i++) {
+		DmaChannel * chan=DmaChannels[i];
+		state.WriteD(chan->pagebase);
+		state.WriteW(chan->baseaddr);
+		state.WriteD(chan->curraddr);
+		state.WriteW(chan->basecnt);
+		state.WriteW(chan->currcnt);
+		state.WriteB(chan->pagenum);
+		state.WriteBool(chan->increment);
+		state.WriteBool(chan->autoinit);
+		state.WriteB(chan->trantype);
+		state.WriteBool(chan->masked);
+		state.WriteBool(chan->tcount);
+		state.WriteBool(chan->request);
+	}
+}
+
+bool DmaController::LoadState(SaveStateReader & state) {
+	bool ff=state.ReadBool();
+	if (!state.Checking()) flipflop=ff;
+	for (Bitu i=0;i<4;i++) {
+		Bit32u pagebase=state.ReadD();
+		Bit16u baseaddr=state.ReadW();
+		Bit32u curraddr=state.ReadD();
+		Bit16u basecnt=state.ReadW();
+		Bit16u currcnt=state.ReadW();
+		Bit8u pagenum=state.ReadB();
+		bool increment=state.ReadBool();
+		bool autoinit=state.ReadBool();
+		Bit8u trantype=state.ReadB();
+		bool masked=state.ReadBool();
+		bool tcount=state.ReadBool();
+		bool request=state.ReadBool();
+		if (state.Checking()) continue;
+		DmaChannel * chan=DmaChannels[i];
+		chan->pagebase=pagebase;
+		chan->baseaddr=baseaddr;
+		chan->curraddr=curraddr;
+		chan->basecnt=basecnt;
+		chan->currcnt=currcnt;
+		chan->pagenum=pagenum;
+		chan->increment=increment;
+		chan->autoinit=autoinit;
+		chan->trantype=trantype;
+		chan->masked=masked;
+		chan->tcount=tcount;
+		chan->request=request;
+	}
+	return !state.Failed();
+}
+//--End of modifications
+
 Bitu DmaChannel::Read(Bitu want, Bit8u * buffer) {
 	Bitu done=0;
 	curraddr &= dma_wrapping;
@@ -373,6 +432,23 @@ public:
 			DmaControllers[1]->DMA_ReadHandler[0x10].Install(0x89,DMA_Read_Port,IO_MB,3);
 		}
 	}
+	//--Added 2026-10-19 to save and load the DMA controllers
+	const char * GetStateName(void) { return "DMA"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteD(dma_wrapping);
+		state.WriteBlock(ems_board_mapping,sizeof(ems_board_mapping));
+		state.WriteBool(DmaControllers[1]!=NULL);
+		for (Bitu i=0;i<2;i++) if (DmaControllers[i]) DmaControllers[i]->SaveState(state);
+	}
+	bool LoadState(SaveStateReader & state) {
+		Bit32u wrapping=state.ReadD();
+		if (!state.Checking()) dma_wrapping=wrapping;
+		state.ReadBlock(ems_board_mapping,sizeof(ems_board_mapping));
+		if (state.ReadBool()!=(DmaControllers[1]!=NULL)) return false;
+		for (Bitu i=0;i<2;i++) if (DmaControllers[i] && !DmaControllers[i]->LoadState(state)) return false;
+		return !state.Failed();
+	}
+	//--End of modifications
 	~DMA(){
 		if (DmaControllers[0]) {
 			delete DmaControllers[0];
@@ -378,6 +378,9 @@ static void saa1099_write_port_w( int chip, int offset, int data )
 
 static void write_cms(Bitu port, Bitu val, Bitu /* iolen */) {
 	if(cms_chan && (!cms_chan->enabled)) cms_chan->Enable(true);
+	//--Added 2026-10-19 for idle channels
+	if(cms_chan) cms_chan->WakeUp();
+	//--End of modifications
 	last_command = PIC_Ticks;
 	switch (port-base_port) {
 	case 0:
@@ -395,6 +398,12 @@ static void write_cms(Bitu port, Bitu val, Bitu /* iolen */) {
 	}
 }
 
+//--Added 2026-10-19: the mixer also calls this while the channel sleeps
+static void CMS_IdleCheck(void) {
+	if (last_command + 10000 < PIC_Ticks) if(cms_chan) cms_chan->Enable(false);
+}
+//--End of modifications
+
 static void CMS_CallBack(Bitu len) {
 	if (len > CMS_BUFFER_SIZE) return;
 
@@ -419,7 +428,13 @@ static void CMS_CallBack(Bitu len) {
 		stream++;
 	}
 	if(cms_chan) cms_chan->AddSamples_s16(len,(Bit16s *)MixTemp);
-	if (last_command + 10000 < PIC_Ticks) if(cms_chan) cms_chan->Enable(false);
+	//--Modified 2026-10-19 to share the idle check with the sleeping channel
+	CMS_IdleCheck();
+	//if (last_command + 10000 < PIC_Ticks) if(cms_chan) cms_chan->Enable(false);
+	//--End of modifications
+	//--Added 2026-10-19: both chips stay silent until they're written to again
+	if (cms_chan && !saa1099[0].all_ch_enable && !saa1099[1].all_ch_enable) cms_chan->Sleep(CMS_IdleCheck);
+	//--End of modifications
 }
 
 // The Gameblaster detection
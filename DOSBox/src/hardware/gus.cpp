@@ -30,6 +30,15 @@
 #include "shell.h"
 #include "math.h"
 #include "regs.h"
+//--Added 2026-10-19 for the batched voice renderer
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <stdio.h>
+#include <vector>
+#include "timer.h"
+#include "benchmark.h"
+//--End of modifications
 using namespace std;
 
 //Extra bits of precision over normal gus
@@ -138,6 +147,61 @@ static INLINE Bit32s GetSample(Bit32u Delta, Bit32u CurAddr, bool eightbit) {
 	}
 }
 
+//--Added 2026-10-19 for the batched voice renderer
+//Most samples a voice renders in one go
+#define GUS_SPAN 64
+
+//GetSample for count positions step apart, split into the first sample of each pair,
+//the difference to the second and the fraction between them
+template<bool eightbit,bool interpolate>
+static void FetchSpan(Bit32u addr,Bit32u step,Bitu count,Bit32s * w1,Bit32s * diff,Bit32s * frac) {
+	for (Bitu i=0;i<count;i++,addr+=step) {
+		Bit32u useAddr = addr >> WAVE_FRACT;
+		if (!eightbit) useAddr = (useAddr & 0xc0000L) | ((useAddr & 0x1ffffL) << 1);
+		if (eightbit) w1[i] = ((Bit8s)GUSRam[useAddr+0]) << 8;
+		else w1[i] = (GUSRam[useAddr+0] | (((Bit8s)GUSRam[useAddr+1]) << 8));
+		if (interpolate) {
+			if (eightbit) diff[i] = (((Bit8s)GUSRam[useAddr+1]) << 8) - w1[i];
+			else diff[i] = (GUSRam[useAddr+2] | (((Bit8s)GUSRam[useAddr+3]) << 8)) - w1[i];
+			frac[i] = (Bit32s)(addr & WAVE_FRACT_MASK);
+		} else {
+			diff[i] = 0;
+			frac[i] = 0;
+		}
+	}
+}
+
+#if defined(__SSE2__)
+//SSE2 has no 32 bit multiply that keeps the low half, so put one together from two 32x32->64 multiplies
+static INLINE __m128i MulLo32(__m128i a,__m128i b) {
+	__m128i even = _mm_mul_epu32(a,b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a,4),_mm_srli_si128(b,4));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even,_MM_SHUFFLE(0,0,2,0)),_mm_shuffle_epi32(odd,_MM_SHUFFLE(0,0,2,0)));
+}
+#endif
+
+//Interpolate a fetched span and add it into the stereo stream at the given volumes
+static void MixSpan(Bit32s * stream,Bitu count,const Bit32s * w1,const Bit32s * diff,const Bit32s * frac,const Bit32s * left,const Bit32s * right) {
+	Bitu i=0;
+#if defined(__SSE2__)
+	for (;i+4<=count;i+=4) {
+		__m128i sample = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(w1+i)),
+			_mm_srai_epi32(MulLo32(_mm_loadu_si128((const __m128i *)(diff+i)),_mm_loadu_si128((const __m128i *)(frac+i))),WAVE_FRACT));
+		__m128i l = MulLo32(sample,_mm_loadu_si128((const __m128i *)(left+i)));
+		__m128i r = MulLo32(sample,_mm_loadu_si128((const __m128i *)(right+i)));
+		__m128i * out = (__m128i *)(stream+i*2);
+		_mm_storeu_si128(out,_mm_add_epi32(_mm_loadu_si128(out),_mm_unpacklo_epi32(l,r)));
+		_mm_storeu_si128(out+1,_mm_add_epi32(_mm_loadu_si128(out+1),_mm_unpackhi_epi32(l,r)));
+	}
+#endif
+	for (;i<count;i++) {
+		Bit32s sample = w1[i]+((diff[i]*frac[i])>>WAVE_FRACT);
+		stream[i<<1]+= sample * left[i];
+		stream[(i<<1)+1]+= sample * right[i];
+	}
+}
+//--End of modifications
+
 class GUSChannels {
 public:
 	Bit32u WaveStart;
@@ -300,6 +364,89 @@ public:
 		}
 		UpdateVolumes();
 	}
+	//--Added 2026-10-19 for idle channels: generateSamples adds nothing for these
+	bool Stopped(void) const {
+		return (RampCtrl & WaveCtrl & 3)!=0;
+	}
+	//--End of modifications
+	//--Added 2026-10-19: generateSamples in spans that can't reach a wave or ramp boundary.
+	//Every position and volume in a span is known before it starts, so the samples
+	//are worked out together instead of one update at a time.
+
+	//Updates that keep a distance below 0 when add is taken off it each time
+	static INLINE Bit32u SafeUpdates(Bit32s left,Bit32u add) {
+		if (left>=0) return 0;
+		if (!add) return 0xffffffff;
+		return ((Bit32u)(-(left+1)))/add;
+	}
+	Bit32u WaveSpan(void) const {
+		if (WaveCtrl & 0x3) return 0xffffffff;
+		if (WaveCtrl & 0x40) return SafeUpdates((Bit32s)(WaveStart-WaveAddr),WaveAdd);
+		return SafeUpdates((Bit32s)(WaveAddr-WaveEnd),WaveAdd);
+	}
+	Bit32u RampSpan(void) const {
+		if (RampCtrl & 0x3) return 0xffffffff;
+		if (RampCtrl & 0x40) return SafeUpdates((Bit32s)(RampStart-RampVol),RampAdd);
+		return SafeUpdates((Bit32s)(RampVol-RampEnd),RampAdd);
+	}
+	void renderSamples(Bit32s * stream,Bit32u len) {
+		if (RampCtrl & WaveCtrl & 3) return;
+		bool eightbit = ((WaveCtrl & 0x4) == 0);
+		bool interpolate = (WaveAdd < (1 << WAVE_FRACT));
+		Bit32s w1[GUS_SPAN],diff[GUS_SPAN],frac[GUS_SPAN];
+		Bit32s left[GUS_SPAN],right[GUS_SPAN];
+		while (len) {
+			Bit32u span=WaveSpan();
+			Bit32u rampspan=RampSpan();
+			if (rampspan<span) span=rampspan;
+			if (span>len) span=len;
+			if (span>GUS_SPAN) span=GUS_SPAN;
+			if (!span) {
+				//The update after this sample reaches a boundary, so it goes the old way
+				Bit32s tmpsamp = GetSample(WaveAdd, WaveAddr, eightbit);
+				stream[0]+= tmpsamp * VolLeft;
+				stream[1]+= tmpsamp * VolRight;
+				WaveUpdate();
+				RampUpdate();
+				stream+=2;
+				len--;
+				continue;
+			}
+			Bit32u wavestep=0;
+			if (!(WaveCtrl & 0x3)) wavestep=(WaveCtrl & 0x40) ? (0-WaveAdd) : WaveAdd;
+			if (eightbit) {
+				if (interpolate) FetchSpan<true,true>(WaveAddr,wavestep,span,w1,diff,frac);
+				else FetchSpan<true,false>(WaveAddr,wavestep,span,w1,diff,frac);
+			} else {
+				if (interpolate) FetchSpan<false,true>(WaveAddr,wavestep,span,w1,diff,frac);
+				else FetchSpan<false,false>(WaveAddr,wavestep,span,w1,diff,frac);
+			}
+			WaveAddr+=wavestep*span;
+			//Each sample is played at the volume left by the update before it
+			left[0]=VolLeft;
+			right[0]=VolRight;
+			if (!(RampCtrl & 0x3)) {
+				Bit32u rampstep=(RampCtrl & 0x40) ? (0-RampAdd) : RampAdd;
+				for (Bit32u i=1;i<span;i++) {
+					RampVol+=rampstep;
+					UpdateVolumes();
+					left[i]=VolLeft;
+					right[i]=VolRight;
+				}
+				RampVol+=rampstep;
+				UpdateVolumes();
+			} else {
+				for (Bit32u i=1;i<span;i++) {
+					left[i]=VolLeft;
+					right[i]=VolRight;
+				}
+			}
+			MixSpan(stream,span,w1,diff,frac,left,right);
+			stream+=span*2;
+			len-=span;
+		}
+	}
+	//--End of modifications
 	void generateSamples(Bit32s * stream,Bit32u len) {
 		int i;
 		Bit32s tmpsamp;
@@ -322,6 +469,35 @@ public:
 static GUSChannels *guschan[32];
 static GUSChannels *curchan;
 
+//--Added 2026-10-19 for the GUS benchmark: a trace starts with the state of the
+//card and its memory, followed by everything that changed the voices from then on
+static bool gus_batched = true;
+static FILE * gus_trace = 0;
+
+enum {
+	GUSTRACE_GENERATE='G',	//Bit32u samples mixed
+	GUSTRACE_WRITE='W',		//Bit8u voice, Bit8u register, Bit16u data
+	GUSTRACE_IRQACK='A',	//General channel IRQ status read
+	GUSTRACE_RAM='M'		//Bit32u address, Bit32u length, data
+};
+
+static void GUS_TraceRecord(Bit8u type,const void * data,Bitu len) {
+	fputc(type,gus_trace);
+	if (len) fwrite(data,1,len,gus_trace);
+}
+
+static void GUS_TraceRam(Bitu addr,Bitu len) {
+	if (!gus_trace || !len) return;
+	if (addr>=sizeof(GUSRam)) return;
+	if (len>sizeof(GUSRam)-addr) len=sizeof(GUSRam)-addr;
+	Bit8u header[8];
+	host_writed(&header[0],(Bit32u)addr);
+	host_writed(&header[4],(Bit32u)len);
+	GUS_TraceRecord(GUSTRACE_RAM,header,sizeof(header));
+	fwrite(&GUSRam[addr],1,len,gus_trace);
+}
+//--End of modifications
+
 static void GUSReset(void) {
 	if((myGUS.gRegData & 0x1) == 0x1) {
 		// Reset
@@ -430,6 +606,9 @@ static Bit16u ExecuteReadRegister(void) {
 		myGUS.RampIRQ&=~mask;
 		myGUS.WaveIRQ&=~mask;
 		CheckVoiceIrq();
+		//--Added 2026-10-19 for the GUS benchmark
+		if (gus_trace) GUS_TraceRecord(GUSTRACE_IRQACK,0,0);
+		//--End of modifications
 		return (Bit16u)(tmpreg << 8);
 	default:
 #if LOG_GUS
@@ -452,6 +631,15 @@ static void GUS_TimerEvent(Bitu val) {
  
 static void ExecuteGlobRegister(void) {
 	int i;
+	//--Added 2026-10-19 for the GUS benchmark: the voice registers and reset
+	if (gus_trace && (myGUS.gRegSelect<=0xe || myGUS.gRegSelect==0x4c)) {
+		Bit8u data[4];
+		data[0]=(Bit8u)myGUS.gCurChannel;
+		data[1]=myGUS.gRegSelect;
+		host_writew(&data[2],myGUS.gRegData);
+		GUS_TraceRecord(GUSTRACE_WRITE,data,sizeof(data));
+	}
+	//--End of modifications
 //	if (myGUS.gRegSelect|1!=0x44) LOG_MSG("write global register %x with %x", myGUS.gRegSelect, myGUS.gRegData);
 	switch(myGUS.gRegSelect) {
 	case 0x0:  // Channel voice control register
@@ -633,6 +821,9 @@ static Bitu read_gus(Bitu port,Bitu iolen) {
 
 static void write_gus(Bitu port,Bitu val,Bitu iolen) {
 //	LOG_MSG("Write gus port %x val %x",port,val);
+	//--Added 2026-10-19 for idle channels
+	gus_chan->WakeUp();
+	//--End of modifications
 	switch(port - GUS_BASE) {
 	case 0x200:
 		myGUS.mixControl = (Bit8u)val;
@@ -701,6 +892,9 @@ static void write_gus(Bitu port,Bitu val,Bitu iolen) {
 		break;
 	case 0x307:
 		if(myGUS.gDramAddr < sizeof(GUSRam)) GUSRam[myGUS.gDramAddr] = (Bit8u)val;
+		//--Added 2026-10-19 for the GUS benchmark
+		GUS_TraceRam(myGUS.gDramAddr,1);
+		//--End of modifications
 		break;
 	default:
 #if LOG_GUS
@@ -728,6 +922,9 @@ static void GUS_DMA_Callback(DmaChannel * chan,DMAEvent event) {
 				for(i=dmaaddr+1;i<(dmaaddr+read);i+=2) GUSRam[i] ^= 0x80;
 			}
 		}
+		//--Added 2026-10-19 for the GUS benchmark
+		GUS_TraceRam(dmaaddr,read);
+		//--End of modifications
 	} else {
 		//Read data out of UltraSound
 		chan->Write(chan->currcnt+1,&GUSRam[dmaaddr]);
@@ -740,6 +937,9 @@ static void GUS_DMA_Callback(DmaChannel * chan,DMAEvent event) {
 	chan->Register_Callback(0);
 }
 
+//--Modified 2026-10-19: the voices are rendered by GUS_RenderVoices, which the
+//GUS benchmark shares
+/*
 static void GUS_CallBack(Bitu len) {
 	memset(&MixTemp,0,len*8);
 	Bitu i;
@@ -747,6 +947,20 @@ static void GUS_CallBack(Bitu len) {
 	Bit32s * buf32 = (Bit32s *)MixTemp;
 	for(i=0;i<myGUS.ActiveChannels;i++) 
 		guschan[i]->generateSamples(buf32,len);
+*/
+static void GUS_RenderVoices(Bitu len) {
+	memset(&MixTemp,0,len*8);
+	Bitu i;
+	Bit16s * buf16 = (Bit16s *)MixTemp;
+	Bit32s * buf32 = (Bit32s *)MixTemp;
+	if (gus_batched) {
+		for(i=0;i<myGUS.ActiveChannels;i++) 
+			guschan[i]->renderSamples(buf32,len);
+	} else {
+		for(i=0;i<myGUS.ActiveChannels;i++) 
+			guschan[i]->generateSamples(buf32,len);
+	}
+//--End of modifications
 	for(i=0;i<len*2;i++) {
 		Bit32s sample=((buf32[i] >> 13)*AutoAmp)>>9;
 		if (sample>32767) {
@@ -758,8 +972,28 @@ static void GUS_CallBack(Bitu len) {
 		}
 		buf16[i] = (Bit16s)(sample);
 	}
+	//--Added 2026-10-19
+}
+
+static void GUS_CallBack(Bitu len) {
+	Bitu i;
+	Bit16s * buf16 = (Bit16s *)MixTemp;
+	if (gus_trace) {
+		Bit8u data[4];
+		host_writed(data,(Bit32u)len);
+		GUS_TraceRecord(GUSTRACE_GENERATE,data,sizeof(data));
+	}
+	GUS_RenderVoices(len);
+	//--End of modifications
 	gus_chan->AddSamples_s16(len,buf16);
 	CheckVoiceIrq();
+	//--Added 2026-10-19: once every voice has stopped and no voice irq is left to
+	//deliver, nothing changes until the next port write
+	if (!((myGUS.RampIRQ|myGUS.WaveIRQ) & myGUS.ActiveMask)) {
+		for(i=0;i<myGUS.ActiveChannels;i++) if (!guschan[i]->Stopped()) break;
+		if (i==myGUS.ActiveChannels) gus_chan->Sleep();
+	}
+	//--End of modifications
 }
 
 // Generate logarithmic to linear volume conversion tables
@@ -871,7 +1105,13 @@ public:
 	
 		for(Bitu i=0;i<32;i++) {
 			delete guschan[i];
+			//--Added 2026-10-19 so the GUS benchmark can tell there's no card
+			guschan[i]=0;
+			//--End of modifications
 		}
+		//--Added 2026-10-19
+		GUS_StopTrace();
+		//--End of modifications
 
 		memset(&myGUS,0,sizeof(myGUS));
 		memset(GUSRam,0,1024*1024);
@@ -888,3 +1128,179 @@ void GUS_Init(Section* sec) {
 	test = new GUS(sec);
 	sec->AddDestroyFunction(&GUS_ShutDown,true);
 }
+
+//--Added 2026-10-19 for the GUS benchmark
+#define GUSTRACE_ID "GUSTRACE"
+#define GUSTRACE_VERSION 1
+
+bool GUS_StartTrace(const char * filename) {
+	if (!guschan[0] || gus_trace) return false;
+	gus_trace=fopen(filename,"wb");
+	if (!gus_trace) return false;
+	/* The card's state is stored as it is in memory, so a trace only plays back
+	   in the same build that recorded it: the sizes catch most mismatches. */
+	Bit8u header[16];
+	memcpy(header,GUSTRACE_ID,8);
+	host_writed(&header[8],GUSTRACE_VERSION);
+	host_writew(&header[12],(Bit16u)sizeof(myGUS));
+	host_writew(&header[14],(Bit16u)sizeof(GUSChannels));
+	fwrite(header,1,sizeof(header),gus_trace);
+	fwrite(&myGUS,1,sizeof(myGUS),gus_trace);
+	for (Bitu i=0;i<32;i++) fwrite(guschan[i],1,sizeof(GUSChannels),gus_trace);
+	fwrite(&AutoAmp,1,sizeof(AutoAmp),gus_trace);
+	fwrite(GUSRam,1,sizeof(GUSRam),gus_trace);
+	return true;
+}
+
+void GUS_StopTrace(void) {
+	if (!gus_trace) return;
+	fclose(gus_trace);
+	gus_trace=0;
+}
+
+/* Traces are little-endian whatever the host */
+static inline Bit16u GUS_TraceReadw(const std::vector<Bit8u> & trace,Bitu pos) {
+	return (Bit16u)(trace[pos] | (trace[pos+1] << 8));
+}
+
+static inline Bit32u GUS_TraceReadd(const std::vector<Bit8u> & trace,Bitu pos) {
+	return (Bit32u)trace[pos] | ((Bit32u)trace[pos+1] << 8) | ((Bit32u)trace[pos+2] << 16) | ((Bit32u)trace[pos+3] << 24);
+}
+
+/* Plays a trace into the card from the start, with voice irqs kept from the PIC,
+   and returns a hash of everything mixed. */
+static bool GUS_ReplayTrace(const std::vector<Bit8u> & trace,Bit64u & micros,Bit32u & hash,Bitu & samples) {
+	Bitu pos=16;
+	memcpy(&myGUS,&trace[pos],sizeof(myGUS));
+	pos+=sizeof(myGUS);
+	for (Bitu i=0;i<32;i++) {
+		memcpy(guschan[i],&trace[pos],sizeof(GUSChannels));
+		pos+=sizeof(GUSChannels);
+	}
+	memcpy(&AutoAmp,&trace[pos],sizeof(AutoAmp));
+	pos+=sizeof(AutoAmp);
+	memcpy(GUSRam,&trace[pos],sizeof(GUSRam));
+	pos+=sizeof(GUSRam);
+	curchan=guschan[myGUS.gCurChannel];
+
+	hash=2166136261u;
+	samples=0;
+	Bit64u start=GetMicroTicks();
+	while (pos<trace.size()) {
+		Bit8u type=trace[pos++];
+		myGUS.mixControl&=~0x08;
+		switch (type) {
+		case GUSTRACE_GENERATE: {
+			if (trace.size()-pos<4) return false;
+			Bitu len=GUS_TraceReadd(trace,pos);
+			pos+=4;
+			if (len>MIXER_BUFSIZE/8) return false;
+			GUS_RenderVoices(len);
+			CheckVoiceIrq();
+			const Bit16s * buf16=(const Bit16s *)MixTemp;
+			for (Bitu i=0;i<len*2;i++) hash=(hash^(Bit16u)buf16[i])*16777619u;
+			samples+=len;
+			break;
+		}
+		case GUSTRACE_WRITE:
+			if (trace.size()-pos<4) return false;
+			myGUS.gCurChannel=trace[pos] & 31;
+			curchan=guschan[myGUS.gCurChannel];
+			myGUS.gRegSelect=trace[pos+1];
+			myGUS.gRegData=GUS_TraceReadw(trace,pos+2);
+			pos+=4;
+			ExecuteGlobRegister();
+			break;
+		case GUSTRACE_IRQACK:
+			myGUS.gRegSelect=0x8f;
+			ExecuteReadRegister();
+			break;
+		case GUSTRACE_RAM: {
+			if (trace.size()-pos<8) return false;
+			Bitu addr=GUS_TraceReadd(trace,pos);
+			Bitu len=GUS_TraceReadd(trace,pos+4);
+			pos+=8;
+			if (addr>=sizeof(GUSRam) || len>sizeof(GUSRam)-addr || len>trace.size()-pos) return false;
+			memcpy(&GUSRam[addr],&trace[pos],len);
+			pos+=len;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	micros=GetMicroTicks()-start;
+	return true;
+}
+
+bool GUS_BenchmarkTrace(const char * filename,char * report,Bitu size) {
+	if (!guschan[0]) {
+		snprintf(report,size,"The GUS is not enabled.\n");
+		return false;
+	}
+	std::vector<Bit8u> trace;
+	FILE * f=fopen(filename,"rb");
+	if (!f) {
+		snprintf(report,size,"Can't open %s.\n",filename);
+		return false;
+	}
+	Bit8u chunk[4096];
+	size_t len;
+	while ((len=fread(chunk,1,sizeof(chunk),f))>0) trace.insert(trace.end(),chunk,chunk+len);
+	fclose(f);
+	Bitu header=16+sizeof(myGUS)+32*sizeof(GUSChannels)+sizeof(AutoAmp)+sizeof(GUSRam);
+	if (trace.size()<header || memcmp(&trace[0],GUSTRACE_ID,8) || GUS_TraceReadd(trace,8)!=GUSTRACE_VERSION ||
+		GUS_TraceReadw(trace,12)!=sizeof(myGUS) || GUS_TraceReadw(trace,14)!=sizeof(GUSChannels)) {
+		snprintf(report,size,"%s is not a GUS trace from this version.\n",filename);
+		return false;
+	}
+
+	/* Keep the live card to one side while the trace takes it over */
+	GFGus saved_gus=myGUS;
+	std::vector<Bit8u> saved_voices(32*sizeof(GUSChannels));
+	for (Bitu i=0;i<32;i++) memcpy(&saved_voices[i*sizeof(GUSChannels)],guschan[i],sizeof(GUSChannels));
+	std::vector<Bit8u> saved_ram(GUSRam,GUSRam+sizeof(GUSRam));
+	Bit32s saved_autoamp=AutoAmp;
+	GUSChannels * saved_curchan=curchan;
+	Bit8u saved_commandreg=adlib_commandreg;
+	bool saved_enabled=gus_chan->enabled;
+	FILE * saved_trace=gus_trace;
+	gus_trace=0;
+
+	Bit64u reference_us=0,batched_us=0;
+	Bit32u reference_hash=0,batched_hash=0;
+	Bitu samples=0;
+	gus_batched=false;
+	bool ok=GUS_ReplayTrace(trace,reference_us,reference_hash,samples);
+	gus_batched=true;
+	if (ok) ok=GUS_ReplayTrace(trace,batched_us,batched_hash,samples);
+
+	myGUS=saved_gus;
+	for (Bitu i=0;i<32;i++) memcpy(guschan[i],&saved_voices[i*sizeof(GUSChannels)],sizeof(GUSChannels));
+	memcpy(GUSRam,&saved_ram[0],sizeof(GUSRam));
+	AutoAmp=saved_autoamp;
+	curchan=saved_curchan;
+	adlib_commandreg=saved_commandreg;
+	gus_chan->Enable(saved_enabled);
+	gus_trace=saved_trace;
+
+	if (!ok) {
+		snprintf(report,size,"%s is damaged.\n",filename);
+		return false;
+	}
+	if (!reference_us) reference_us=1;
+	if (!batched_us) batched_us=1;
+	double seconds=(double)samples/GUS_RATE;
+	snprintf(report,size,
+		"GUS trace replay: %lu samples (%.1f s of sound)\n"
+		"  one sample at a time: %8.1f ms, %6.1fx realtime\n"
+		"  batched voices:       %8.1f ms, %6.1fx realtime\n"
+		"  speedup %.2fx, output %s\n",
+		(unsigned long)samples,seconds,
+		reference_us/1000.0,seconds*1000000.0/reference_us,
+		batched_us/1000.0,seconds*1000000.0/batched_us,
+		(double)reference_us/batched_us,
+		reference_hash==batched_hash ? "identical" : "DIFFERENT");
+	return reference_hash==batched_hash;
+}
+//--End of modifications
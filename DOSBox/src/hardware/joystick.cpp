@@ -25,6 +25,9 @@
 #include "joystick.h"
 #include "pic.h"
 #include "support.h"
+//--Added 2026-10-19 to record and replay input deterministically
+#include "replay.h"
+//--End of modifications
 
 #define RANGE 64
 #define TIMEOUT 10
@@ -175,16 +178,25 @@ void JOYSTICK_Enable(Bitu which,bool enabled) {
 }
 
 void JOYSTICK_Button(Bitu which,Bitu num,bool pressed) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_JoystickButtonEvent(which,num,pressed)) return;
+	//--End of modifications
 	if ((which<2) && (num<2)) stick[which].button[num]=pressed;
 }
 
 void JOYSTICK_Move_X(Bitu which,float x) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_JoystickAxisEvent(which,0,x)) return;
+	//--End of modifications
 	if (which<2) {
 		stick[which].xpos=x;
 	}
 }
 
 void JOYSTICK_Move_Y(Bitu which,float y) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_JoystickAxisEvent(which,1,y)) return;
+	//--End of modifications
 	if (which<2) {
 		stick[which].ypos=y;
 	}
@@ -25,6 +25,9 @@
 #include "mem.h"
 #include "mixer.h"
 #include "timer.h"
+//--Added 2026-10-19 to record and replay input deterministically
+#include "replay.h"
+//--End of modifications
 //--Added 2012-02-24 by Alun Bestor to give Boxer more hooks into keyboard behaviour
 #import "BXCoalface.h"
 //--End of modifications
@@ -227,6 +230,9 @@ static Bitu read_p64(Bitu port,Bitu iolen) {
 }
 
 void KEYBOARD_AddKey(KBD_KEYS keytype,bool pressed) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_KeyEvent(keytype,pressed)) return;
+	//--End of modifications
 	Bit8u ret=0;bool extend=false;
 	switch (keytype) {
 	case KBD_esc:ret=1;break;
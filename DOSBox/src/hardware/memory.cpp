@@ -27,6 +27,17 @@
 
 #include <string.h>
 
+//--Added 2026-10-19 to back guest RAM with an mmap region that can be snapshotted
+#include "timer.h"
+#include "savestate.h"
+#if defined(C_HAVE_MPROTECT) && !defined(WIN32)
+#define C_MEM_MMAP 1
+#include <sys/mman.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+//--End of modifications
+
 #define PAGES_IN_BLOCK	((1024*1024)/MEM_PAGE_SIZE)
 #define SAFE_MEMORY	32
 #define MAX_MEMORY	64
@@ -536,6 +547,318 @@ void PreparePCJRCartRom(void) {
 
 HostPt GetMemBase(void) { return MemBase; }
 
+//--Added 2026-10-19: copy-on-write snapshots of guest RAM, which serve as the
+//reference that saved states are delta-encoded against (see MEM_SaveRAM below).
+//Taking a snapshot write-protects the whole of guest RAM; the first write to each
+//host page afterwards faults, and the fault handler preserves the page's original
+//contents before making it writeable again. Restoring copies back only those pages
+//that were modified, so both operations cost time proportional to the dirty set
+//rather than to the size of guest RAM.
+enum {
+	SNAPSHOT_CLEAN=0,		//Page still holds its contents from the snapshot
+	SNAPSHOT_COPYING,		//A fault handler is preserving the page right now
+	SNAPSHOT_DIRTY			//Page has been preserved in the store and may differ
+};
+
+static struct {
+	volatile bool active;	//Whether guest RAM is write-protected
+	Bitu size;				//Size of guest RAM in bytes
+	Bitu page_size;			//Granularity of dirty tracking (at least MEM_PAGESIZE)
+	Bitu host_pages;
+	HostPt store;			//Original contents of pages modified since the snapshot
+	Bit8u * dirty;			//SNAPSHOT_ state of each host page
+	Bitu dirty_count;
+	double snapshot_ms;
+	double restore_ms;
+#if C_MEM_MMAP
+	struct sigaction old_segv;
+	struct sigaction old_bus;
+	bool handler_installed;
+#endif
+} snapshot;
+
+/* Overwrite a whole page of RAM from src. */
+static void MEM_WritePage(Bitu page,HostPt src) {
+	Bitu addr=0;
+	//Write through any code page handler so that translated code
+	//in this page gets invalidated along the way; the handler may
+	//release the page partway through, so check it every time.
+	while (addr<MEM_PAGESIZE && (memory.phandlers[page]->flags & PFLAG_HASCODE)) {
+		memory.phandlers[page]->writed(page*MEM_PAGESIZE+addr,host_readd(src+addr));
+		addr+=4;
+	}
+	memcpy(MemBase+page*MEM_PAGESIZE+addr,src+addr,MEM_PAGESIZE-addr);
+}
+
+#if C_MEM_MMAP
+/* This runs as a signal handler, possibly on a thread other than the emulation's
+   (such as one filling a sound buffer from guest RAM), so it sticks to memcpy and
+   mprotect and claims each page atomically. A thread that loses the race for a
+   page returns straight away and faults again until the winner has unprotected it. */
+static void MEM_SnapshotFaultHandler(int sig,siginfo_t * info,void * context) {
+	HostPt addr=(HostPt)info->si_addr;
+	if (snapshot.active && addr>=MemBase && addr<MemBase+snapshot.size) {
+		Bitu host_page=(Bitu)(addr-MemBase)/snapshot.page_size;
+		if (__sync_bool_compare_and_swap(&snapshot.dirty[host_page],SNAPSHOT_CLEAN,SNAPSHOT_COPYING)) {
+			HostPt page=MemBase+host_page*snapshot.page_size;
+			memcpy(snapshot.store+host_page*snapshot.page_size,page,snapshot.page_size);
+			__sync_fetch_and_add(&snapshot.dirty_count,1);
+			__sync_synchronize();
+			snapshot.dirty[host_page]=SNAPSHOT_DIRTY;
+			mprotect(page,snapshot.page_size,PROT_READ|PROT_WRITE);
+		}
+		return;
+	}
+	//Not one of ours: hand it on to whoever was there before us.
+	struct sigaction * old=(sig==SIGBUS) ? &snapshot.old_bus : &snapshot.old_segv;
+	if (old->sa_flags & SA_SIGINFO) {
+		old->sa_sigaction(sig,info,context);
+	} else if (old->sa_handler!=SIG_DFL && old->sa_handler!=SIG_IGN) {
+		old->sa_handler(sig);
+	} else {
+		//Reinstate the default action and let the faulting instruction rerun
+		sigaction(sig,old,0);
+	}
+}
+
+/* The handler is only in place while a snapshot exists. */
+static void MEM_InstallSnapshotHandler(void) {
+	if (snapshot.handler_installed) return;
+	struct sigaction action;
+	memset(&action,0,sizeof(action));
+	action.sa_sigaction=MEM_SnapshotFaultHandler;
+	action.sa_flags=SA_SIGINFO|SA_NODEFER;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGSEGV,&action,&snapshot.old_segv);
+	sigaction(SIGBUS,&action,&snapshot.old_bus);
+	snapshot.handler_installed=true;
+}
+
+static void MEM_RemoveSnapshotHandler(void) {
+	if (!snapshot.handler_installed) return;
+	sigaction(SIGSEGV,&snapshot.old_segv,0);
+	sigaction(SIGBUS,&snapshot.old_bus,0);
+	snapshot.handler_installed=false;
+}
+#endif
+
+/* Make guest RAM writeable again without preserving anything further: the
+   snapshot must be taken again before it can be relied on. */
+static void MEM_SuspendSnapshot(void) {
+#if C_MEM_MMAP
+	if (!snapshot.active) return;
+	snapshot.active=false;
+	mprotect(MemBase,snapshot.size,PROT_READ|PROT_WRITE);
+#endif
+}
+
+static void MEM_TakeSnapshot(void) {
+	Bit64u start=GetMicroTicks();
+	if (!snapshot.store) {
+		snapshot.size=memory.pages*MEM_PAGESIZE;
+		snapshot.page_size=MEM_PAGESIZE;
+#if C_MEM_MMAP
+		Bitu host_page_size=(Bitu)sysconf(_SC_PAGESIZE);
+		if (host_page_size>snapshot.page_size) snapshot.page_size=host_page_size;
+#endif
+		snapshot.host_pages=snapshot.size/snapshot.page_size;
+		snapshot.store=new Bit8u[snapshot.size];
+		snapshot.dirty=new Bit8u[snapshot.host_pages];
+	}
+	MEM_SuspendSnapshot();
+	memset(snapshot.dirty,SNAPSHOT_CLEAN,snapshot.host_pages);
+	snapshot.dirty_count=0;
+#if C_MEM_MMAP
+	MEM_InstallSnapshotHandler();
+	snapshot.active=true;
+	if (mprotect(MemBase,snapshot.size,PROT_READ)!=0) snapshot.active=false;
+#endif
+	if (!snapshot.active) {
+		//Fall back on an eager copy of everything
+		memcpy(snapshot.store,MemBase,snapshot.size);
+		memset(snapshot.dirty,SNAPSHOT_DIRTY,snapshot.host_pages);
+		snapshot.dirty_count=snapshot.host_pages;
+	}
+	snapshot.snapshot_ms=(GetMicroTicks()-start)/1000.0;
+}
+
+/* Copy back every page modified since the snapshot, leaving RAM writeable. */
+static void MEM_RestoreSnapshot(void) {
+	Bit64u start=GetMicroTicks();
+	MEM_SuspendSnapshot();
+	Bitu guest_pages_per_host_page=snapshot.page_size/MEM_PAGESIZE;
+	for (Bitu host_page=0;host_page<snapshot.host_pages;host_page++) {
+		if (snapshot.dirty[host_page]!=SNAPSHOT_DIRTY) continue;
+		Bitu first=host_page*guest_pages_per_host_page;
+		for (Bitu page=first;page<first+guest_pages_per_host_page;page++) {
+			MEM_WritePage(page,snapshot.store+page*MEM_PAGESIZE);
+		}
+	}
+	snapshot.restore_ms=(GetMicroTicks()-start)/1000.0;
+}
+
+static void MEM_DiscardSnapshot(void) {
+	MEM_SuspendSnapshot();
+#if C_MEM_MMAP
+	MEM_RemoveSnapshotHandler();
+#endif
+	delete [] snapshot.store;
+	delete [] snapshot.dirty;
+	snapshot.store=0;
+	snapshot.dirty=0;
+	snapshot.dirty_count=0;
+}
+
+/* The contents of a page as they were when the snapshot was taken. */
+static HostPt MEM_SnapshotPage(Bitu page) {
+	Bitu host_page=page*MEM_PAGESIZE/snapshot.page_size;
+	return ((snapshot.dirty[host_page]==SNAPSHOT_DIRTY) ? snapshot.store : MemBase)+page*MEM_PAGESIZE;
+}
+
+static bool MEM_SnapshotPageDirty(Bitu page) {
+	return snapshot.dirty[page*MEM_PAGESIZE/snapshot.page_size]!=SNAPSHOT_CLEAN;
+}
+
+void MEM_GetSnapshotStats(MEM_SnapshotStats * stats) {
+	stats->total_pages=memory.pages;
+	stats->dirty_pages=snapshot.dirty_count*(snapshot.page_size/MEM_PAGESIZE);
+	stats->snapshot_ms=snapshot.snapshot_ms;
+	stats->restore_ms=snapshot.restore_ms;
+}
+//--End of modifications
+
+//--Added 2026-10-19 to save and load the contents of guest RAM.
+/* RAM is saved as the XOR difference of each page from a reference: for a full
+   state the reference is all zeroes, for a delta it is the snapshot taken when
+   the last state was saved or loaded, so only the pages written since then need
+   looking at. Each differing page is stored as runs of unchanged dwords followed
+   by runs of changed ones, so that mostly-empty and mostly-unchanged pages both
+   take up very little room. */
+#define MEM_STATE_END 0xffffffff
+#define MEM_PAGE_DWORDS (MEM_PAGESIZE/4)
+
+static struct {
+	Bit64u serial;
+	bool valid;
+} reference;
+
+static bool MEM_PageDiffers(Bitu page,bool delta) {
+	if (delta) {
+		if (!MEM_SnapshotPageDirty(page)) return false;
+		return memcmp(MemBase+page*MEM_PAGESIZE,MEM_SnapshotPage(page),MEM_PAGESIZE)!=0;
+	}
+	const Bit32u * cur=(const Bit32u *)(MemBase+page*MEM_PAGESIZE);
+	for (Bitu i=0;i<MEM_PAGE_DWORDS;i++) if (cur[i]) return true;
+	return false;
+}
+
+/* Worst case is a page of alternating runs: a 4 byte record header for every
+   dword and the dword itself, plus the page number. */
+#define MEM_MAX_ENCODED_PAGE (4+MEM_PAGESIZE*2)
+
+static Bitu MEM_EncodePage(HostPt dest,Bitu page,bool delta) {
+	const Bit32u * cur=(const Bit32u *)(MemBase+page*MEM_PAGESIZE);
+	const Bit32u * ref=delta ? (const Bit32u *)MEM_SnapshotPage(page) : 0;
+	HostPt start=dest;
+	host_writed(dest,(Bit32u)page);dest+=4;
+	Bitu i=0;
+	while (i<MEM_PAGE_DWORDS) {
+		Bitu same=0;
+		while (i<MEM_PAGE_DWORDS && cur[i]==(ref ? ref[i] : 0)) { same++;i++; }
+		Bitu changed=0;
+		HostPt header=dest;dest+=4;
+		while (i<MEM_PAGE_DWORDS && cur[i]!=(ref ? ref[i] : 0)) {
+			host_writed(dest,cur[i]^(ref ? ref[i] : 0));dest+=4;
+			changed++;i++;
+		}
+		host_writew(header,(Bit16u)same);
+		host_writew(header+2,(Bit16u)changed);
+	}
+	return dest-start;
+}
+
+static void MEM_SaveRAM(SaveStateWriter & state) {
+	bool delta=state.Delta() && reference.valid;
+	state.WriteBool(delta);
+	state.WriteQ(delta ? reference.serial : 0);
+
+	for (Bitu page=0;page<memory.pages;page++) {
+		if (!MEM_PageDiffers(page,delta)) continue;
+		Bitu start=state.Size();
+		HostPt dest=state.Reserve(MEM_MAX_ENCODED_PAGE);
+		state.Truncate(start+MEM_EncodePage(dest,page,delta));
+	}
+	state.WriteD(MEM_STATE_END);
+
+	//RAM as it was saved becomes the reference for the next delta
+	MEM_TakeSnapshot();
+	reference.serial=state.Serial();
+	reference.valid=true;
+}
+
+static bool MEM_LoadRAM(SaveStateReader & state) {
+	bool delta=state.ReadBool();
+	Bit64u base=state.ReadQ();
+	if (delta && (!reference.valid || reference.serial!=base)) {
+		LOG_MSG("SAVESTATE:Memory is saved relative to a state that is not loaded");
+		return false;
+	}
+
+	//Go back to RAM as it was in the reference, or clear it for a full state.
+	//From here on the reference will not match any saved state until we're done.
+	bool apply=!state.Checking();
+	if (apply) {
+		reference.valid=false;
+		if (delta) MEM_RestoreSnapshot();
+		else MEM_SuspendSnapshot();
+	}
+
+	static Bit8u zero_page[MEM_PAGESIZE];
+	Bit32u page_data[MEM_PAGE_DWORDS];
+	Bitu next_page=0;
+	for (;;) {
+		Bit32u page=state.ReadD();
+		if (state.Failed()) return false;
+		if (page!=MEM_STATE_END && (page>=memory.pages || page<next_page)) return false;
+		if (apply && !delta) {
+			//Pages left out of a full state are empty
+			Bitu last=(page==MEM_STATE_END) ? memory.pages : page;
+			for (;next_page<last;next_page++) {
+				if (MEM_PageDiffers(next_page,false)) MEM_WritePage(next_page,zero_page);
+			}
+		}
+		if (page==MEM_STATE_END) break;
+		next_page=page+1;
+
+		if (apply) {
+			if (delta) memcpy(page_data,MemBase+page*MEM_PAGESIZE,MEM_PAGESIZE);
+			else memset(page_data,0,MEM_PAGESIZE);
+		}
+		Bitu i=0;
+		while (i<MEM_PAGE_DWORDS) {
+			Bitu same=state.ReadW();
+			Bitu changed=state.ReadW();
+			if (i+same+changed>MEM_PAGE_DWORDS) return false;
+			const Bit8u * data=state.Skip(changed*4);
+			if (!data) return false;
+			i+=same;
+			if (!apply) {
+				i+=changed;
+				continue;
+			}
+			for (Bitu j=0;j<changed;j++,i++) page_data[i]^=host_readd((HostPt)data+j*4);
+		}
+		if (apply) MEM_WritePage(page,(HostPt)page_data);
+	}
+	if (!apply) return true;
+
+	MEM_TakeSnapshot();
+	reference.serial=state.Serial();
+	reference.valid=true;
+	return true;
+}
+//--End of modifications
+
 class MEMORY:public Module_base{
 private:
 	IO_ReadHandleObject ReadHandler;
@@ -558,11 +881,20 @@ public:
 			LOG_MSG("Memory sizes above %d MB are NOT recommended.",SAFE_MEMORY - 1);
 			LOG_MSG("Stick with the default values unless you are absolutely certain.");
 		}
+		//--Modified 2026-10-19 to back guest RAM with an anonymous mmap region,
+		//which comes zeroed and page-aligned so it can be write-protected for snapshots.
+#if C_MEM_MMAP
+		void * region = mmap(0,memsize*1024*1024,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANON,-1,0);
+		if (region == MAP_FAILED) E_Exit("Can't allocate main memory of %d MB",memsize);
+		MemBase = (HostPt)region;
+#else
 		MemBase = new Bit8u[memsize*1024*1024];
 		if (!MemBase) E_Exit("Can't allocate main memory of %d MB",memsize);
 		/* Clear the memory, as new doesn't always give zeroed memory
 		 * (Visual C debug mode). We want zeroed memory though. */
 		memset((void*)MemBase,0,memsize*1024*1024);
+#endif
+		//--End of modifications
 		memory.pages = (memsize*1024*1024)/4096;
 		/* Allocate the data for the different page information blocks */
 		memory.phandlers=new  PageHandler * [memory.pages];
@@ -592,8 +924,41 @@ public:
 		ReadHandler.Install(0x92,read_p92,IO_MB);
 		MEM_A20_Enable(false);
 	}
+	//--Added 2026-10-19 to save and load guest RAM and its allocations
+	const char * GetStateName(void) { return "MEMORY"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteD((Bit32u)memory.pages);
+		state.WriteBool(memory.a20.enabled);
+		state.WriteB(memory.a20.controlport);
+		state.WriteBlock(memory.mhandles,memory.pages*sizeof(MemHandle));
+		MEM_SaveRAM(state);
+	}
+	bool LoadState(SaveStateReader & state) {
+		if (state.ReadD()!=memory.pages) {
+			LOG_MSG("SAVESTATE:Memory size does not match");
+			return false;
+		}
+		bool a20=state.ReadBool();
+		Bit8u controlport=state.ReadB();
+		if (!state.ReadBlock(memory.mhandles,memory.pages*sizeof(MemHandle))) return false;
+		if (!state.Checking()) {
+			memory.a20.controlport=controlport;
+			MEM_A20_Enable(a20);
+		}
+		return MEM_LoadRAM(state);
+	}
+	//--End of modifications
 	~MEMORY(){
+		//--Modified 2026-10-19 to release the mmap region and any snapshot
+		MEM_DiscardSnapshot();
+		reference.valid=false;
+#if C_MEM_MMAP
+		munmap(MemBase,memory.pages*MEM_PAGESIZE);
+#else
 		delete [] MemBase;
+#endif
+		MemBase = 0;
+		//--End of modifications
 		delete [] memory.phandlers;
 		delete [] memory.mhandles;
 	}
@@ -43,6 +43,9 @@
 #include "mixer.h"
 #include "timer.h"
 #include "setup.h"
+//--Added 2026-10-19 to measure where the time of each frame goes
+#include "profile.h"
+//--End of modifications
 #include "cross.h"
 #include "support.h"
 #include "mapper.h"
@@ -74,6 +77,9 @@ static struct {
 	float mastervol[2];
 	MixerChannel * channels;
 	bool nosound;
+	//--Added 2026-10-19 for benchmarking
+	bool nullsink;
+	//--End of modifications
 	Bit32u freq;
 	Bit32u blocksize;
 } mixer;
@@ -89,6 +95,12 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
 	chan->next=mixer.channels;
 	chan->SetVolume(1,1);
 	chan->enabled=false;
+	//--Added 2026-10-19 for idle channels
+	chan->sleeping=false;
+	chan->slept_index=0;
+	chan->idle=0;
+	chan->awake_ms=chan->asleep_ms=0;
+	//--End of modifications
 	mixer.channels=chan;
 	return chan;
 }
@@ -139,6 +151,9 @@ void MixerChannel::SetScale( float f ) {
 void MixerChannel::Enable(bool _yesno) {
 	if (_yesno==enabled) return;
 	enabled=_yesno;
+	//--Added 2026-10-19 for idle channels: enabling or disabling always wakes the channel
+	sleeping=false;
+	//--End of modifications
 	if (enabled) {
 		freq_index=MIXER_REMAIN;
 		SDL_LockAudio();
@@ -153,6 +168,15 @@ void MixerChannel::SetFreq(Bitu _freq) {
 
 void MixerChannel::Mix(Bitu _needed) {
 	needed=_needed;
+	//--Added 2026-10-19 for idle channels: fill in silence without asking the handler
+	if (sleeping) {
+		if (enabled && needed>done) {
+			slept_index+=(needed-done)*freq_add;
+			AddSilence();
+		}
+		return;
+	}
+	//--End of modifications
 	while (enabled && needed>done) {
 		Bitu todo=needed-done;
 		todo *= freq_add;
@@ -161,6 +185,23 @@ void MixerChannel::Mix(Bitu _needed) {
 	}
 }
 
+//--Added 2026-10-19 for idle channels
+void MixerChannel::Sleep(MIXER_IdleHandler _idle) {
+	if (sleeping || !enabled) return;
+	sleeping=true;
+	slept_index=0;
+	idle=_idle;
+}
+
+Bitu MixerChannel::WakeUp(void) {
+	if (!sleeping) return 0;
+	/* Silence runs up to the moment of the write that woke us */
+	FillUp();
+	sleeping=false;
+	return slept_index >> MIXER_SHIFT;
+}
+//--End of modifications
+
 void MixerChannel::AddSilence(void) {
 	if (done<needed) {
 		done=needed;
@@ -364,9 +405,20 @@ static inline bool Mixer_irq_important(void) {
 
 /* Mix a certain amount of new samples */
 static void MIXER_MixData(Bitu needed) {
+	//--Added 2026-10-19 to measure where the time of each frame goes
+	ProfileScope scope(PROFILE_MIXER);
+	//--End of modifications
 	MixerChannel * chan=mixer.channels;
 	while (chan) {
 		chan->Mix(needed);
+		//--Added 2026-10-19 to keep count of how long each channel is kept busy, and for idle channels
+		if (chan->enabled) {
+			if (chan->sleeping) chan->asleep_ms++;
+			else chan->awake_ms++;
+		}
+		/* The handler isn't called while asleep, so give the device its idle check here */
+		if (chan->sleeping && chan->idle) chan->idle();
+		//--End of modifications
 		chan=chan->next;
 	}
 	if (CaptureState & (CAPTURE_WAVE|CAPTURE_VIDEO)) {
@@ -571,6 +623,12 @@ public:
 			chan=chan->next;
 		}
 		if (cmd->FindExist("/NOSHOW")) return;
+		//--Added 2026-10-19 to show how long each channel has been generating sound
+		if (cmd->FindExist("/ACTIVE")) {
+			ShowActive();
+			return;
+		}
+		//--End of modifications
 		chan=mixer.channels;
 		WriteOut("Channel  Main    Main(dB)\n");
         //--Modified 2012-02-26 by Alun Bestor to show Boxer's master volume instead.
@@ -581,6 +639,20 @@ public:
 			ShowVolume(chan->name,chan->volmain[0],chan->volmain[1]);
 	}
 private:
+	//--Added 2026-10-19: enabled time is split into time spent calling the handler
+	//and time spent asleep, when the mixer filled in silence by itself
+	void ShowActive(void) {
+		WriteOut("Channel  State     Awake(s)  Asleep(s)  Awake%%\n");
+		for (MixerChannel * chan=mixer.channels;chan;chan=chan->next) {
+			Bitu total=chan->awake_ms+chan->asleep_ms;
+			WriteOut("%-8s %-8s %9.1f %10.1f  %5.1f\n",chan->name,
+				!chan->enabled ? "off" : (chan->sleeping ? "asleep" : "awake"),
+				chan->awake_ms/1000.0,chan->asleep_ms/1000.0,
+				total ? (chan->awake_ms*100.0)/total : 0.0);
+		}
+	}
+	//--End of modifications
+
 	void ShowVolume(const char * name,float vol0,float vol1) {
 		WriteOut("%-8s %3.0f:%-3.0f  %+3.2f:%-+3.2f \n",name,
 			vol0*100,vol1*100,
@@ -618,6 +690,26 @@ MixerChannel* MixerObject::Install(MIXER_Handler handler,Bitu freq,const char *
 	}
 }
 
+//--Added 2026-10-19 to let benchmarks mix into a null sink instead of the audio device
+void MIXER_SetNullSink(bool enable) {
+	if (mixer.nosound || mixer.nullsink==enable) return;
+	mixer.nullsink=enable;
+	if (enable) {
+		SDL_PauseAudio(1);
+		TIMER_DelTickHandler(MIXER_Mix);
+		mixer.tick_add=(mixer.freq << MIXER_SHIFT)/1000;
+		TIMER_AddTickHandler(MIXER_Mix_NoSound);
+	} else {
+		TIMER_DelTickHandler(MIXER_Mix_NoSound);
+		/* Start the device off with a fresh prebuffer, as at startup */
+		mixer.needed=mixer.min_needed+1;
+		mixer.done=0;
+		TIMER_AddTickHandler(MIXER_Mix);
+		SDL_PauseAudio(0);
+	}
+}
+//--End of modifications
+
 MixerObject::~MixerObject(){
 	if(!installed) return;
 	MIXER_DelChannel(MIXER_FindChannel(m_name));
@@ -631,6 +723,9 @@ void MIXER_Init(Section* sec) {
 	/* Read out config section */
 	mixer.freq=section->Get_int("rate");
 	mixer.nosound=section->Get_bool("nosound");
+	//--Added 2026-10-19 for benchmarking
+	mixer.nullsink=false;
+	//--End of modifications
 	mixer.blocksize=section->Get_int("blocksize");
 
 	/* Initialize the internal stuff */
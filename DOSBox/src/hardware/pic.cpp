@@ -27,6 +27,9 @@
 #include "pic.h"
 #include "timer.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the interrupt controllers
+#include "savestate.h"
+//--End of modifications
 
 #define PIC_QUEUESIZE 512
 
@@ -72,6 +75,23 @@ static struct {
 	PICEntry * next_entry;
 } pic_queue;
 
+//--Added 2026-10-19: handlers whose events are saved along with the PIC
+#define PIC_MAXSTATEEVENTS 32
+static PIC_EventHandler state_events[PIC_MAXSTATEEVENTS];
+static Bitu state_event_count=0;
+
+void PIC_AddStateEvent(PIC_EventHandler handler) {
+	for (Bitu i=0;i<state_event_count;i++) if (state_events[i]==handler) return;
+	if (state_event_count>=PIC_MAXSTATEEVENTS) E_Exit("PIC:Too many event handlers with saved state");
+	state_events[state_event_count++]=handler;
+}
+
+static bool PIC_IsStateEvent(PIC_EventHandler handler) {
+	for (Bitu i=0;i<state_event_count;i++) if (state_events[i]==handler) return true;
+	return false;
+}
+//--End of modifications
+
 static void write_command(Bitu port,Bitu val,Bitu iolen) {
 	PIC_Controller * pic=&pics[port==0x20 ? 0 : 1];
 	Bitu irq_base=port==0x20 ? 0 : 8;
@@ -596,6 +616,69 @@ public:
 		pic_queue.free_entry=&pic_queue.entries[0];
 		pic_queue.next_entry=0;
 	}
+	//--Added 2026-10-19 to save and load the interrupt controllers and event queue
+	const char * GetStateName(void) { return "PIC"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(irqs,sizeof(irqs));
+		state.WriteBlock(pics,sizeof(pics));
+		state.WriteBool(PIC_Special_Mode);
+		state.WriteD((Bit32u)PIC_Ticks);
+		state.WriteD((Bit32u)PIC_IRQCheck);
+		state.WriteD((Bit32u)PIC_IRQOnSecondPicActive);
+		state.WriteD((Bit32u)PIC_IRQActive);
+		/* Events are saved in the order they'll fire in. Those of devices whose
+		   state isn't saved would be meaningless without it, so they're left out. */
+		Bitu count=0;
+		for (PICEntry * entry=pic_queue.next_entry;entry;entry=entry->next) {
+			if (PIC_IsStateEvent(entry->pic_event)) count++;
+		}
+		state.WriteD((Bit32u)count);
+		for (PICEntry * entry=pic_queue.next_entry;entry;entry=entry->next) {
+			if (!PIC_IsStateEvent(entry->pic_event)) continue;
+			state.WriteFloat(entry->index);
+			state.WriteD((Bit32u)entry->value);
+			state.WriteFunction(entry->pic_event);
+		}
+	}
+	bool LoadState(SaveStateReader & state) {
+		state.ReadBlock(irqs,sizeof(irqs));
+		state.ReadBlock(pics,sizeof(pics));
+		bool special_mode=state.ReadBool();
+		Bitu ticks=state.ReadD();
+		Bitu irq_check=state.ReadD();
+		Bitu irq_second_active=state.ReadD();
+		Bitu irq_active=state.ReadD();
+		Bitu count=state.ReadD();
+		if (state.Failed() || count>PIC_QUEUESIZE) return false;
+		if (!state.Checking()) {
+			PIC_Special_Mode=special_mode;
+			PIC_Ticks=ticks;
+			PIC_IRQCheck=irq_check;
+			PIC_IRQOnSecondPicActive=irq_second_active;
+			PIC_IRQActive=irq_active;
+			/* Replace the events of the devices being loaded, and leave the rest alone */
+			for (Bitu i=0;i<state_event_count;i++) PIC_RemoveEvents(state_events[i]);
+		}
+		for (Bitu i=0;i<count;i++) {
+			float index=state.ReadFloat();
+			Bitu value=state.ReadD();
+			PIC_EventHandler handler=state.ReadFunction<PIC_EventHandler>();
+			if (state.Failed() || !PIC_IsStateEvent(handler)) return false;
+			if (state.Checking()) continue;
+			if (GCC_UNLIKELY(!pic_queue.free_entry)) {
+				LOG(LOG_PIC,LOG_ERROR)("Event queue full");
+				continue;
+			}
+			PICEntry * entry=pic_queue.free_entry;
+			pic_queue.free_entry=entry->next;
+			entry->index=index;
+			entry->value=value;
+			entry->pic_event=handler;
+			AddEntry(entry);
+		}
+		return true;
+	}
+	//--End of modifications
 	~PIC(){
 	}
 };
@@ -580,6 +580,9 @@ static void CheckDMAEnd(void) {
 static void DSP_ChangeMode(DSP_MODES mode) {
 	if (sb.mode==mode) return;
 	else sb.chan->FillUp();
+	//--Added 2026-10-19 for idle channels: only MODE_NONE sleeps, and it's left through here
+	sb.chan->WakeUp();
+	//--End of modifications
 	sb.mode=mode;
 }
 
@@ -1441,6 +1444,9 @@ static void SBLASTER_CallBack(Bitu len) {
 	case MODE_DMA_PAUSE:
 	case MODE_DMA_MASKED:
 		sb.chan->AddSilence();
+		//--Added 2026-10-19 for idle channels
+		if (sb.mode==MODE_NONE) sb.chan->Sleep();
+		//--End of modifications
 		break;
 	case MODE_DAC:
 //		GenerateDACSound(len);
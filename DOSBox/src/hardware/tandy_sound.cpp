@@ -108,6 +108,9 @@ static void SN76496Write(Bitu /*port*/,Bitu data,Bitu /*iolen*/) {
 		tandy.chan->Enable(true);
 		tandy.enabled=true;
 	}
+	//--Added 2026-10-19 for idle channels
+	tandy.chan->WakeUp();
+	//--End of modifications
 
 	/* update the output buffer before changing the registers */
 
@@ -177,11 +180,25 @@ static void SN76496Write(Bitu /*port*/,Bitu data,Bitu /*iolen*/) {
 	}
 }
 
+//--Added 2026-10-19: the mixer also calls this while the channel sleeps
+static void SN76496IdleCheck(void) {
+	if ((tandy.last_write+5000)<PIC_Ticks) {
+		tandy.enabled=false;
+		tandy.chan->Enable(false);
+	}
+}
+//--End of modifications
+
 static void SN76496Update(Bitu length) {
+	//--Modified 2026-10-19 to share the idle check with the sleeping channel
+	SN76496IdleCheck();
+	/*
 	if ((tandy.last_write+5000)<PIC_Ticks) {
 		tandy.enabled=false;
 		tandy.chan->Enable(false);
 	}
+	*/
+	//--End of modifications
 	int i;
 	struct SN76496 *R = &sn;
 	Bit16s * buffer=(Bit16s *)MixTemp;
@@ -271,6 +288,11 @@ static void SN76496Update(Bitu length) {
 		count--;
 	}
 	tandy.chan->AddSamples_m16(length,(Bit16s *)MixTemp);
+	//--Added 2026-10-19: with every voice turned all the way down, the output stays
+	//at 0 until the next write
+	if (!R->Volume[0] && !R->Volume[1] && !R->Volume[2] && !R->Volume[3])
+		tandy.chan->Sleep(SN76496IdleCheck);
+	//--End of modifications
 }
 
 
@@ -19,6 +19,7 @@
 /* $Id: timer.cpp,v 1.49 2009-04-10 09:53:04 c2woody Exp $ */
 
 #include <math.h>
+#include <sys/time.h>
 #include "dosbox.h"
 #include "inout.h"
 #include "pic.h"
@@ -26,6 +27,17 @@
 #include "mixer.h"
 #include "timer.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the timer state
+#include "savestate.h"
+//--End of modifications
+
+//--Added 2026-10-19: a microsecond-resolution host clock for profiling
+Bit64u GetMicroTicks(void) {
+	struct timeval now;
+	gettimeofday(&now,0);
+	return (Bit64u)now.tv_sec*1000000+(Bit64u)now.tv_usec;
+}
+//--End of modifications
 
 static INLINE void BIN2BCD(Bit16u& val) {
 	Bit16u temp=val%10 + (((val/10)%10)<<4)+ (((val/100)%10)<<8) + (((val/1000)%10)<<12);
@@ -445,7 +457,32 @@ public:
 		latched_timerstatus_locked=false;
 		gate2 = false;
 		PIC_AddEvent(PIT0_Event,pit[0].delay);
+		//--Added 2026-10-19 to save and load the timer state
+		PIC_AddStateEvent(PIT0_Event);
+		//--End of modifications
+	}
+	//--Added 2026-10-19 to save and load the timer state
+	const char * GetStateName(void) { return "TIMER"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(pit,sizeof(pit));
+		state.WriteBool(gate2);
+		state.WriteB(latched_timerstatus);
+		state.WriteBool(latched_timerstatus_locked);
+	}
+	bool LoadState(SaveStateReader & state) {
+		//The PIT0 event itself is restored along with the rest of the PIC queue
+		state.ReadBlock(pit,sizeof(pit));
+		bool gate=state.ReadBool();
+		Bit8u status=state.ReadB();
+		bool status_locked=state.ReadBool();
+		if (state.Failed()) return false;
+		if (state.Checking()) return true;
+		gate2=gate;
+		latched_timerstatus=status;
+		latched_timerstatus_locked=status_locked;
+		return true;
 	}
+	//--End of modifications
 	~TIMER(){
 		PIC_RemoveEvents(PIT0_Event);
 	}
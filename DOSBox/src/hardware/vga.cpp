@@ -23,6 +23,10 @@
 #include "video.h"
 #include "pic.h"
 #include "vga.h"
+//--Added 2026-10-19 to save and load the video adapter state
+#include "mem.h"
+#include "savestate.h"
+//--End of modifications
 
 #include <string.h>
 
@@ -173,6 +177,114 @@ void VGA_SetCGA4Table(Bit8u val0,Bit8u val1,Bit8u val2,Bit8u val3) {
 	}	
 }
 
+//--Added 2026-10-19 to save and load the video adapter state.
+/* Tandy and PCjr video memory may be in main memory or VGA memory */
+static void VGA_SaveTandyBase(SaveStateWriter & state,Bit8u * base) {
+	if (base>=vga.mem.linear && base<vga.mem.linear+vga.vmemsize) {
+		state.WriteB(1);
+		state.WriteD((Bit32u)(base-vga.mem.linear));
+	} else if (base) {
+		state.WriteB(0);
+		state.WriteD((Bit32u)(base-MemBase));
+	} else {
+		state.WriteB(2);
+		state.WriteD(0);
+	}
+}
+
+static Bit8u * VGA_LoadTandyBase(SaveStateReader & state) {
+	Bit8u where=state.ReadB();
+	Bit32u offset=state.ReadD();
+	if (where==1) return vga.mem.linear+(offset & (vga.vmemsize-1));
+	if (where==0 && offset<MEM_TotalPages()*MEM_PAGESIZE) return MemBase+offset;
+	return 0;
+}
+
+static void VGA_SaveState(SaveStateWriter & state) {
+	state.WriteD(vga.vmemsize);
+	state.WriteD((Bit32u)vga.mode);
+	state.WriteB(vga.misc_output);
+	state.WriteBlock(&vga.config,sizeof(vga.config));
+	state.WriteBlock(&vga.internal,sizeof(vga.internal));
+	state.WriteBlock(&vga.seq,sizeof(vga.seq));
+	state.WriteBlock(&vga.attr,sizeof(vga.attr));
+	state.WriteBlock(&vga.crtc,sizeof(vga.crtc));
+	state.WriteBlock(&vga.gfx,sizeof(vga.gfx));
+	state.WriteBlock(&vga.dac,sizeof(vga.dac));
+	state.WriteBlock(&vga.latch,sizeof(vga.latch));
+	state.WriteBlock(&vga.s3,sizeof(vga.s3));
+	state.WriteBlock(&vga.svga,sizeof(vga.svga));
+	state.WriteBlock(&vga.herc,sizeof(vga.herc));
+	state.WriteBlock(&vga.other,sizeof(vga.other));
+	state.WriteBlock(&vga.tandy,sizeof(vga.tandy));
+	VGA_SaveTandyBase(state,vga.tandy.draw_base);
+	VGA_SaveTandyBase(state,vga.tandy.mem_base);
+
+	state.WriteBytes(vga.draw.font,sizeof(vga.draw.font));
+	state.WriteD((Bit32u)(vga.draw.font_tables[0]-vga.draw.font));
+	state.WriteD((Bit32u)(vga.draw.font_tables[1]-vga.draw.font));
+	state.WriteD((Bit32u)vga.draw.blinking);
+	state.WriteBlock(&vga.draw.cursor,sizeof(vga.draw.cursor));
+
+	state.WriteBytes(vga.mem.linear,vga.vmemsize);
+	state.WriteBytes(vga.fastmem,vga.vmemsize<<1);
+}
+
+static bool VGA_LoadState(SaveStateReader & state) {
+	if (state.ReadD()!=vga.vmemsize) {
+		LOG_MSG("SAVESTATE:Video memory size does not match");
+		return false;
+	}
+	VGAModes mode=(VGAModes)state.ReadD();
+	Bit8u misc_output=state.ReadB();
+	state.ReadBlock(&vga.config,sizeof(vga.config));
+	state.ReadBlock(&vga.internal,sizeof(vga.internal));
+	state.ReadBlock(&vga.seq,sizeof(vga.seq));
+	state.ReadBlock(&vga.attr,sizeof(vga.attr));
+	state.ReadBlock(&vga.crtc,sizeof(vga.crtc));
+	state.ReadBlock(&vga.gfx,sizeof(vga.gfx));
+	state.ReadBlock(&vga.dac,sizeof(vga.dac));
+	state.ReadBlock(&vga.latch,sizeof(vga.latch));
+	state.ReadBlock(&vga.s3,sizeof(vga.s3));
+	state.ReadBlock(&vga.svga,sizeof(vga.svga));
+	state.ReadBlock(&vga.herc,sizeof(vga.herc));
+	state.ReadBlock(&vga.other,sizeof(vga.other));
+	state.ReadBlock(&vga.tandy,sizeof(vga.tandy));
+	Bit8u * draw_base=VGA_LoadTandyBase(state);
+	Bit8u * mem_base=VGA_LoadTandyBase(state);
+
+	state.ReadBytes(vga.draw.font,sizeof(vga.draw.font));
+	Bit32u font_table0=state.ReadD();
+	Bit32u font_table1=state.ReadD();
+	Bit32u blinking=state.ReadD();
+	state.ReadBlock(&vga.draw.cursor,sizeof(vga.draw.cursor));
+
+	state.ReadBytes(vga.mem.linear,vga.vmemsize);
+	state.ReadBytes(vga.fastmem,vga.vmemsize<<1);
+	if (state.Failed()) return false;
+	if (state.Checking()) return true;
+
+	vga.mode=mode;
+	vga.misc_output=misc_output;
+	vga.tandy.draw_base=draw_base;
+	vga.tandy.mem_base=mem_base;
+	vga.draw.font_tables[0]=vga.draw.font+(font_table0 % sizeof(vga.draw.font));
+	vga.draw.font_tables[1]=vga.draw.font+(font_table1 % sizeof(vga.draw.font));
+	vga.draw.blinking=blinking;
+
+	/* Rebuild everything derived from the registers. The timings and window
+	   size are invalidated so that drawing restarts from the top of a frame. */
+	VGA_SetupHandlers();
+	VGA_DACSetEntirePalette();
+	PIC_RemoveEvents(VGA_SetupDrawing);
+	vga.draw.resizing=false;
+	vga.draw.delay.vtotal=0;
+	vga.draw.width=0;
+	VGA_SetupDrawing(0);
+	return true;
+}
+//--End of modifications
+
 void VGA_Init(Section* sec) {
 //	Section_prop * section=static_cast<Section_prop *>(sec);
 	vga.draw.resizing=false;
@@ -188,6 +300,10 @@ void VGA_Init(Section* sec) {
 	VGA_SetupXGA();
 	VGA_SetClock(0,CLK_25);
 	VGA_SetClock(1,CLK_28);
+	//--Added 2026-10-19 to save and load the video adapter state
+	SAVESTATE_AddHandler("VGA",VGA_SaveState,VGA_LoadState);
+	VGA_AddStateEvents();
+	//--End of modifications
 /* Generate tables */
 	VGA_SetCGA2Table(0,1);
 	VGA_SetCGA4Table(0,1,2,3);
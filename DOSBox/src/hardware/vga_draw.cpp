@@ -27,6 +27,16 @@
 #include "../gui/render_scalers.h"
 #include "vga.h"
 #include "pic.h"
+//--Added 2026-10-19 for the SSE2 line drawers and their benchmark
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "timer.h"
+#include "benchmark.h"
+//--End of modifications
+//--Added 2026-10-19 to measure where the time of each frame goes
+#include "profile.h"
+//--End of modifications
 
 //--Added 2011-04-18 by Alun Bestor to fix endianness issues in Tandy/CGA line-printing
 #import <CoreFoundation/CFByteOrder.h>
@@ -160,6 +170,8 @@ static Bit8u * VGA_Draw_4BPP_Line_Double(Bitu vidstart, Bitu line) {
 }
 
 #ifdef VGA_KEEP_CHANGES
+//--Disabled 2026-10-19: unused since VGA_ChangesStart no longer switches to drawing from the changes
+/*
 static Bit8u * VGA_Draw_Changes_Line(Bitu vidstart, Bitu line) {
 	Bitu checkMask = vga.changes.checkMask;
 	Bit8u *map = vga.changes.map;
@@ -184,9 +196,83 @@ static Bit8u * VGA_Draw_Changes_Line(Bitu vidstart, Bitu line) {
 //	return TempLine;
 	return 0;
 }
+*/
+//--End of modifications
+
+//--Added 2026-10-19 for dirty line tracking: the modes whose video memory is only ever
+//written through handlers that mark the change map, with the line drawn from the same
+//address space the handlers mark. The rest are drawn in full every frame as before.
+static bool VGA_ChangesTracked(void) {
+	if (!IS_EGAVGA_ARCH) return false;
+	switch (vga.mode) {
+	case M_EGA:
+	case M_LIN4:
+		return vga.draw.linear_base == vga.fastmem;
+	case M_VGA:
+		// Chained writes are marked by their offset in the pixel buffer,
+		// unchained writes by their offset in the interleaved planes
+		if (vga.config.chained)
+			return vga.config.compatible_chain4 && vga.draw.linear_base == vga.fastmem;
+		return vga.draw.linear_base == vga.mem.linear;
+	case M_TEXT:
+	case M_CGA2:
+	case M_CGA4:
+		return vga.tandy.draw_base == vga.mem.linear;
+	default:
+		return false;
+	}
+}
+
+/* Whether anything a line is drawn from was written since the previous frame.
+   A line that wraps around the end of memory is always taken to have changed. */
+static bool VGA_ChangesLine(Bitu vidstart, Bitu line) {
+	Bitu start, span;
+	switch (vga.mode) {
+	case M_CGA2:
+	case M_CGA4: {
+		Bitu mask = (vga.mode == M_CGA2) ? (8 * 1024 - 1) : vga.tandy.addr_mask;
+		span = vga.draw.blocks;
+		start = vidstart & mask;
+		if (span > mask - start) return true;
+		start += (line & vga.tandy.line_mask) << vga.tandy.line_shift;
+		break;
+	}
+	case M_TEXT:
+		// The 9 dot wide line reads one more character than it draws
+		span = (vga.draw.blocks + 1) * 2;
+		start = vidstart & vga.draw.linear_mask;
+		if (span > vga.draw.linear_mask - start) return true;
+		break;
+	default:
+		span = vga.draw.line_length;
+		start = vidstart & vga.draw.linear_mask;
+		if (span > vga.draw.linear_mask - start) return true;
+		break;
+	}
+	Bitu first = start >> VGA_CHANGE_SHIFT;
+	Bitu last = (start + span - 1) >> VGA_CHANGE_SHIFT;
+	if (last >= vga.changes.mapSize) return true;
+	const Bit8u checkMask = vga.changes.checkMask;
+	const Bit8u *map = vga.changes.map;
+	for (; first <= last; first++) {
+		if (map[first] & checkMask) return true;
+	}
+	return false;
+}
+//--End of modifications
 
 #endif
 
+//--Added 2026-10-19 for dirty line tracking: lines with nothing changed are passed on
+//as 0, which the renderer takes to mean the line is the same as the previous frame.
+static INLINE Bit8u * VGA_DrawChangedLine(Bitu vidstart, Bitu line) {
+#ifdef VGA_KEEP_CHANGES
+	if (vga.changes.skip && !VGA_ChangesLine(vidstart, line)) return 0;
+#endif
+	return VGA_DrawLine(vidstart, line);
+}
+//--End of modifications
+
 static Bit8u * VGA_Draw_Linear_Line(Bitu vidstart, Bitu /*line*/) {
 // There is guaranteed extra memory past the wrap boundary. So, instead of using temporary
 // storage just copy appropriate chunk from the beginning to the wrap boundary when needed.
@@ -622,6 +708,200 @@ skip_cursor:
 	return TempLine;
 }
 
+//--Added 2026-10-19: SSE2 versions of the line drawers that expand packed pixels and font
+//bitmaps. Each draws exactly what the function it is named after draws; the benchmark at the
+//end of this file checks that. Lines that wrap around the end of their memory are left to
+//the original functions.
+#if defined(__SSE2__)
+/* Splits 16 bytes into their nibbles, high nibble first */
+static INLINE void VGA_SplitNibbles(const Bit8u *src, __m128i &first, __m128i &second) {
+	const __m128i low = _mm_set1_epi8(0x0f);
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+	const __m128i lo = _mm_and_si128(v, low);
+	first = _mm_unpacklo_epi8(hi, lo);
+	second = _mm_unpackhi_epi8(hi, lo);
+}
+
+static Bit8u * VGA_Draw_4BPP_Line_SSE2(Bitu vidstart, Bitu line) {
+	const Bitu mask = vga.tandy.addr_mask;
+	const Bitu bytes = vga.draw.blocks * 2;
+	if (((vidstart + bytes - 1) & mask) != (vidstart & mask) + bytes - 1)
+		return VGA_Draw_4BPP_Line(vidstart, line);
+	const Bit8u *src = vga.tandy.draw_base + ((line & vga.tandy.line_mask) << vga.tandy.line_shift) + (vidstart & mask);
+	Bit8u *draw = TempLine;
+	Bitu x = 0;
+	for (; x + 16 <= bytes; x += 16, src += 16, draw += 32) {
+		__m128i first, second;
+		VGA_SplitNibbles(src, first, second);
+		_mm_storeu_si128((__m128i *)draw, first);
+		_mm_storeu_si128((__m128i *)(draw + 16), second);
+	}
+	for (; x < bytes; x++, src++) {
+		*draw++ = *src >> 4;
+		*draw++ = *src & 0x0f;
+	}
+	return TempLine;
+}
+
+static Bit8u * VGA_Draw_4BPP_Line_Double_SSE2(Bitu vidstart, Bitu line) {
+	const Bitu mask = vga.tandy.addr_mask;
+	const Bitu bytes = vga.draw.blocks;
+	if (((vidstart + bytes - 1) & mask) != (vidstart & mask) + bytes - 1)
+		return VGA_Draw_4BPP_Line_Double(vidstart, line);
+	const Bit8u *src = vga.tandy.draw_base + ((line & vga.tandy.line_mask) << vga.tandy.line_shift) + (vidstart & mask);
+	Bit8u *draw = TempLine;
+	Bitu x = 0;
+	for (; x + 16 <= bytes; x += 16, src += 16, draw += 64) {
+		__m128i first, second;
+		VGA_SplitNibbles(src, first, second);
+		_mm_storeu_si128((__m128i *)draw, _mm_unpacklo_epi8(first, first));
+		_mm_storeu_si128((__m128i *)(draw + 16), _mm_unpackhi_epi8(first, first));
+		_mm_storeu_si128((__m128i *)(draw + 32), _mm_unpacklo_epi8(second, second));
+		_mm_storeu_si128((__m128i *)(draw + 48), _mm_unpackhi_epi8(second, second));
+	}
+	for (; x < bytes; x++, src++) {
+		draw[0] = draw[1] = *src >> 4;
+		draw[2] = draw[3] = *src & 0x0f;
+		draw += 4;
+	}
+	return TempLine;
+}
+
+/* The bit for each pixel of a glyph row, leftmost first */
+#define VGA_GLYPH_BITS8 _mm_set_epi8(1,2,4,8,16,32,64,-128,1,2,4,8,16,32,64,-128)
+#define VGA_GLYPH_BITS16 _mm_set_epi16(1,2,4,8,16,32,64,128)
+
+static Bit8u * VGA_TEXT_Draw_Line_SSE2(Bitu vidstart, Bitu line) {
+	Bits font_addr;
+	Bit32u * draw;
+	const Bit8u* vidmem = VGA_Text_Memwrap(vidstart);
+	const __m128i bits = VGA_GLYPH_BITS8;
+	Bitu cx=0;
+	/* Two characters at a time, one in each half */
+	for (;cx+2<=vga.draw.blocks;cx+=2) {
+		Bitu chr0=vidmem[cx*2];
+		Bitu col0=vidmem[cx*2+1];
+		Bitu chr1=vidmem[cx*2+2];
+		Bitu col1=vidmem[cx*2+3];
+		Bitu font0=vga.draw.font_tables[(col0 >> 3)&1][chr0*32+line] & FontMask[col0 >> 7];
+		Bitu font1=vga.draw.font_tables[(col1 >> 3)&1][chr1*32+line] & FontMask[col1 >> 7];
+		__m128i font=_mm_cvtsi32_si128((int)(font0 | (font1 << 8)));
+		font=_mm_unpacklo_epi8(font,font);
+		font=_mm_unpacklo_epi16(font,font);
+		font=_mm_unpacklo_epi32(font,font);
+		__m128i fg=_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)TXT_FG_Table[col0&0xf]),_mm_cvtsi32_si128((int)TXT_FG_Table[col1&0xf]));
+		__m128i bg=_mm_unpacklo_epi32(_mm_cvtsi32_si128((int)TXT_BG_Table[col0>>4]),_mm_cvtsi32_si128((int)TXT_BG_Table[col1>>4]));
+		fg=_mm_unpacklo_epi32(fg,fg);
+		bg=_mm_unpacklo_epi32(bg,bg);
+		const __m128i mask=_mm_cmpeq_epi8(_mm_and_si128(font,bits),bits);
+		_mm_storeu_si128((__m128i *)&TempLine[cx*8],_mm_or_si128(_mm_and_si128(mask,fg),_mm_andnot_si128(mask,bg)));
+	}
+	draw=(Bit32u *)&TempLine[cx*8];
+	for (;cx<vga.draw.blocks;cx++) {
+		Bitu chr=vidmem[cx*2];
+		Bitu col=vidmem[cx*2+1];
+		Bitu font=vga.draw.font_tables[(col >> 3)&1][chr*32+line];
+		Bit32u mask1=TXT_Font_Table[font>>4] & FontMask[col >> 7];
+		Bit32u mask2=TXT_Font_Table[font&0xf] & FontMask[col >> 7];
+		Bit32u fg=TXT_FG_Table[col&0xf];
+		Bit32u bg=TXT_BG_Table[col>>4];
+		*draw++=(fg&mask1) | (bg&~mask1);
+		*draw++=(fg&mask2) | (bg&~mask2);
+	}
+	if (!vga.draw.cursor.enabled || !(vga.draw.cursor.count&0x8)) goto skip_cursor;
+	font_addr = (vga.draw.cursor.address-vidstart) >> 1;
+	if (font_addr>=0 && font_addr<(Bits)vga.draw.blocks) {
+		if (line<vga.draw.cursor.sline) goto skip_cursor;
+		if (line>vga.draw.cursor.eline) goto skip_cursor;
+		draw=(Bit32u *)&TempLine[font_addr*8];
+		Bit32u att=TXT_FG_Table[vga.tandy.draw_base[vga.draw.cursor.address+1]&0xf];
+		*draw++=att;*draw++=att;
+	}
+skip_cursor:
+	return TempLine;
+}
+
+/* The 8 pixels of a glyph row in 16 bit colour */
+static INLINE __m128i VGA_Glyph16(Bitu font, Bit16u fg, Bit16u bg) {
+	const __m128i bits = VGA_GLYPH_BITS16;
+	const __m128i mask = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16((short)font), bits), bits);
+	return _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi16((short)fg)), _mm_andnot_si128(mask, _mm_set1_epi16((short)bg)));
+}
+
+static Bit8u * VGA_TEXT_Xlat16_Draw_Line_SSE2(Bitu vidstart, Bitu line) {
+	Bits font_addr;
+	Bit16u * draw;
+	const Bit8u* vidmem = VGA_Text_Memwrap(vidstart);
+	for (Bitu cx=0;cx<vga.draw.blocks;cx++) {
+		Bitu chr=vidmem[cx*2];
+		Bitu col=vidmem[cx*2+1];
+		Bitu font=vga.draw.font_tables[(col >> 3)&1][chr*32+line] & FontMask[col >> 7];
+		Bit16u fg=vga.dac.xlat16[TXT_FG_Table[col&0xf]&0xff];
+		Bit16u bg=vga.dac.xlat16[TXT_BG_Table[col>>4]&0xff];
+		_mm_storeu_si128((__m128i *)&TempLine[cx*16],VGA_Glyph16(font,fg,bg));
+	}
+	if (!vga.draw.cursor.enabled || !(vga.draw.cursor.count&0x8)) goto skip_cursor;
+	font_addr = (vga.draw.cursor.address-vidstart) >> 1;
+	if (font_addr>=0 && font_addr<(Bits)vga.draw.blocks) {
+		if (line<vga.draw.cursor.sline) goto skip_cursor;
+		if (line>vga.draw.cursor.eline) goto skip_cursor;
+		draw=(Bit16u *)&TempLine[font_addr*16];
+		Bit8u att=(Bit8u)(TXT_FG_Table[vga.tandy.draw_base[vga.draw.cursor.address+1]&0xf]&0xff);
+		for(int i = 0; i < 8; i++) {
+			*draw++ = vga.dac.xlat16[att];
+		}
+	}
+skip_cursor:
+	return TempLine;
+}
+
+static Bit8u * VGA_TEXT_Xlat16_Draw_Line_9_SSE2(Bitu vidstart, Bitu line) {
+	Bit8u pel_pan=(Bit8u)vga.draw.panning;
+	if ((vga.attr.mode_control&0x20) && (vga.draw.lines_done>=vga.draw.split_line)) pel_pan=0;
+	/* A panned line takes glyph bits from two characters for every cell */
+	if (pel_pan) return VGA_TEXT_Xlat16_Draw_Line_9(vidstart, line);
+	Bits font_addr;
+	Bit16u * draw;
+	bool underline=(Bitu)(vga.crtc.underline_location&0x1f)==line;
+	bool line_graphics=(vga.attr.mode_control&0x04)!=0;
+	const Bit8u* vidmem = VGA_Text_Memwrap(vidstart);
+	for (Bitu cx=0;cx<vga.draw.blocks;cx++) {
+		Bit8u chr=vidmem[cx*2];
+		Bit8u col=vidmem[cx*2+1];
+		bool underlined=underline && ((col&0x07) == 0x01);
+		Bit8u font=underlined ? 0xff : vga.draw.font_tables[(col >> 3)&1][chr*32+line];
+		if (FontMask[col>>7]==0) font=0;
+		Bit16u fg=vga.dac.xlat16[col&0xf];
+		Bit16u bg=vga.dac.xlat16[TXT_BG_Table[col>>4]&0xff];
+		draw=(Bit16u *)&TempLine[cx*18];
+		_mm_storeu_si128((__m128i *)draw,VGA_Glyph16(font,fg,bg));
+		/* The ninth column repeats the eighth for line graphics, or is background */
+		draw[8]=(line_graphics && ((chr<0xc0) || (chr>0xdf)) && !underlined) ? bg : ((font&0x01) ? fg : bg);
+	}
+	if (!vga.draw.cursor.enabled || !(vga.draw.cursor.count&0x8)) goto skip_cursor;
+	font_addr = (vga.draw.cursor.address-vidstart) >> 1;
+	if (font_addr>=0 && font_addr<(Bits)vga.draw.blocks) {
+		if (line<vga.draw.cursor.sline) goto skip_cursor;
+		if (line>vga.draw.cursor.eline) goto skip_cursor;
+		draw=(Bit16u*)&TempLine[font_addr*18];
+		Bit8u fg=vga.tandy.draw_base[vga.draw.cursor.address+1]&0xf;
+		for(int i = 0; i < 8; i++) {
+			*draw++ = vga.dac.xlat16[fg];
+		}
+	}
+skip_cursor:
+	return TempLine;
+}
+
+#define VGA_SIMD(_FUNC) _FUNC##_SSE2
+#else
+#define VGA_SIMD(_FUNC) _FUNC
+#endif
+//--End of modifications
+
+//--Disabled 2026-10-19: the map is now cleared in VGA_ChangesStart
+/*
 #ifdef VGA_KEEP_CHANGES
 static INLINE void VGA_ChangesEnd(void ) {
 	if ( vga.changes.active ) {
@@ -638,6 +918,8 @@ static INLINE void VGA_ChangesEnd(void ) {
 	}
 }
 #endif
+*/
+//--End of modifications
 
 
 static void VGA_ProcessSplit() {
@@ -654,13 +936,28 @@ static void VGA_ProcessSplit() {
 }
 
 static void VGA_DrawSingleLine(Bitu /*blah*/) {
+	//--Added 2026-10-19 to measure where the time of each frame goes
+	ProfileScope scope(PROFILE_VGA);
+	//--End of modifications
 	if (GCC_UNLIKELY(vga.attr.disabled)) {
 		// draw blanked line (DoWhackaDo, Alien Carnage, TV sports Football)
 		memset(TempLine, 0, sizeof(TempLine));
 		RENDER_DrawLine(TempLine);
+		//--Added 2026-10-19 for dirty line tracking: the blanked lines are nowhere in the map
+#ifdef VGA_KEEP_CHANGES
+		vga.changes.refresh = true;
+#endif
+		//--End of modifications
 	} else {
-		Bit8u * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );	
+		//--Modified 2026-10-19 for dirty line tracking
+		//Bit8u * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );	
+		Bit8u * data=VGA_DrawChangedLine( vga.draw.address, vga.draw.address_line );
+		//--End of modifications
+		//--Modified 2026-10-19 to measure where the time of each frame goes
+		//RENDER_DrawLine(data);
+		ProfileScope render_scope(PROFILE_RENDER);
 		RENDER_DrawLine(data);
+		//--End of modifications
 	}
 
 	vga.draw.address_line++;
@@ -676,9 +973,21 @@ static void VGA_DrawSingleLine(Bitu /*blah*/) {
 }
 
 static void VGA_DrawPart(Bitu lines) {
+	//--Added 2026-10-19 to measure where the time of each frame goes
+	ProfileScope scope(PROFILE_VGA);
+	//--End of modifications
 	while (lines--) {
-		Bit8u * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );
-		RENDER_DrawLine(data);
+		//--Modified 2026-10-19 for dirty line tracking
+		//Bit8u * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );
+		Bit8u * data=VGA_DrawChangedLine( vga.draw.address, vga.draw.address_line );
+		//--End of modifications
+		//--Modified 2026-10-19 to measure where the time of each frame goes
+		//RENDER_DrawLine(data);
+		{
+			ProfileScope render_scope(PROFILE_RENDER);
+			RENDER_DrawLine(data);
+		}
+		//--End of modifications
 		vga.draw.address_line++;
 		if (vga.draw.address_line>=vga.draw.address_line_total) {
 			vga.draw.address_line=0;
@@ -686,22 +995,34 @@ static void VGA_DrawPart(Bitu lines) {
 		}
 		vga.draw.lines_done++;
 		if (vga.draw.split_line==vga.draw.lines_done) {
+			//--Disabled 2026-10-19: the map is now cleared in VGA_ChangesStart
+/*
 #ifdef VGA_KEEP_CHANGES
 			VGA_ChangesEnd( );
 #endif
+*/
+			//--End of modifications
 			VGA_ProcessSplit();
+			//--Disabled 2026-10-19: the map is now cleared in VGA_ChangesStart
+/*
 #ifdef VGA_KEEP_CHANGES
 			vga.changes.start = vga.draw.address >> VGA_CHANGE_SHIFT;
 #endif
+*/
+			//--End of modifications
 		}
 	}
 	if (--vga.draw.parts_left) {
 		PIC_AddEvent(VGA_DrawPart,(float)vga.draw.delay.parts,
 			 (vga.draw.parts_left!=1) ? vga.draw.parts_lines  : (vga.draw.lines_total - vga.draw.lines_done));
 	} else {
+		//--Disabled 2026-10-19: the map is now cleared in VGA_ChangesStart
+/*
 #ifdef VGA_KEEP_CHANGES
 		VGA_ChangesEnd();
 #endif
+*/
+		//--End of modifications
 		RENDER_EndUpdate(false);
 	}
 }
@@ -719,9 +1040,18 @@ void VGA_SetBlinking(Bitu enabled) {
 		vga.tandy.mode_control&=~0x20;
 	}
 	for (Bitu i=0;i<8;i++) TXT_BG_Table[i+8]=(b+i) | ((b+i) << 8)| ((b+i) <<16) | ((b+i) << 24);
+	//--Added 2026-10-19 for dirty line tracking
+#ifdef VGA_KEEP_CHANGES
+	vga.changes.refresh = true;
+#endif
+	//--End of modifications
 }
 
 #ifdef VGA_KEEP_CHANGES
+//--Modified 2026-10-19 for dirty line tracking: rather than switching to drawing straight
+//from the changes in linear modes, decide for any tracked mode whether unchanged lines can
+//be skipped this frame.
+/*
 static void INLINE VGA_ChangesStart( void ) {
 	vga.changes.start = vga.draw.address >> VGA_CHANGE_SHIFT;
 	vga.changes.last = vga.changes.start;
@@ -742,6 +1072,79 @@ static void INLINE VGA_ChangesStart( void ) {
 	vga.changes.frame++;
 	vga.changes.writeMask = 1 << (vga.changes.frame & 7);
 }
+*/
+
+/* Everything besides video memory that the lines of a frame are drawn from. If any of it
+   differs from the previous frame, every line is drawn again. */
+typedef struct {
+	Bitu address, address_add, address_line, address_line_total, split_line;
+	Bitu panning, bytes_skip, blocks, lines_total, line_length, linear_mask;
+	Bit8u *linear_base, *draw_base, *font_tables[2];
+	Bitu addr_mask, line_mask, line_shift;
+	Bitu mode, mode_control, disabled, blinking, font_mask;
+	Bitu cursor_shown, cursor_address, cursor_sline, cursor_eline;
+} VGA_ChangesState;
+
+static VGA_ChangesState VGA_ChangesLast;
+
+static void INLINE VGA_ChangesStart( void ) {
+	VGA_ChangesState state;
+	memset( &state, 0, sizeof( state ));
+	state.address = vga.draw.address;
+	state.address_add = vga.draw.address_add;
+	state.address_line = vga.draw.address_line;
+	state.address_line_total = vga.draw.address_line_total;
+	state.split_line = vga.draw.split_line;
+	state.panning = vga.draw.panning;
+	state.bytes_skip = vga.draw.bytes_skip;
+	state.blocks = vga.draw.blocks;
+	state.lines_total = vga.draw.lines_total;
+	state.line_length = vga.draw.line_length;
+	state.linear_mask = vga.draw.linear_mask;
+	state.linear_base = vga.draw.linear_base;
+	state.draw_base = vga.tandy.draw_base;
+	state.font_tables[0] = vga.draw.font_tables[0];
+	state.font_tables[1] = vga.draw.font_tables[1];
+	state.addr_mask = vga.tandy.addr_mask;
+	state.line_mask = vga.tandy.line_mask;
+	state.line_shift = vga.tandy.line_shift;
+	state.mode = vga.mode;
+	state.mode_control = vga.attr.mode_control;
+	state.disabled = vga.attr.disabled;
+	state.blinking = vga.draw.blinking;
+	state.font_mask = FontMask[1];
+	state.cursor_shown = vga.draw.cursor.enabled && (vga.draw.cursor.count & 0x8);
+	if (state.cursor_shown) {
+		state.cursor_address = vga.draw.cursor.address;
+		state.cursor_sline = vga.draw.cursor.sline;
+		state.cursor_eline = vga.draw.cursor.eline;
+	}
+	bool same = !memcmp( &state, &VGA_ChangesLast, sizeof( state ));
+	VGA_ChangesLast = state;
+
+	// A frame that was cut short has left lines behind that never got checked
+	if ((vga.draw.mode == PART) ? (vga.draw.parts_left != 0) : (vga.draw.lines_done < vga.draw.lines_total))
+		vga.changes.refresh = true;
+
+	vga.changes.skip = same && !vga.changes.refresh && !render.fullFrame && VGA_ChangesTracked();
+	vga.changes.refresh = false;
+
+	/* Writes are marked with one of two bits, which swap every frame. A frame checks both:
+	   one holds the writes since the previous frame started, the other the writes made while
+	   this one is being drawn. The bit about to be reused has been checked by both of the
+	   frames it could matter to, so it's cleared before taking it. */
+	vga.changes.frame++;
+	vga.changes.writeMask = 1 << (vga.changes.frame & 1);
+	vga.changes.checkMask = 3;
+	Bit32u clearMask = ~(0x01010101 * vga.changes.writeMask);
+	Bit32u *clear = (Bit32u *)vga.changes.map;
+	for (Bitu total = vga.changes.mapSize >> 2; total; total--) {
+		clear[0] &= clearMask;
+		clear++;
+	}
+	vga.changes.active = true;
+}
+//--End of modifications
 #endif
 
 static void VGA_VertInterrupt(Bitu /*val*/) {
@@ -766,6 +1169,9 @@ static void VGA_PanningLatch(Bitu /*val*/) {
 }
 
 static void VGA_VerticalTimer(Bitu /*val*/) {
+	//--Added 2026-10-19 to measure where the time of each frame goes
+	PROFILE_Frame();
+	//--End of modifications
 	vga.draw.delay.framestart = PIC_FullIndex();
 	PIC_AddEvent( VGA_VerticalTimer, (float)vga.draw.delay.vtotal );
 	
@@ -813,9 +1219,13 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 	// go figure...
 	if (machine==MCH_EGA) vga.draw.split_line*=2;
 //	if (machine==MCH_EGA) vga.draw.split_line = ((((vga.config.line_compare&0x5ff)+1)*2-1)/vga.draw.lines_scaled);
+	//--Disabled 2026-10-19: VGA_ChangesStart runs every frame now
+/*
 #ifdef VGA_KEEP_CHANGES
 	bool startaddr_changed=false;
 #endif
+*/
+	//--End of modifications
 	switch (vga.mode) {
 	case M_EGA:
 		if (!(vga.crtc.mode_control&0x1)) vga.draw.linear_mask &= ~0x10000;
@@ -825,9 +1235,13 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 		vga.draw.address += vga.draw.bytes_skip;
 		vga.draw.address *= vga.draw.byte_panning_shift;
 		vga.draw.address += vga.draw.panning;
+		//--Disabled 2026-10-19: VGA_ChangesStart runs every frame now
+/*
 #ifdef VGA_KEEP_CHANGES
 		startaddr_changed=true;
 #endif
+*/
+		//--End of modifications
 		break;
 	case M_VGA:
 		if(vga.config.compatible_chain4 && (vga.crtc.underline_location & 0x40)) {
@@ -845,9 +1259,13 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 		vga.draw.address += vga.draw.bytes_skip;
 		vga.draw.address *= vga.draw.byte_panning_shift;
 		vga.draw.address += vga.draw.panning;
+		//--Disabled 2026-10-19: VGA_ChangesStart runs every frame now
+/*
 #ifdef VGA_KEEP_CHANGES
 		startaddr_changed=true;
 #endif
+*/
+		//--End of modifications
 		break;
 	case M_TEXT:
 		vga.draw.byte_panning_shift = 2;
@@ -879,7 +1297,10 @@ static void VGA_VerticalTimer(Bitu /*val*/) {
 	}
 	if (GCC_UNLIKELY(vga.draw.split_line==0)) VGA_ProcessSplit();
 #ifdef VGA_KEEP_CHANGES
-	if (startaddr_changed) VGA_ChangesStart();
+	//--Modified 2026-10-19 for dirty line tracking: every mode goes through the change map now
+	//if (startaddr_changed) VGA_ChangesStart();
+	VGA_ChangesStart();
+	//--End of modifications
 #endif
 
 	// check if some lines at the top off the screen are blanked
@@ -1342,15 +1763,26 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 		doublewidth=(vga.seq.clocking_mode & 0x8) > 0;
 		if ((IS_VGA_ARCH) && (svgaCard==SVGA_None) && !(vga.seq.clocking_mode&0x01)) {
 			width*=9;				/* 9 bit wide text font */
-			VGA_DrawLine=VGA_TEXT_Xlat16_Draw_Line_9;
+			//--Modified 2026-10-19 for the SSE2 line drawers
+			//VGA_DrawLine=VGA_TEXT_Xlat16_Draw_Line_9;
+			VGA_DrawLine=VGA_SIMD(VGA_TEXT_Xlat16_Draw_Line_9);
+			//--End of modifications
 			bpp=16;
 //			VGA_DrawLine=VGA_TEXT_Draw_Line_9;
 		} else {
 			width<<=3;				/* 8 bit wide text font */
 			if ((IS_VGA_ARCH) && (svgaCard==SVGA_None)) {
-				VGA_DrawLine=VGA_TEXT_Xlat16_Draw_Line;
+				//--Modified 2026-10-19 for the SSE2 line drawers
+				//VGA_DrawLine=VGA_TEXT_Xlat16_Draw_Line;
+				VGA_DrawLine=VGA_SIMD(VGA_TEXT_Xlat16_Draw_Line);
+				//--End of modifications
 				bpp=16;
-			} else VGA_DrawLine=VGA_TEXT_Draw_Line;
+			} else {
+				//--Modified 2026-10-19 for the SSE2 line drawers
+				//VGA_DrawLine=VGA_TEXT_Draw_Line;
+				VGA_DrawLine=VGA_SIMD(VGA_TEXT_Draw_Line);
+				//--End of modifications
+			}
 		}
 		break;
 	case M_HERC_GFX:
@@ -1393,11 +1825,17 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 				doublewidth = true;
 				width=vga.draw.blocks*2;
 			}
-			VGA_DrawLine=VGA_Draw_4BPP_Line;
+			//--Modified 2026-10-19 for the SSE2 line drawers
+			//VGA_DrawLine=VGA_Draw_4BPP_Line;
+			VGA_DrawLine=VGA_SIMD(VGA_Draw_4BPP_Line);
+			//--End of modifications
 		} else {
 			doublewidth=true;
 			width=vga.draw.blocks*4;
-			VGA_DrawLine=VGA_Draw_4BPP_Line_Double;
+			//--Modified 2026-10-19 for the SSE2 line drawers
+			//VGA_DrawLine=VGA_Draw_4BPP_Line_Double;
+			VGA_DrawLine=VGA_SIMD(VGA_Draw_4BPP_Line_Double);
+			//--End of modifications
 		}
 		break;
 	case M_TANDY_TEXT:
@@ -1406,7 +1844,10 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 		doubleheight=true;
 		vga.draw.blocks=width;
 		width<<=3;
-		VGA_DrawLine=VGA_TEXT_Draw_Line;
+		//--Modified 2026-10-19 for the SSE2 line drawers
+		//VGA_DrawLine=VGA_TEXT_Draw_Line;
+		VGA_DrawLine=VGA_SIMD(VGA_TEXT_Draw_Line);
+		//--End of modifications
 		break;
 	case M_HERC_TEXT:
 		aspect_ratio=1;
@@ -1444,6 +1885,9 @@ void VGA_SetupDrawing(Bitu /*val*/) {
 	vga.changes.active = false;
 	vga.changes.frame = 0;
 	vga.changes.writeMask = 1;
+	//--Added 2026-10-19 for dirty line tracking
+	vga.changes.refresh = true;
+	//--End of modifications
 #endif
     /* 
 	   Cheap hack to just make all > 640x480 modes have 4:3 aspect ratio
@@ -1508,4 +1952,123 @@ void VGA_KillDrawing(void) {
 	vga.draw.parts_left = 0;
 	vga.draw.lines_done = ~0;
 	RENDER_EndUpdate(true);
+	//--Added 2026-10-19 for dirty line tracking
+#ifdef VGA_KEEP_CHANGES
+	vga.changes.refresh = true;
+#endif
+	//--End of modifications
+}
+
+//--Added 2026-10-19: times the line drawers that have SSE2 versions against the originals
+//on random video memory and fonts, and checks that both draw exactly the same lines.
+bool VGA_BenchmarkDraw(char * report,Bitu size) {
+#if defined(__SSE2__)
+	static const struct {
+		const char * name;
+		VGA_Line_Handler plain, simd;
+		Bitu bytes;		/* Bytes of TempLine drawn per block */
+		bool text;
+	} drawers[] = {
+		{ "Tandy 16 colour",       VGA_Draw_4BPP_Line,          VGA_Draw_4BPP_Line_SSE2,          4,  false },
+		{ "Tandy 16 colour wide",  VGA_Draw_4BPP_Line_Double,   VGA_Draw_4BPP_Line_Double_SSE2,   4,  false },
+		{ "Text",                  VGA_TEXT_Draw_Line,          VGA_TEXT_Draw_Line_SSE2,          8,  true },
+		{ "Text 16 bit",           VGA_TEXT_Xlat16_Draw_Line,   VGA_TEXT_Xlat16_Draw_Line_SSE2,   16, true },
+		{ "Text 9 dot 16 bit",     VGA_TEXT_Xlat16_Draw_Line_9, VGA_TEXT_Xlat16_Draw_Line_9_SSE2, 18, true },
+	};
+	const Bitu blocks = 80;
+	const Bitu lines = 100000;
+
+	/* Everything the drawers read is pointed at scratch memory for the run, and put back after */
+	VGA_Draw draw_save = vga.draw;
+	VGA_TANDY tandy_save = vga.tandy;
+	Bit8u mode_control_save = vga.attr.mode_control;
+	Bit8u underline_save = vga.crtc.underline_location;
+	Bit8u * mem = new Bit8u[64*1024];
+	Bit8u * font = new Bit8u[2*8*1024];
+	Bit8u * line_plain = new Bit8u[sizeof(TempLine)];
+	Bit32u seed = 0x12345678;
+	for (Bitu i = 0; i < 64*1024; i++) {
+		seed = seed * 1664525 + 1013904223;
+		mem[i] = (Bit8u)(seed >> 24);
+	}
+	for (Bitu i = 0; i < 2*8*1024; i++) {
+		seed = seed * 1664525 + 1013904223;
+		font[i] = (Bit8u)(seed >> 24);
+	}
+	vga.tandy.draw_base = mem;
+	vga.tandy.addr_mask = 0x3fff;
+	vga.tandy.line_mask = 3;
+	vga.tandy.line_shift = 13;
+	vga.draw.font_tables[0] = font;
+	vga.draw.font_tables[1] = font + 8*1024;
+	vga.draw.blocks = blocks;
+	vga.draw.linear_mask = 0x7fff;
+	vga.draw.panning = 0;
+	vga.draw.split_line = ~0;
+	vga.draw.cursor.enabled = 1;
+	vga.draw.cursor.count = 8;
+	vga.draw.cursor.sline = 13;
+	vga.draw.cursor.eline = 14;
+	vga.draw.cursor.address = 0x1000;
+	vga.attr.mode_control = 0x04;
+	vga.crtc.underline_location = 15;
+
+	Bitu pos = snprintf(report,size,"VGA line drawers, %lu lines of %lu blocks each:\n",
+		(unsigned long)lines,(unsigned long)blocks);
+	bool identical = true;
+	for (Bitu d = 0; d < sizeof(drawers)/sizeof(drawers[0]); d++) {
+		Bitu bytes = blocks * drawers[d].bytes;
+		Bitu mismatches = 0;
+		/* Random start addresses, some of which wrap around the end of memory */
+		for (Bitu i = 0; i < 4096; i++) {
+			seed = seed * 1664525 + 1013904223;
+			Bitu vidstart = (seed >> 8) & (drawers[d].text ? 0x7ffe : 0x3fff);
+			Bitu line = drawers[d].text ? (i & 15) : (i & 3);
+			memcpy(line_plain, drawers[d].plain(vidstart, line), bytes);
+			if (memcmp(line_plain, drawers[d].simd(vidstart, line), bytes)) mismatches++;
+		}
+		Bit64u times[2];
+		for (Bitu which = 0; which < 2; which++) {
+			VGA_Line_Handler handler = which ? drawers[d].simd : drawers[d].plain;
+			Bit64u start = GetMicroTicks();
+			for (Bitu i = 0; i < lines; i++) {
+				Bitu vidstart = (i * (blocks * 2)) & 0x3fff;
+				handler(vidstart, i & 15);
+			}
+			times[which] = GetMicroTicks() - start;
+			if (!times[which]) times[which] = 1;
+		}
+		if (mismatches) identical = false;
+		if (pos < size) pos += snprintf(report + pos, size - pos,
+			"  %-22s %8.1f ms plain, %8.1f ms SSE2, speedup %5.2fx, output %s\n",
+			drawers[d].name, times[0]/1000.0, times[1]/1000.0, (double)times[0]/times[1],
+			mismatches ? "DIFFERENT" : "identical");
+	}
+
+	vga.draw = draw_save;
+	vga.tandy = tandy_save;
+	vga.attr.mode_control = mode_control_save;
+	vga.crtc.underline_location = underline_save;
+	delete[] mem;
+	delete[] font;
+	delete[] line_plain;
+	return identical;
+#else
+	snprintf(report,size,"This build has no SIMD line drawers.\n");
+	return false;
+#endif
+}
+//--End of modifications
+
+//--Added 2026-10-19 to save the drawing events along with the video state
+void VGA_AddStateEvents(void) {
+	PIC_AddStateEvent(VGA_SetupDrawing);
+	PIC_AddStateEvent(VGA_VerticalTimer);
+	PIC_AddStateEvent(VGA_VertInterrupt);
+	PIC_AddStateEvent(VGA_Other_VertInterrupt);
+	PIC_AddStateEvent(VGA_DisplayStartLatch);
+	PIC_AddStateEvent(VGA_PanningLatch);
+	PIC_AddStateEvent(VGA_DrawPart);
+	PIC_AddStateEvent(VGA_DrawSingleLine);
 }
+//--End of modifications
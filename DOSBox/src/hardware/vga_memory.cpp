@@ -48,6 +48,9 @@
 
 
 #ifdef VGA_KEEP_CHANGES
+//--Added 2026-10-19 for dirty line tracking: word and dword writes can end in the next
+//block of the map, so the handlers below mark the block of their last byte as well.
+//--End of modifications
 #define MEM_CHANGED( _MEM ) vga.changes.map[ (_MEM) >> VGA_CHANGE_SHIFT ] |= vga.changes.writeMask;
 //#define MEM_CHANGED( _MEM ) vga.changes.map[ (_MEM) >> VGA_CHANGE_SHIFT ] = 1;
 #else
@@ -224,6 +227,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr << 3);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+1) << 3 );
+		//--End of modifications
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 	}
@@ -232,6 +238,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr << 3);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+3) << 3 );
+		//--End of modifications
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 		writeHandler(addr+2,(Bit8u)(val >> 16));
@@ -308,6 +317,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
 		MEM_CHANGED( addr << 3);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+1) << 3 );
+		//--End of modifications
 		writeHandler<true>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<true>(addr+1,(Bit8u)(val >> 8));
 	}
@@ -316,6 +328,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
 		MEM_CHANGED( addr << 3);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+3) << 3 );
+		//--End of modifications
 		writeHandler<true>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<true>(addr+1,(Bit8u)(val >> 8));
 		writeHandler<true>(addr+2,(Bit8u)(val >> 16));
@@ -389,6 +404,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+1 );
+		//--End of modifications
 //		MEM_CHANGED( addr + 1);
 		if (GCC_UNLIKELY(addr & 1)) {
 			writeHandler<Bit8u>( addr+0, val >> 0 );
@@ -403,6 +421,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+3 );
+		//--End of modifications
 //		MEM_CHANGED( addr + 3);
 		if (GCC_UNLIKELY(addr & 3)) {
 			writeHandler<Bit8u>( addr+0, val >> 0 );
@@ -444,6 +465,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
 		MEM_CHANGED( addr << 2);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+1) << 2 );
+		//--End of modifications
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 	}
@@ -452,6 +476,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED2(addr);
 		MEM_CHANGED( addr << 2);
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+3) << 2 );
+		//--End of modifications
 		writeHandler(addr+0,(Bit8u)(val >> 0));
 		writeHandler(addr+1,(Bit8u)(val >> 8));
 		writeHandler(addr+2,(Bit8u)(val >> 16));
@@ -472,6 +499,11 @@ public:
 		addr = PAGING_GetPhysicalAddress(addr) & vgapages.mask;
 		if (vga.seq.map_mask & 0x4) {
 			vga.draw.font[addr]=(Bit8u)val;
+			//--Added 2026-10-19 for dirty line tracking: the font isn't in the map
+#ifdef VGA_KEEP_CHANGES
+			vga.changes.refresh = true;
+#endif
+			//--End of modifications
 		}
 	}
 };
@@ -526,6 +558,9 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+1 );
+		//--End of modifications
 		hostWrite<Bit16u>( &vga.mem.linear[addr], val );
 	}
 	void writed(PhysPt addr,Bitu val) {
@@ -533,10 +568,30 @@ public:
 		addr += vga.svga.bank_write_full;
 		addr = CHECKED(addr);
 		MEM_CHANGED( addr );	
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+3 );
+		//--End of modifications
 		hostWrite<Bit32u>( &vga.mem.linear[addr], val );
 	}
 };
 
+//--Added 2026-10-19 for dirty line tracking: the plain memory mapping of text and CGA modes.
+//Reads go straight to video memory as with VGA_Map_Handler, but writes come through here
+//so that they can be marked in the map.
+#ifdef VGA_KEEP_CHANGES
+class VGA_MapChanges_Handler : public VGA_Changes_Handler {
+public:
+	VGA_MapChanges_Handler() {
+		flags=PFLAG_READABLE|PFLAG_NOCODE;
+	}
+	HostPt GetHostReadPt(Bitu phys_page) {
+ 		phys_page-=vgapages.base;
+		return &vga.mem.linear[CHECKED3(vga.svga.bank_read_full+phys_page*4096)];
+	}
+};
+#endif
+//--End of modifications
+
 class VGA_LIN4_Handler : public VGA_UnchainedEGA_Handler {
 public:
 	VGA_LIN4_Handler() {
@@ -552,6 +607,9 @@ public:
 		addr = vga.svga.bank_write_full + (PAGING_GetPhysicalAddress(addr) & 0xffff);
 		addr = CHECKED4(addr);
 		MEM_CHANGED( addr << 3 );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+1) << 3 );
+		//--End of modifications
 		writeHandler<false>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<false>(addr+1,(Bit8u)(val >> 8));
 	}
@@ -559,6 +617,9 @@ public:
 		addr = vga.svga.bank_write_full + (PAGING_GetPhysicalAddress(addr) & 0xffff);
 		addr = CHECKED4(addr);
 		MEM_CHANGED( addr << 3 );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( (addr+3) << 3 );
+		//--End of modifications
 		writeHandler<false>(addr+0,(Bit8u)(val >> 0));
 		writeHandler<false>(addr+1,(Bit8u)(val >> 8));
 		writeHandler<false>(addr+2,(Bit8u)(val >> 16));
@@ -619,12 +680,18 @@ public:
 		addr = CHECKED(addr);
 		hostWrite<Bit16u>( &vga.mem.linear[addr], val );
 		MEM_CHANGED( addr );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+1 );
+		//--End of modifications
 	}
 	void writed(PhysPt addr,Bitu val) {
 		addr = PAGING_GetPhysicalAddress(addr) - vga.lfb.addr;
 		addr = CHECKED(addr);
 		hostWrite<Bit32u>( &vga.mem.linear[addr], val );
 		MEM_CHANGED( addr );
+		//--Added 2026-10-19 for dirty line tracking
+		MEM_CHANGED( addr+3 );
+		//--End of modifications
 	}
 };
 
@@ -730,6 +797,11 @@ public:
 static struct vg {
 	VGA_Map_Handler				map;
 	VGA_Changes_Handler			changes;
+	//--Added 2026-10-19 for dirty line tracking
+#ifdef VGA_KEEP_CHANGES
+	VGA_MapChanges_Handler		mapchanges;
+#endif
+	//--End of modifications
 	VGA_TEXT_PageHandler		text;
 	VGA_TANDY_PageHandler		tandy;
 	VGA_ChainedEGA_Handler		cega;
@@ -838,15 +910,25 @@ void VGA_SetupHandlers(void) {
 		else
 			newHandler = &vgaph.uega;
 		break;	
+	//--Modified 2026-10-19 for dirty line tracking: text and CGA writes have to be seen
 	case M_TEXT:
 		/* Check if we're not in odd/even mode */
+#ifdef VGA_KEEP_CHANGES
+		if (vga.gfx.miscellaneous & 0x2) newHandler = &vgaph.mapchanges;
+#else
 		if (vga.gfx.miscellaneous & 0x2) newHandler = &vgaph.map;
+#endif
 		else newHandler = &vgaph.text;
 		break;
 	case M_CGA4:
 	case M_CGA2:
+#ifdef VGA_KEEP_CHANGES
+		newHandler = &vgaph.mapchanges;
+#else
 		newHandler = &vgaph.map;
+#endif
 		break;
+	//--End of modifications
 	}
 	switch ((vga.gfx.miscellaneous >> 2) & 3) {
 	case 0:
@@ -931,9 +1013,17 @@ void VGA_SetupMemory(Section* sec) {
 
 #ifdef VGA_KEEP_CHANGES
 	memset( &vga.changes, 0, sizeof( vga.changes ));
-	int changesMapSize = (vga.vmemsize >> VGA_CHANGE_SHIFT) + 32;
+	//--Modified 2026-10-19: the planar modes mark changes by their offset in the pixel buffer
+	//int changesMapSize = (vga.vmemsize >> VGA_CHANGE_SHIFT) + 32;
+	int changesMapSize = ((vga.vmemsize << 1) >> VGA_CHANGE_SHIFT) + 32;
+	//--End of modifications
 	vga.changes.map = new Bit8u[changesMapSize];
 	memset(vga.changes.map, 0, changesMapSize);
+	//--Added 2026-10-19 for dirty line tracking
+	vga.changes.mapSize = changesMapSize;
+	vga.changes.writeMask = 1;
+	vga.changes.refresh = true;
+	//--End of modifications
 #endif
 	vga.svga.bank_read = vga.svga.bank_write = 0;
 	vga.svga.bank_read_full = vga.svga.bank_write_full = 0;
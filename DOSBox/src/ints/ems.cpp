@@ -30,6 +30,9 @@
 #include "inout.h"
 #include "dos_inc.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the EMS state
+#include "savestate.h"
+//--End of modifications
 #include "support.h"
 #include "cpu.h"
 
@@ -1368,6 +1371,28 @@ public:
 		}
 	}
 	
+	//--Added 2026-10-19 to save and load the EMS handles and mappings.
+	//The mappings themselves live in the paging tables, which are saved separately.
+	const char * GetStateName(void) { return "EMS"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(emm_handles,sizeof(emm_handles));
+		state.WriteBlock(emm_mappings,sizeof(emm_mappings));
+		state.WriteBlock(emm_segmentmappings,sizeof(emm_segmentmappings));
+		state.WriteBlock(&vcpi,sizeof(vcpi));
+		state.WriteW(GEMMIS_seg);
+	}
+	bool LoadState(SaveStateReader & state) {
+		state.ReadBlock(emm_handles,sizeof(emm_handles));
+		state.ReadBlock(emm_mappings,sizeof(emm_mappings));
+		state.ReadBlock(emm_segmentmappings,sizeof(emm_segmentmappings));
+		state.ReadBlock(&vcpi,sizeof(vcpi));
+		Bit16u gemmis=state.ReadW();
+		if (state.Failed()) return false;
+		if (!state.Checking()) GEMMIS_seg=gemmis;
+		return true;
+	}
+	//--End of modifications
+
 	~EMS() {
 		Section_prop * section=static_cast<Section_prop *>(m_configuration);
 		if (!section->Get_bool("ems")) return;
@@ -33,6 +33,9 @@
 #include "int10.h"
 #include "bios.h"
 #include "dos_inc.h"
+//--Added 2026-10-19 to record and replay input deterministically
+#include "replay.h"
+//--End of modifications
 
 
 
@@ -449,6 +452,9 @@ void DrawCursor() {
 }
 
 void Mouse_CursorMoved(float xrel,float yrel,float x,float y,bool emulate) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_MouseMoveEvent(xrel,yrel,x,y,emulate)) return;
+	//--End of modifications
 	float dx = xrel * mouse.pixelPerMickey_x;
 	float dy = yrel * mouse.pixelPerMickey_y;
 
@@ -508,6 +514,9 @@ void Mouse_CursorSet(float x,float y) {
 }
 
 void Mouse_ButtonPressed(Bit8u button) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_MouseButtonEvent(button,true)) return;
+	//--End of modifications
 	switch (button) {
 #if (MOUSE_BUTTONS >= 1)
 	case 0:
@@ -536,6 +545,9 @@ void Mouse_ButtonPressed(Bit8u button) {
 }
 
 void Mouse_ButtonReleased(Bit8u button) {
+	//--Added 2026-10-19 to record and replay input deterministically
+	if (REPLAY_MouseButtonEvent(button,false)) return;
+	//--End of modifications
 	switch (button) {
 #if (MOUSE_BUTTONS >= 1)
 	case 0:
@@ -26,6 +26,9 @@
 #include "regs.h"
 #include "dos_inc.h"
 #include "setup.h"
+//--Added 2026-10-19 to save and load the XMS state
+#include "savestate.h"
+//--End of modifications
 #include "inout.h"
 #include "xms.h"
 #include "bios.h"
@@ -448,6 +451,21 @@ public:
 		DOS_BuildUMBChain(section->Get_bool("umb"),section->Get_bool("ems"));
 	}
 
+	//--Added 2026-10-19 to save and load the XMS handles
+	const char * GetStateName(void) { return "XMS"; }
+	void SaveState(SaveStateWriter & state) {
+		state.WriteBlock(xms_handles,sizeof(xms_handles));
+		state.WriteBool(umb_available);
+	}
+	bool LoadState(SaveStateReader & state) {
+		state.ReadBlock(xms_handles,sizeof(xms_handles));
+		bool umb=state.ReadBool();
+		if (state.Failed()) return false;
+		if (!state.Checking()) umb_available=umb;
+		return true;
+	}
+	//--End of modifications
+
 	~XMS(){
 		Section_prop * section = static_cast<Section_prop *>(m_configuration);
 		/* Remove upper memory information */
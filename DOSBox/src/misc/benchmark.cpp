@@ -0,0 +1,324 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dosbox.h"
+#include "benchmark.h"
+#include "setup.h"
+#include "programs.h"
+#include "control.h"
+#include "shell.h"
+#include "cpu.h"
+#include "pic.h"
+#include "timer.h"
+#include "mixer.h"
+#include "profile.h"
+#include "support.h"
+
+struct BenchmarkCore {
+	CPU_Decoder * decoder;
+	const char * name;
+	Bit64u cycles;
+	Bit64u micros;
+};
+
+static BenchmarkCore bench_cores[]={
+	{ CPU_Core_Normal_Run,			"normal",		0,0 },
+	{ CPU_Core_Normal_Trap_Run,		"normal",		0,0 },
+	{ CPU_Core_Simple_Run,			"simple",		0,0 },
+	{ CPU_Core_Full_Run,			"full",			0,0 },
+	{ CPU_Core_Prefetch_Run,		"prefetch",		0,0 },
+	{ CPU_Core_Prefetch_Trap_Run,	"prefetch",		0,0 },
+#if (C_DYNAMIC_X86)
+	{ CPU_Core_Dyn_X86_Run,			"dynamic",		0,0 },
+	{ CPU_Core_Dyn_X86_Trap_Run,	"dynamic",		0,0 },
+#elif (C_DYNREC)
+	{ CPU_Core_Dynrec_Run,			"dynamic",		0,0 },
+	{ CPU_Core_Dynrec_Trap_Run,		"dynamic",		0,0 },
+#endif
+	{ 0,							"other",		0,0 }
+};
+#define BENCH_CORES (sizeof(bench_cores)/sizeof(bench_cores[0]))
+
+bool benchmark_running=false;
+
+static struct {
+	bool headless;
+	bool profiling;			//Whether the profiler was already running
+	Bit64u start;
+	Bitu start_ticks;
+	Bitu frames;
+	/* The run of the core in progress */
+	BenchmarkCore * core;
+	Bit32s core_cycles;
+	Bit64u core_start;
+} bench;
+
+bool BENCHMARK_IsRunning(void) {
+	return benchmark_running;
+}
+
+bool BENCHMARK_StartFrame(void) {
+	if (GCC_LIKELY(!benchmark_running)) return true;
+	bench.frames++;
+	return !bench.headless;
+}
+
+static BenchmarkCore * BENCHMARK_FindCore(CPU_Decoder * decoder) {
+	Bitu i;
+	for (i=0;i<BENCH_CORES-1;i++) {
+		if (bench_cores[i].decoder==decoder) break;
+	}
+	return &bench_cores[i];
+}
+
+void BENCHMARK_EnterCore(void) {
+	bench.core=BENCHMARK_FindCore(cpudecoder);
+	bench.core_cycles=CPU_Cycles;
+	bench.core_start=GetMicroTicks();
+}
+
+void BENCHMARK_LeaveCore(void) {
+	/* A decoder runs until its cycles run out, so this is a count of instructions for the
+	   interpreting cores; the dynamic cores charge some instructions more than one cycle. */
+	if (bench.core_cycles>CPU_Cycles) bench.core->cycles+=bench.core_cycles-CPU_Cycles;
+	bench.core->micros+=GetMicroTicks()-bench.core_start;
+}
+
+void BENCHMARK_Start(bool headless) {
+	if (benchmark_running) return;
+	for (Bitu i=0;i<BENCH_CORES;i++) {
+		bench_cores[i].cycles=0;
+		bench_cores[i].micros=0;
+	}
+	bench.frames=0;
+	bench.headless=headless;
+	if (headless) MIXER_SetNullSink(true);
+	/* The profiler times each part of the emulator for the report */
+	bench.profiling=profile_enabled;
+	if (bench.profiling) PROFILE_Reset();
+	else PROFILE_Start();
+	benchmark_running=true;
+	bench.start=GetMicroTicks();
+	bench.start_ticks=PIC_Ticks;
+	DOSBOX_SetPacing(false);
+}
+
+void BENCHMARK_Stop(char * report,Bitu size) {
+	if (!benchmark_running) {
+		if (size) report[0]=0;
+		return;
+	}
+	Bit64u wall=GetMicroTicks()-bench.start;
+	if (!wall) wall=1;
+	Bitu ticks=PIC_Ticks-bench.start_ticks;
+	DOSBOX_SetPacing(true);
+	if (bench.headless) MIXER_SetNullSink(false);
+	benchmark_running=false;
+
+	std::string text;
+	char line[128];
+	double wall_ms=(double)wall/1000.0;
+	sprintf(line,"Emulated %u ms in %.0f ms: %.1f emulated ms per second\n",
+		(unsigned int)ticks,wall_ms,(double)ticks*1000000.0/(double)wall);
+	text+=line;
+	sprintf(line,"Frames %u (%.1f per second)%s\n",(unsigned int)bench.frames,
+		(double)bench.frames*1000000.0/(double)wall,bench.headless ? ", dropped" : "");
+	text+=line;
+	sprintf(line,"Cycles %d%s\n",CPU_CycleMax,CPU_CycleAutoAdjust ? " (not adjusted while benchmarking)" : "");
+	text+=line;
+	for (Bitu i=0;i<BENCH_CORES;i++) {
+		BenchmarkCore & core=bench_cores[i];
+		if (!core.micros) continue;
+		/* Fold the trap variants into their main core */
+		for (Bitu j=i+1;j<BENCH_CORES;j++) {
+			if (!strcmp(bench_cores[j].name,core.name)) {
+				core.cycles+=bench_cores[j].cycles;
+				core.micros+=bench_cores[j].micros;
+				bench_cores[j].cycles=bench_cores[j].micros=0;
+			}
+		}
+		sprintf(line,"Core %-8s %12.0f instructions per second\n",core.name,
+			(double)core.cycles*1000000.0/(double)core.micros);
+		text+=line;
+	}
+	PROFILE_Report(text,PROFILE_TEXT);
+	if (!bench.profiling) PROFILE_Stop();
+	safe_strncpy(report,text.c_str(),size);
+}
+
+
+class BENCH : public Program {
+public:
+	void Run(void);
+};
+
+void BENCH::Run(void) {
+	bool headless=cmd->FindExist("/HEADLESS",true);
+	bool quit=cmd->FindExist("/EXIT",true);
+	bool no_inline=cmd->FindExist("/NOINLINE",true);
+	bool no_regcache=cmd->FindExist("/NOREGCACHE",true);
+	bool no_trace=cmd->FindExist("/NOTRACE",true);
+	std::string report_file;
+	cmd->FindStringBegin("/REPORT:",report_file,true);
+	std::string dro_file;
+	if (cmd->FindStringBegin("/DRO:",dro_file,true)) {
+		if (control->SecureMode()) {
+			WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+			return;
+		}
+		char report[1024];
+		OPL_BenchmarkDRO(dro_file.c_str(),report,sizeof(report));
+		WriteOut_NoParsing(report);
+		LOG_MSG("BENCH:%s\n%s",dro_file.c_str(),report);
+		return;
+	}
+	std::string gus_file;
+	if (cmd->FindStringBegin("/GUS:",gus_file,true)) {
+		if (control->SecureMode()) {
+			WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+			return;
+		}
+		char report[1024];
+		GUS_BenchmarkTrace(gus_file.c_str(),report,sizeof(report));
+		WriteOut_NoParsing(report);
+		LOG_MSG("BENCH:%s\n%s",gus_file.c_str(),report);
+		return;
+	}
+	if (cmd->FindExist("/VGA",true)) {
+		char report[1024];
+		VGA_BenchmarkDraw(report,sizeof(report));
+		WriteOut_NoParsing(report);
+		LOG_MSG("BENCH:VGA\n%s",report);
+		return;
+	}
+	std::string gus_trace;
+	cmd->FindStringBegin("/GUSREC:",gus_trace,true);
+	if (!cmd->GetStringRemain(temp_line) || temp_line.empty()) {
+		WriteOut(MSG_Get("PROGRAM_BENCH_USAGE"));
+		return;
+	}
+	if ((!report_file.empty() || !gus_trace.empty()) && control->SecureMode()) {
+		WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+		return;
+	}
+	if (BENCHMARK_IsRunning()) {
+		WriteOut(MSG_Get("PROGRAM_BENCH_RUNNING"));
+		return;
+	}
+
+	char input_line[CMD_MAXLINE];
+	safe_strncpy(input_line,temp_line.c_str(),CMD_MAXLINE);
+	if (!gus_trace.empty() && !GUS_StartTrace(gus_trace.c_str())) {
+		WriteOut(MSG_Get("PROGRAM_BENCH_CANT_TRACE"),gus_trace.c_str());
+		return;
+	}
+#if (C_DYNREC)
+	/* For comparing the recompiled code with and without its optimizations */
+	if (no_inline) CPU_Core_Dynrec_SetInlineTLB(false);
+	if (no_regcache) CPU_Core_Dynrec_SetRegisterCache(false);
+	if (no_trace) CPU_Core_Dynrec_SetTraces(false);
+	Bitu formed,followed,left;
+	CPU_Core_Dynrec_GetTraceStats(formed,followed,left,true);
+#endif
+	BENCHMARK_Start(headless);
+	/* Run the command the way COMMAND /C would */
+	DOS_Shell shell;
+	shell.ParseLine(input_line);
+	shell.RunInternal();
+	char report[2048];
+	BENCHMARK_Stop(report,sizeof(report));
+	GUS_StopTrace();
+#if (C_DYNREC)
+	if (no_inline) {
+		CPU_Core_Dynrec_SetInlineTLB(true);
+		strncat(report,MSG_Get("PROGRAM_BENCH_NOINLINE"),sizeof(report)-strlen(report)-1);
+	}
+	if (no_regcache) {
+		CPU_Core_Dynrec_SetRegisterCache(true);
+		strncat(report,MSG_Get("PROGRAM_BENCH_NOREGCACHE"),sizeof(report)-strlen(report)-1);
+	}
+	CPU_Core_Dynrec_GetTraceStats(formed,followed,left,false);
+	if (formed) {
+		char line[256];
+		Bitu reached=followed+left;
+		sprintf(line,MSG_Get("PROGRAM_BENCH_TRACES"),(unsigned int)formed,(unsigned int)followed,
+			(double)followed*100.0/(double)(reached ? reached : 1));
+		strncat(report,line,sizeof(report)-strlen(report)-1);
+	}
+	if (no_trace) {
+		CPU_Core_Dynrec_SetTraces(true);
+		strncat(report,MSG_Get("PROGRAM_BENCH_NOTRACE"),sizeof(report)-strlen(report)-1);
+	}
+#endif
+
+	WriteOut_NoParsing(report);
+	LOG_MSG("BENCH:%s\n%s",temp_line.c_str(),report);
+	if (!report_file.empty()) {
+		FILE * f=fopen(report_file.c_str(),"wt");
+		if (f) {
+			fprintf(f,"%s",report);
+			fclose(f);
+		} else WriteOut(MSG_Get("PROGRAM_BENCH_CANT_WRITE"),report_file.c_str());
+	}
+	/* Leave the emulator once the report is out, for running from scripts */
+	if (quit) static_cast<DOS_Shell *>(first_shell)->exit=true;
+}
+
+static void BENCH_ProgramStart(Program * * make) {
+	*make=new BENCH;
+}
+
+static void BENCHMARK_ShutDown(Section * /*sec*/) {
+	if (benchmark_running) {
+		char report[2048];
+		BENCHMARK_Stop(report,sizeof(report));
+	}
+}
+
+void BENCHMARK_Init(Section * sec) {
+	benchmark_running=false;
+	PROGRAMS_MakeFile("BENCH.COM",BENCH_ProgramStart);
+	MSG_Add("PROGRAM_BENCH_USAGE","Runs a program as fast as possible and reports how fast the emulation ran.\n\n"
+		"BENCH [/HEADLESS] [/NOINLINE] [/NOREGCACHE] [/NOTRACE] [/REPORT:file] [/GUSREC:file] [/EXIT] command\n"
+		"BENCH /DRO:file\n"
+		"BENCH /GUS:file\n"
+		"BENCH /VGA\n\n"
+		"  /HEADLESS   discards video and sound output.\n"
+		"  /NOINLINE   makes the dynamic core call out for every memory access\n"
+		"              instead of looking up the TLB inline.\n"
+		"  /NOREGCACHE makes the dynamic core load and store the emulated registers\n"
+		"              for every instruction instead of keeping them in host registers.\n"
+		"  /NOTRACE    makes the dynamic core end its blocks at every conditional jump\n"
+		"              instead of continuing through the side that is taken most.\n"
+		"  /REPORT     also writes the report to a file.\n"
+		"  /GUSREC     records a trace of the GUS voices while the command runs.\n"
+		"  /EXIT       leaves the emulator once the command has finished.\n"
+		"  /DRO        times the OPL synth playing back a DRO capture from the host.\n"
+		"  /GUS        times the GUS voices playing back a trace made with /GUSREC.\n"
+		"  /VGA        times the SIMD line drawers of the video card against the plain ones.\n");
+	MSG_Add("PROGRAM_BENCH_RUNNING","A benchmark is already running.\n");
+	MSG_Add("PROGRAM_BENCH_CANT_WRITE","Can't write report to %s.\n");
+	MSG_Add("PROGRAM_BENCH_CANT_TRACE","Can't record a GUS trace to %s.\n");
+	MSG_Add("PROGRAM_BENCH_NOINLINE","Dynamic core memory accesses called out to the memory helpers\n");
+	MSG_Add("PROGRAM_BENCH_NOREGCACHE","Dynamic core registers were not cached in host registers\n");
+	MSG_Add("PROGRAM_BENCH_NOTRACE","Dynamic core blocks ended at every conditional jump\n");
+	MSG_Add("PROGRAM_BENCH_TRACES","Dynamic core superblocks: %u formed, hot path followed %u times (%.1f%% hit rate)\n");
+	sec->AddDestroyFunction(&BENCHMARK_ShutDown);
+}
@@ -0,0 +1,367 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "dosbox.h"
+#include "profile.h"
+#include "setup.h"
+#include "programs.h"
+#include "control.h"
+#include "timer.h"
+#include "support.h"
+
+static const char * profile_section_names[PROFILE_SECTIONS]={
+	"other","cpu","callbacks","events","ticks","mixer","vga","render","present","host","idle"
+};
+
+/* Microsecond histogram with 8 buckets per power of two, so that percentiles
+   come out within 12.5% of the real value over the whole range */
+#define HIST_LINEAR 16
+#define HIST_SUBBITS 3
+#define HIST_BUCKETS (HIST_LINEAR+(32-4)*(1<<HIST_SUBBITS))
+
+class ProfileHistogram {
+public:
+	void Clear(void) {
+		memset(counts,0,sizeof(counts));
+		samples=0;
+		total=0;
+	}
+	void Add(Bit64u micros) {
+		Bit32u value=(micros>0xffffffff) ? 0xffffffff : (Bit32u)micros;
+		counts[Bucket(value)]++;
+		samples++;
+		total+=micros;
+	}
+	/* The lower bound of the bucket holding the given fraction of the samples */
+	Bit32u Percentile(double fraction) const {
+		if (!samples) return 0;
+		Bit64u wanted=(Bit64u)(fraction*(double)samples);
+		if (wanted>=samples) wanted=samples-1;
+		Bit64u seen=0;
+		for (Bitu i=0;i<HIST_BUCKETS;i++) {
+			seen+=counts[i];
+			if (seen>wanted) return Lower(i);
+		}
+		return Lower(HIST_BUCKETS-1);
+	}
+	Bit64u samples;
+	Bit64u total;
+private:
+	static Bitu Bucket(Bit32u value) {
+		if (value<HIST_LINEAR) return value;
+		Bitu octave=31;
+		while (!(value & (1u<<octave))) octave--;
+		return HIST_LINEAR+(octave-4)*(1<<HIST_SUBBITS)+((value>>(octave-HIST_SUBBITS))&((1<<HIST_SUBBITS)-1));
+	}
+	static Bit32u Lower(Bitu bucket) {
+		if (bucket<HIST_LINEAR) return (Bit32u)bucket;
+		Bitu octave=4+(bucket-HIST_LINEAR)/(1<<HIST_SUBBITS);
+		Bitu sub=(bucket-HIST_LINEAR)%(1<<HIST_SUBBITS);
+		return (Bit32u)(((1<<HIST_SUBBITS)+sub)<<(octave-HIST_SUBBITS));
+	}
+	Bit32u counts[HIST_BUCKETS];
+};
+
+/* One set of histograms covers everything since the profiler was started,
+   the other only the second of emulated time currently being streamed */
+struct ProfileStats {
+	ProfileHistogram frame;
+	ProfileHistogram sections[PROFILE_SECTIONS];
+	Bit64u start;
+	Bitu ticks;
+	Bitu dropped;
+	void Clear(Bit64u now) {
+		frame.Clear();
+		for (Bitu i=0;i<PROFILE_SECTIONS;i++) sections[i].Clear();
+		start=now;
+		ticks=0;
+		dropped=0;
+	}
+};
+
+#define PROFILE_MAX_DEPTH 16
+
+bool profile_enabled=false;
+
+static struct {
+	ProfileSection current;
+	ProfileSection stack[PROFILE_MAX_DEPTH];
+	Bitu depth;
+	Bit64u since;
+	Bit64u frame_start;
+	Bit64u frame[PROFILE_SECTIONS];
+	ProfileStats total;
+	ProfileStats interval;
+	FILE * stream;
+	ProfileFormat stream_format;
+} profile;
+
+static inline void PROFILE_Charge(Bit64u now) {
+	profile.frame[profile.current]+=now-profile.since;
+	profile.since=now;
+}
+
+void PROFILE_Enter(ProfileSection section) {
+	/* Scopes nested past the limit are left to their parent */
+	if (GCC_UNLIKELY(profile.depth>=PROFILE_MAX_DEPTH)) {
+		profile.depth++;
+		return;
+	}
+	PROFILE_Charge(GetMicroTicks());
+	profile.stack[profile.depth++]=profile.current;
+	profile.current=section;
+}
+
+void PROFILE_Leave(void) {
+	if (!profile.depth) return;
+	if (GCC_UNLIKELY(--profile.depth>=PROFILE_MAX_DEPTH)) return;
+	PROFILE_Charge(GetMicroTicks());
+	profile.current=profile.stack[profile.depth];
+}
+
+void PROFILE_Frame(void) {
+	if (GCC_LIKELY(!profile_enabled)) return;
+	Bit64u now=GetMicroTicks();
+	PROFILE_Charge(now);
+	/* The first frame after starting is only partly covered */
+	if (profile.frame_start) {
+		Bit64u length=now-profile.frame_start;
+		profile.total.frame.Add(length);
+		profile.interval.frame.Add(length);
+		for (Bitu i=0;i<PROFILE_SECTIONS;i++) {
+			profile.total.sections[i].Add(profile.frame[i]);
+			profile.interval.sections[i].Add(profile.frame[i]);
+		}
+	}
+	memset(profile.frame,0,sizeof(profile.frame));
+	profile.frame_start=now;
+}
+
+static void PROFILE_Write(std::string & out,const ProfileStats & stats,ProfileFormat format,bool header) {
+	char line[256];
+	Bit64u wall=GetMicroTicks()-stats.start;
+	double wall_ms=(double)wall/1000.0;
+	/* How far the emulated clock has fallen behind the host clock */
+	double drift_ms=wall_ms-(double)stats.ticks;
+	Bit64u accounted=0;
+	for (Bitu i=0;i<PROFILE_SECTIONS;i++) accounted+=stats.sections[i].total;
+	if (!accounted) accounted=1;
+
+	switch (format) {
+	case PROFILE_TEXT:
+		sprintf(line,"%u frames in %.0f ms, %u emulated ms: %.0f ms behind the host clock, %u ms dropped\n",
+			(unsigned int)stats.frame.samples,wall_ms,(unsigned int)stats.ticks,drift_ms,(unsigned int)stats.dropped);
+		out+=line;
+		sprintf(line,"Frame time     p50 %6u us  p99 %6u us\n",
+			stats.frame.Percentile(0.5),stats.frame.Percentile(0.99));
+		out+=line;
+		for (Bitu i=0;i<PROFILE_SECTIONS;i++) {
+			const ProfileHistogram & hist=stats.sections[i];
+			sprintf(line,"%-10s %5.1f%%  p50 %6u us  p99 %6u us\n",profile_section_names[i],
+				(double)hist.total*100.0/(double)accounted,hist.Percentile(0.5),hist.Percentile(0.99));
+			out+=line;
+		}
+		break;
+	case PROFILE_CSV:
+		if (header) {
+			out+="wall_ms,emulated_ms,drift_ms,dropped_ms,frames,frame_p50_us,frame_p99_us";
+			for (Bitu i=0;i<PROFILE_SECTIONS;i++) {
+				sprintf(line,",%s_us,%s_p50_us,%s_p99_us",profile_section_names[i],
+					profile_section_names[i],profile_section_names[i]);
+				out+=line;
+			}
+			out+="\n";
+		}
+		sprintf(line,"%.1f,%u,%.1f,%u,%u,%u,%u",wall_ms,(unsigned int)stats.ticks,drift_ms,
+			(unsigned int)stats.dropped,(unsigned int)stats.frame.samples,
+			stats.frame.Percentile(0.5),stats.frame.Percentile(0.99));
+		out+=line;
+		for (Bitu i=0;i<PROFILE_SECTIONS;i++) {
+			const ProfileHistogram & hist=stats.sections[i];
+			sprintf(line,",%.0f,%u,%u",(double)hist.total,hist.Percentile(0.5),hist.Percentile(0.99));
+			out+=line;
+		}
+		out+="\n";
+		break;
+	case PROFILE_JSON:
+		sprintf(line,"{\"wall_ms\":%.1f,\"emulated_ms\":%u,\"drift_ms\":%.1f,\"dropped_ms\":%u,"
+			"\"frames\":%u,\"frame_p50_us\":%u,\"frame_p99_us\":%u,\"sections\":{",
+			wall_ms,(unsigned int)stats.ticks,drift_ms,(unsigned int)stats.dropped,
+			(unsigned int)stats.frame.samples,stats.frame.Percentile(0.5),stats.frame.Percentile(0.99));
+		out+=line;
+		for (Bitu i=0;i<PROFILE_SECTIONS;i++) {
+			const ProfileHistogram & hist=stats.sections[i];
+			sprintf(line,"%s\"%s\":{\"total_us\":%.0f,\"p50_us\":%u,\"p99_us\":%u}",i ? "," : "",
+				profile_section_names[i],(double)hist.total,hist.Percentile(0.5),hist.Percentile(0.99));
+			out+=line;
+		}
+		out+="}}\n";
+		break;
+	}
+}
+
+void PROFILE_Tick(void) {
+	if (GCC_LIKELY(!profile_enabled)) return;
+	profile.total.ticks++;
+	if (++profile.interval.ticks<1000 || !profile.stream) return;
+	std::string row;
+	PROFILE_Write(row,profile.interval,profile.stream_format,false);
+	fputs(row.c_str(),profile.stream);
+	fflush(profile.stream);
+	profile.interval.Clear(GetMicroTicks());
+}
+
+void PROFILE_DropTicks(Bitu ms) {
+	if (GCC_LIKELY(!profile_enabled)) return;
+	profile.total.dropped+=ms;
+	profile.interval.dropped+=ms;
+}
+
+void PROFILE_Reset(void) {
+	Bit64u now=GetMicroTicks();
+	profile.total.Clear(now);
+	profile.interval.Clear(now);
+	memset(profile.frame,0,sizeof(profile.frame));
+	profile.frame_start=0;
+	profile.since=now;
+}
+
+void PROFILE_Start(void) {
+	if (profile_enabled) return;
+	PROFILE_Reset();
+	profile.current=PROFILE_OTHER;
+	profile.depth=0;
+	profile_enabled=true;
+}
+
+void PROFILE_Stop(void) {
+	profile_enabled=false;
+	PROFILE_SetStream(0,PROFILE_CSV);
+}
+
+void PROFILE_Report(std::string & out,ProfileFormat format) {
+	PROFILE_Write(out,profile.total,format,true);
+}
+
+bool PROFILE_SetStream(const char * filename,ProfileFormat format) {
+	if (profile.stream) {
+		fclose(profile.stream);
+		profile.stream=0;
+	}
+	if (!filename) return true;
+	profile.stream=fopen(filename,"wt");
+	if (!profile.stream) return false;
+	profile.stream_format=format;
+	if (format==PROFILE_CSV) {
+		/* The header row only */
+		std::string header;
+		ProfileStats empty;
+		empty.Clear(GetMicroTicks());
+		PROFILE_Write(header,empty,PROFILE_CSV,true);
+		header.erase(header.find('\n')+1);
+		fputs(header.c_str(),profile.stream);
+	}
+	profile.interval.Clear(GetMicroTicks());
+	return true;
+}
+
+
+class PROF : public Program {
+public:
+	void Run(void);
+};
+
+void PROF::Run(void) {
+	ProfileFormat format=cmd->FindExist("/JSON",true) ? PROFILE_JSON : PROFILE_CSV;
+	std::string stream_file;
+	std::string report_file;
+	bool stream=cmd->FindStringBegin("/STREAM:",stream_file,true);
+	bool report=cmd->FindStringBegin("/REPORT:",report_file,true);
+	if ((stream || report) && control->SecureMode()) {
+		WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+		return;
+	}
+	if (cmd->FindExist("/?",false)) {
+		WriteOut(MSG_Get("PROGRAM_PROF_USAGE"));
+		return;
+	}
+	if (cmd->FindExist("/OFF",true)) {
+		PROFILE_Stop();
+		WriteOut(MSG_Get("PROGRAM_PROF_STOPPED"));
+		return;
+	}
+	if (cmd->FindExist("/ON",true)) {
+		PROFILE_Start();
+		WriteOut(MSG_Get("PROGRAM_PROF_STARTED"));
+	}
+	if (cmd->FindExist("/RESET",true)) PROFILE_Reset();
+	if (stream) {
+		if (!profile_enabled) PROFILE_Start();
+		if (!PROFILE_SetStream(stream_file.c_str(),format)) {
+			WriteOut(MSG_Get("PROGRAM_PROF_CANT_WRITE"),stream_file.c_str());
+			return;
+		}
+	}
+	if (!profile_enabled) {
+		WriteOut(MSG_Get("PROGRAM_PROF_OFF"));
+		return;
+	}
+	if (report) {
+		std::string text;
+		PROFILE_Report(text,format);
+		FILE * f=fopen(report_file.c_str(),"wt");
+		if (f) {
+			fputs(text.c_str(),f);
+			fclose(f);
+		} else WriteOut(MSG_Get("PROGRAM_PROF_CANT_WRITE"),report_file.c_str());
+		return;
+	}
+	std::string text;
+	PROFILE_Report(text,PROFILE_TEXT);
+	WriteOut_NoParsing(text.c_str());
+}
+
+static void PROF_ProgramStart(Program * * make) {
+	*make=new PROF;
+}
+
+static void PROFILE_ShutDown(Section * /*sec*/) {
+	PROFILE_Stop();
+}
+
+void PROFILE_Init(Section * sec) {
+	profile_enabled=false;
+	profile.stream=0;
+	PROGRAMS_MakeFile("PROF.COM",PROF_ProgramStart);
+	MSG_Add("PROGRAM_PROF_USAGE","Shows where the host time of each emulated frame goes.\n\n"
+		"PROF [/ON] [/OFF] [/RESET] [/REPORT:file] [/STREAM:file] [/JSON]\n\n"
+		"  /ON         starts measuring.\n"
+		"  /OFF        stops measuring.\n"
+		"  /RESET      starts the statistics over.\n"
+		"  /REPORT     writes the statistics to a file as CSV.\n"
+		"  /STREAM     writes the statistics of every emulated second to a file as CSV.\n"
+		"  /JSON       writes JSON instead of CSV.\n\n"
+		"Without options, shows the statistics so far.\n");
+	MSG_Add("PROGRAM_PROF_STARTED","Profiling started.\n");
+	MSG_Add("PROGRAM_PROF_STOPPED","Profiling stopped.\n");
+	MSG_Add("PROGRAM_PROF_OFF","Profiling is off: start it with PROF /ON.\n");
+	MSG_Add("PROGRAM_PROF_CANT_WRITE","Can't write to %s.\n");
+	sec->AddDestroyFunction(&PROFILE_ShutDown);
+}
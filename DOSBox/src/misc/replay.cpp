@@ -0,0 +1,477 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "dosbox.h"
+#include "replay.h"
+#include "savestate.h"
+#include "setup.h"
+#include "programs.h"
+#include "control.h"
+#include "cpu.h"
+#include "keyboard.h"
+#include "mouse.h"
+#include "joystick.h"
+#include "timer.h"
+
+/* A replay file is laid out as:
+	"DBXREPLY", version, host time at the start, size of saved state, saved state
+   followed by the events, each of which is:
+	tick (dword), type (byte), type-specific data
+   and finishes with an end event on the tick the recording was stopped. */
+static const char replay_magic[8]={'D','B','X','R','E','P','L','Y'};
+#define REPLAY_VERSION 1
+
+enum ReplayEventType {
+	REPLAY_EVENT_END,
+	REPLAY_EVENT_CYCLES,
+	REPLAY_EVENT_KEY,
+	REPLAY_EVENT_MOUSE_MOVE,
+	REPLAY_EVENT_MOUSE_BUTTON,
+	REPLAY_EVENT_JOYSTICK_AXIS,
+	REPLAY_EVENT_JOYSTICK_BUTTON
+};
+
+struct ReplayEvent {
+	Bit8u type;
+	Bitu which;				//Key, mouse button, joystick or cycle count
+	Bitu num;				//Joystick axis or button
+	bool pressed;			//Also whether mouse movement is emulated
+	float x,y,xrel,yrel;	//Mouse position or joystick axis position in x
+};
+
+enum ReplayMode {
+	REPLAY_IDLE,
+	REPLAY_RECORDING,
+	REPLAY_PLAYING
+};
+
+static struct {
+	ReplayMode mode;
+	//Set while an event is being passed on to the emulation, so the hooks let it through
+	bool delivering;
+	Bitu tick;
+	time_t start_time;
+
+	//Recording
+	std::string filename;
+	std::vector<Bit8u> state;
+	std::vector<Bit8u> log;
+	std::vector<ReplayEvent> pending;
+	Bit32s logged_cycles;
+
+	//Playback
+	std::vector<Bit8u> data;
+	SaveStateReader * reader;
+	Bitu next_tick;
+	bool saved_autoadjust;
+	Bit64u wall_start;
+	REPLAY_FinishHandler finish_handler;
+
+	struct {
+		bool pending;
+		bool stop;
+		std::string record;
+		std::string play;
+		REPLAY_FinishHandler play_handler;
+	} request;
+} replay;
+
+
+static void REPLAY_Deliver(const ReplayEvent & event) {
+	replay.delivering=true;
+	switch (event.type) {
+	case REPLAY_EVENT_CYCLES:
+		CPU_CycleMax=(Bit32s)event.which;
+		break;
+	case REPLAY_EVENT_KEY:
+		KEYBOARD_AddKey((KBD_KEYS)event.which,event.pressed);
+		break;
+	case REPLAY_EVENT_MOUSE_MOVE:
+		Mouse_CursorMoved(event.xrel,event.yrel,event.x,event.y,event.pressed);
+		break;
+	case REPLAY_EVENT_MOUSE_BUTTON:
+		if (event.pressed) Mouse_ButtonPressed((Bit8u)event.which);
+		else Mouse_ButtonReleased((Bit8u)event.which);
+		break;
+	case REPLAY_EVENT_JOYSTICK_AXIS:
+		if (event.num) JOYSTICK_Move_Y(event.which,event.x);
+		else JOYSTICK_Move_X(event.which,event.x);
+		break;
+	case REPLAY_EVENT_JOYSTICK_BUTTON:
+		JOYSTICK_Button(event.which,event.num,event.pressed);
+		break;
+	}
+	replay.delivering=false;
+}
+
+static void REPLAY_WriteEvent(SaveStateWriter & out,const ReplayEvent & event) {
+	out.WriteD((Bit32u)replay.tick);
+	out.WriteB(event.type);
+	switch (event.type) {
+	case REPLAY_EVENT_CYCLES:
+	case REPLAY_EVENT_KEY:
+	case REPLAY_EVENT_MOUSE_BUTTON:
+		out.WriteD((Bit32u)event.which);
+		out.WriteBool(event.pressed);
+		break;
+	case REPLAY_EVENT_MOUSE_MOVE:
+		out.WriteFloat(event.xrel);
+		out.WriteFloat(event.yrel);
+		out.WriteFloat(event.x);
+		out.WriteFloat(event.y);
+		out.WriteBool(event.pressed);
+		break;
+	case REPLAY_EVENT_JOYSTICK_AXIS:
+		out.WriteD((Bit32u)event.which);
+		out.WriteD((Bit32u)event.num);
+		out.WriteFloat(event.x);
+		break;
+	case REPLAY_EVENT_JOYSTICK_BUTTON:
+		out.WriteD((Bit32u)event.which);
+		out.WriteD((Bit32u)event.num);
+		out.WriteBool(event.pressed);
+		break;
+	}
+}
+
+static void REPLAY_ReadEvent(SaveStateReader & in,ReplayEvent & event) {
+	memset(&event,0,sizeof(event));
+	event.type=in.ReadB();
+	switch (event.type) {
+	case REPLAY_EVENT_CYCLES:
+	case REPLAY_EVENT_KEY:
+	case REPLAY_EVENT_MOUSE_BUTTON:
+		event.which=in.ReadD();
+		event.pressed=in.ReadBool();
+		break;
+	case REPLAY_EVENT_MOUSE_MOVE:
+		event.xrel=in.ReadFloat();
+		event.yrel=in.ReadFloat();
+		event.x=in.ReadFloat();
+		event.y=in.ReadFloat();
+		event.pressed=in.ReadBool();
+		break;
+	case REPLAY_EVENT_JOYSTICK_AXIS:
+		event.which=in.ReadD();
+		event.num=in.ReadD();
+		event.x=in.ReadFloat();
+		break;
+	case REPLAY_EVENT_JOYSTICK_BUTTON:
+		event.which=in.ReadD();
+		event.num=in.ReadD();
+		event.pressed=in.ReadBool();
+		break;
+	}
+}
+
+/* Returns true if the hook should leave the event to us */
+static bool REPLAY_Capture(const ReplayEvent & event) {
+	if (GCC_LIKELY(replay.mode==REPLAY_IDLE) || replay.delivering) return false;
+	//Live input is ignored during playback
+	if (replay.mode==REPLAY_RECORDING) replay.pending.push_back(event);
+	return true;
+}
+
+bool REPLAY_KeyEvent(Bitu key,bool pressed) {
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_KEY;
+	event.which=key;
+	event.pressed=pressed;
+	return REPLAY_Capture(event);
+}
+
+bool REPLAY_MouseMoveEvent(float xrel,float yrel,float x,float y,bool emulate) {
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_MOUSE_MOVE;
+	event.xrel=xrel;
+	event.yrel=yrel;
+	event.x=x;
+	event.y=y;
+	event.pressed=emulate;
+	return REPLAY_Capture(event);
+}
+
+bool REPLAY_MouseButtonEvent(Bit8u button,bool pressed) {
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_MOUSE_BUTTON;
+	event.which=button;
+	event.pressed=pressed;
+	return REPLAY_Capture(event);
+}
+
+bool REPLAY_JoystickAxisEvent(Bitu which,Bitu axis,float position) {
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_JOYSTICK_AXIS;
+	event.which=which;
+	event.num=axis;
+	event.x=position;
+	return REPLAY_Capture(event);
+}
+
+bool REPLAY_JoystickButtonEvent(Bitu which,Bitu num,bool pressed) {
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_JOYSTICK_BUTTON;
+	event.which=which;
+	event.num=num;
+	event.pressed=pressed;
+	return REPLAY_Capture(event);
+}
+
+
+static void REPLAY_StartRecording(const std::string & filename) {
+	if (!SAVESTATE_Save(replay.state)) {
+		LOG_MSG("REPLAY:Could not save the starting state");
+		return;
+	}
+	replay.filename=filename;
+	replay.log.clear();
+	replay.pending.clear();
+	replay.logged_cycles=-1;
+	replay.start_time=time(NULL);
+	replay.tick=0;
+	replay.mode=REPLAY_RECORDING;
+	LOG_MSG("REPLAY:Recording to %s",filename.c_str());
+}
+
+static void REPLAY_StopRecording(void) {
+	SaveStateWriter out(replay.log,0,false);
+	ReplayEvent event;
+	memset(&event,0,sizeof(event));
+	event.type=REPLAY_EVENT_END;
+	REPLAY_WriteEvent(out,event);
+	replay.mode=REPLAY_IDLE;
+
+	std::vector<Bit8u> header;
+	SaveStateWriter head(header,0,false);
+	head.WriteBytes(replay_magic,sizeof(replay_magic));
+	head.WriteD(REPLAY_VERSION);
+	head.WriteQ((Bit64u)replay.start_time);
+	head.WriteD((Bit32u)replay.state.size());
+
+	FILE * f=fopen(replay.filename.c_str(),"wb");
+	bool success=f!=0;
+	if (f) {
+		if (fwrite(&header[0],1,header.size(),f)!=header.size()) success=false;
+		if (fwrite(&replay.state[0],1,replay.state.size(),f)!=replay.state.size()) success=false;
+		if (fwrite(&replay.log[0],1,replay.log.size(),f)!=replay.log.size()) success=false;
+		if (fclose(f)!=0) success=false;
+	}
+	if (success) LOG_MSG("REPLAY:Recorded %d ms to %s",(int)replay.tick,replay.filename.c_str());
+	else LOG_MSG("REPLAY:Couldn't write %s",replay.filename.c_str());
+	replay.state.clear();
+	replay.log.clear();
+}
+
+static void REPLAY_StopPlaying(bool finished) {
+	REPLAY_Result result;
+	result.emulated_ms=replay.tick;
+	result.wall_ms=(GetMicroTicks()-replay.wall_start)/1000.0;
+
+	CPU_CycleAutoAdjust=replay.saved_autoadjust;
+	delete replay.reader;
+	replay.reader=0;
+	replay.data.clear();
+	replay.mode=REPLAY_IDLE;
+
+	LOG_MSG("REPLAY:%s after %d ms of emulated time in %.0f ms (%.2fx realtime)",
+		finished ? "Finished" : "Stopped",(int)result.emulated_ms,result.wall_ms,
+		result.wall_ms>0 ? result.emulated_ms/result.wall_ms : 0.0);
+	if (replay.finish_handler) replay.finish_handler(result);
+}
+
+static void REPLAY_StartPlaying(const std::string & filename,REPLAY_FinishHandler handler) {
+	FILE * f=fopen(filename.c_str(),"rb");
+	if (!f) {
+		LOG_MSG("REPLAY:Can't open %s",filename.c_str());
+		return;
+	}
+	replay.data.clear();
+	Bit8u block[16384];
+	size_t count;
+	while ((count=fread(block,1,sizeof(block),f))>0) replay.data.insert(replay.data.end(),block,block+count);
+	fclose(f);
+
+	SaveStateReader * in=new SaveStateReader(replay.data.empty() ? 0 : &replay.data[0],replay.data.size(),0);
+	char magic[sizeof(replay_magic)];
+	if (!in->ReadBytes(magic,sizeof(magic)) || memcmp(magic,replay_magic,sizeof(magic)) || in->ReadD()!=REPLAY_VERSION) {
+		LOG_MSG("REPLAY:%s is not a compatible replay",filename.c_str());
+		delete in;
+		return;
+	}
+	time_t start_time=(time_t)in->ReadQ();
+	Bitu state_size=in->ReadD();
+	const Bit8u * state=in->Skip(state_size);
+	if (!state || !SAVESTATE_Load(state,state_size)) {
+		LOG_MSG("REPLAY:Could not load the starting state from %s",filename.c_str());
+		delete in;
+		return;
+	}
+	replay.reader=in;
+	replay.next_tick=in->ReadD();
+	replay.start_time=start_time;
+	replay.tick=0;
+	replay.finish_handler=handler;
+	//The cycle count comes from the recording from here on
+	replay.saved_autoadjust=CPU_CycleAutoAdjust;
+	CPU_CycleAutoAdjust=false;
+	replay.wall_start=GetMicroTicks();
+	replay.mode=REPLAY_PLAYING;
+	LOG_MSG("REPLAY:Playing %s",filename.c_str());
+}
+
+static void REPLAY_RunRequests(void) {
+	replay.request.pending=false;
+	if (replay.request.stop) {
+		replay.request.stop=false;
+		if (replay.mode==REPLAY_RECORDING) REPLAY_StopRecording();
+		else if (replay.mode==REPLAY_PLAYING) REPLAY_StopPlaying(false);
+	}
+	if (!replay.request.record.empty()) {
+		if (replay.mode==REPLAY_IDLE) REPLAY_StartRecording(replay.request.record);
+		replay.request.record.clear();
+	}
+	if (!replay.request.play.empty()) {
+		if (replay.mode==REPLAY_IDLE) REPLAY_StartPlaying(replay.request.play,replay.request.play_handler);
+		replay.request.play.clear();
+	}
+}
+
+void REPLAY_Tick(void) {
+	if (GCC_UNLIKELY(replay.request.pending)) REPLAY_RunRequests();
+	if (GCC_LIKELY(replay.mode==REPLAY_IDLE)) return;
+
+	if (replay.mode==REPLAY_RECORDING) {
+		SaveStateWriter out(replay.log,0,false);
+		if (CPU_CycleMax!=replay.logged_cycles) {
+			ReplayEvent event;
+			memset(&event,0,sizeof(event));
+			event.type=REPLAY_EVENT_CYCLES;
+			event.which=(Bitu)CPU_CycleMax;
+			REPLAY_WriteEvent(out,event);
+			replay.logged_cycles=CPU_CycleMax;
+		}
+		for (Bitu i=0;i<replay.pending.size();i++) {
+			REPLAY_WriteEvent(out,replay.pending[i]);
+			REPLAY_Deliver(replay.pending[i]);
+		}
+		replay.pending.clear();
+	} else {
+		while (replay.next_tick==replay.tick) {
+			ReplayEvent event;
+			REPLAY_ReadEvent(*replay.reader,event);
+			if (replay.reader->Failed()) {
+				LOG_MSG("REPLAY:Replay is truncated");
+				REPLAY_StopPlaying(false);
+				return;
+			}
+			if (event.type==REPLAY_EVENT_END) {
+				REPLAY_StopPlaying(true);
+				return;
+			}
+			REPLAY_Deliver(event);
+			replay.next_tick=replay.reader->ReadD();
+		}
+	}
+	replay.tick++;
+}
+
+time_t REPLAY_HostTime(void) {
+	if (GCC_LIKELY(replay.mode==REPLAY_IDLE)) return time(NULL);
+	return replay.start_time+(time_t)(replay.tick/1000);
+}
+
+bool REPLAY_IsPlaying(void) {
+	return replay.mode==REPLAY_PLAYING;
+}
+
+void REPLAY_RequestRecord(const char * filename) {
+	replay.request.record=filename;
+	replay.request.pending=true;
+}
+
+void REPLAY_RequestPlay(const char * filename,REPLAY_FinishHandler handler) {
+	replay.request.play=filename;
+	replay.request.play_handler=handler;
+	replay.request.pending=true;
+}
+
+void REPLAY_RequestStop(void) {
+	replay.request.stop=true;
+	replay.request.pending=true;
+}
+
+
+class REPLAY : public Program {
+public:
+	void Run(void);
+};
+
+void REPLAY::Run(void) {
+	std::string action;
+	if (!cmd->FindCommand(1,action)) {
+		WriteOut(MSG_Get("PROGRAM_REPLAY_USAGE"));
+		return;
+	}
+	if (!strcasecmp(action.c_str(),"STOP")) {
+		REPLAY_RequestStop();
+		return;
+	}
+	if (!cmd->FindCommand(2,temp_line)) {
+		WriteOut(MSG_Get("PROGRAM_REPLAY_USAGE"));
+		return;
+	}
+	if (control->SecureMode()) {
+		WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+		return;
+	}
+	/* Like STATE, this takes effect once the program has finished */
+	if (!strcasecmp(action.c_str(),"RECORD")) {
+		REPLAY_RequestRecord(temp_line.c_str());
+	} else if (!strcasecmp(action.c_str(),"PLAY")) {
+		REPLAY_RequestPlay(temp_line.c_str());
+	} else {
+		WriteOut(MSG_Get("PROGRAM_REPLAY_USAGE"));
+	}
+}
+
+static void REPLAY_ProgramStart(Program * * make) {
+	*make=new REPLAY;
+}
+
+static void REPLAY_ShutDown(Section * /*sec*/) {
+	if (replay.mode==REPLAY_RECORDING) REPLAY_StopRecording();
+	else if (replay.mode==REPLAY_PLAYING) {
+		replay.finish_handler=0;
+		REPLAY_StopPlaying(false);
+	}
+}
+
+void REPLAY_Init(Section * sec) {
+	PROGRAMS_MakeFile("REPLAY.COM",REPLAY_ProgramStart);
+	MSG_Add("PROGRAM_REPLAY_USAGE","Records and replays everything that happens in the emulated machine.\n\n"
+		"REPLAY RECORD filename\nREPLAY PLAY filename\nREPLAY STOP\n");
+	sec->AddDestroyFunction(&REPLAY_ShutDown);
+}
@@ -0,0 +1,414 @@
+/*
+ *  Copyright (C) 2002-2010  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <list>
+#include "dosbox.h"
+#include "savestate.h"
+#include "setup.h"
+#include "programs.h"
+#include "control.h"
+#include "pic.h"
+#include "mem.h"
+#include "timer.h"
+
+/* A state is laid out as:
+	"DBXSTATE", version, code fingerprint, serial, serial of the state a delta
+	is relative to, memory size and DOSBox version string
+   followed by one chunk per module:
+	name length (byte), name, payload size (dword), payload
+   and a zero name length to finish. Chunks for modules that aren't present
+   are skipped over, modules that aren't in the state are left as they are. */
+static const char state_magic[8]={'D','B','X','S','T','A','T','E'};
+
+struct StateEntry {
+	std::string name;
+	Module_base * module;
+	SAVESTATE_SaveHandler save;
+	SAVESTATE_LoadHandler load;
+};
+
+typedef std::list<StateEntry>::iterator state_it;
+static std::list<StateEntry> state_entries;
+
+/* Serial of the last state saved or loaded */
+static Bit64u last_serial=0;
+
+static struct {
+	std::string save;
+	std::string load;
+	bool pending;
+} requests;
+
+
+Bit64s SAVESTATE_FunctionOffset(void (*func)(void)) {
+	if (!func) return 0;
+	return (Bit64s)((Bits)reinterpret_cast<Bitu>(func)-(Bits)reinterpret_cast<Bitu>(&SAVESTATE_RunRequests));
+}
+
+void (*SAVESTATE_FunctionFromOffset(Bit64s offset))(void) {
+	if (!offset) return 0;
+	return reinterpret_cast<void (*)(void)>((Bitu)((Bits)reinterpret_cast<Bitu>(&SAVESTATE_RunRequests)+(Bits)offset));
+}
+
+/* Changes whenever the code layout does, which would invalidate any saved function offsets */
+static Bit64s SAVESTATE_Fingerprint(void) {
+	return SAVESTATE_FunctionOffset(reinterpret_cast<void (*)(void)>(&PIC_RunQueue));
+}
+
+
+void SaveStateWriter::WriteFloat(float val) {
+	Bit32u raw;
+	memcpy(&raw,&val,sizeof(raw));
+	WriteD(raw);
+}
+
+void SaveStateWriter::WriteDouble(double val) {
+	Bit64u raw;
+	memcpy(&raw,&val,sizeof(raw));
+	WriteQ(raw);
+}
+
+void SaveStateWriter::WriteBytes(const void * data,Bitu size) {
+	if (!size) return;
+	memcpy(Reserve(size),data,size);
+}
+
+void SaveStateWriter::WriteString(const char * str) {
+	Bitu len=strlen(str);
+	WriteD((Bit32u)len);
+	WriteBytes(str,len);
+}
+
+float SaveStateReader::ReadFloat(void) {
+	Bit32u raw=ReadD();
+	float val;
+	memcpy(&val,&raw,sizeof(val));
+	return val;
+}
+
+double SaveStateReader::ReadDouble(void) {
+	Bit64u raw=ReadQ();
+	double val;
+	memcpy(&val,&raw,sizeof(val));
+	return val;
+}
+
+bool SaveStateReader::ReadBytes(void * dest,Bitu len) {
+	const Bit8u * src=Skip(len);
+	if (!src) return false;
+	if (len && !checking) memcpy(dest,src,len);
+	return true;
+}
+
+std::string SaveStateReader::ReadString(void) {
+	Bitu len=ReadD();
+	const Bit8u * src=Skip(len);
+	if (!src) return std::string();
+	return std::string((const char *)src,len);
+}
+
+bool SaveStateReader::ReadBlock(void * dest,Bitu len) {
+	if (ReadD()!=len) {
+		failed=true;
+		return false;
+	}
+	return ReadBytes(dest,len);
+}
+
+
+void SAVESTATE_AddModule(Module_base * module) {
+	StateEntry entry;
+	entry.module=module;
+	entry.save=0;
+	entry.load=0;
+	state_entries.push_back(entry);
+}
+
+void SAVESTATE_DelModule(Module_base * module) {
+	for (state_it it=state_entries.begin();it!=state_entries.end();++it) {
+		if (it->module==module) {
+			state_entries.erase(it);
+			return;
+		}
+	}
+}
+
+void SAVESTATE_AddHandler(const char * name,SAVESTATE_SaveHandler save,SAVESTATE_LoadHandler load) {
+	SAVESTATE_DelHandler(name);
+	StateEntry entry;
+	entry.name=name;
+	entry.module=0;
+	entry.save=save;
+	entry.load=load;
+	state_entries.push_back(entry);
+}
+
+void SAVESTATE_DelHandler(const char * name) {
+	for (state_it it=state_entries.begin();it!=state_entries.end();++it) {
+		if (!it->module && it->name==name) {
+			state_entries.erase(it);
+			return;
+		}
+	}
+}
+
+/* Modules are asked for their name when it's needed, as it can't be asked for
+   from within the Module_base constructor. */
+static const char * SAVESTATE_EntryName(StateEntry & entry) {
+	if (entry.module) return entry.module->GetStateName();
+	return entry.name.c_str();
+}
+
+
+bool SAVESTATE_Save(std::vector<Bit8u> & buffer,bool delta) {
+	Bit64u serial=GetMicroTicks();
+	if (serial<=last_serial) serial=last_serial+1;
+
+	buffer.clear();
+	SaveStateWriter state(buffer,serial,delta);
+	state.WriteBytes(state_magic,sizeof(state_magic));
+	state.WriteD(SAVESTATE_VERSION);
+	state.WriteQ((Bit64u)SAVESTATE_Fingerprint());
+	state.WriteQ(serial);
+	state.WriteQ(delta ? last_serial : 0);
+	state.WriteD((Bit32u)MEM_TotalPages());
+	state.WriteString(VERSION);
+
+	for (state_it it=state_entries.begin();it!=state_entries.end();++it) {
+		const char * name=SAVESTATE_EntryName(*it);
+		if (!name) continue;
+		Bitu len=strlen(name);
+		state.WriteB((Bit8u)len);
+		state.WriteBytes(name,len);
+		Bitu size_pos=state.Size();
+		state.WriteD(0);
+		if (it->module) it->module->SaveState(state);
+		else it->save(state);
+		Bit32u size=(Bit32u)(state.Size()-size_pos-4);
+		host_writed(&buffer[size_pos],size);
+	}
+	state.WriteB(0);
+	last_serial=serial;
+	return true;
+}
+
+static bool SAVESTATE_LoadChunks(const Bit8u * chunks,Bitu size,Bit64u serial,bool checking) {
+	SaveStateReader reader(chunks,size,serial);
+	for (;;) {
+		Bitu len=reader.ReadB();
+		if (!len) break;
+		std::string name((const char *)reader.Skip(len),len);
+		Bitu chunk_size=reader.ReadD();
+		const Bit8u * chunk=reader.Skip(chunk_size);
+
+		state_it it;
+		for (it=state_entries.begin();it!=state_entries.end();++it) {
+			const char * entry_name=SAVESTATE_EntryName(*it);
+			if (entry_name && name==entry_name) break;
+		}
+		if (it==state_entries.end()) {
+			if (checking) LOG_MSG("SAVESTATE:Skipping state for %s, which is not present",name.c_str());
+			continue;
+		}
+		SaveStateReader module_state(chunk,chunk_size,serial,checking);
+		bool loaded=it->module ? it->module->LoadState(module_state) : it->load(module_state);
+		if (!loaded || module_state.Failed()) {
+			/* Anything that fails while loading for real has slipped past its check,
+			   and earlier modules have been restored already */
+			if (checking) LOG_MSG("SAVESTATE:Could not restore state for %s",name.c_str());
+			else LOG_MSG("SAVESTATE:State for %s failed to load after passing its check",name.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SAVESTATE_Load(const Bit8u * data,Bitu size) {
+	SaveStateReader header(data,size,0);
+	char magic[sizeof(state_magic)];
+	if (!header.ReadBytes(magic,sizeof(magic)) || memcmp(magic,state_magic,sizeof(magic))) {
+		LOG_MSG("SAVESTATE:Not a saved state");
+		return false;
+	}
+	if (header.ReadD()!=SAVESTATE_VERSION) {
+		LOG_MSG("SAVESTATE:Saved state is from an incompatible version");
+		return false;
+	}
+	if ((Bit64s)header.ReadQ()!=SAVESTATE_Fingerprint()) {
+		LOG_MSG("SAVESTATE:Saved state is from a different build");
+		return false;
+	}
+	Bit64u serial=header.ReadQ();
+	Bit64u base=header.ReadQ();
+	if (base && base!=last_serial) {
+		LOG_MSG("SAVESTATE:Saved state is relative to a state that is not loaded");
+		return false;
+	}
+	if (header.ReadD()!=MEM_TotalPages()) {
+		LOG_MSG("SAVESTATE:Saved state has a different memory size");
+		return false;
+	}
+	header.ReadString();
+	if (header.Failed()) return false;
+
+	/* Check the chunks are all intact before touching anything */
+	const Bit8u * chunks=data+(size-header.Remaining());
+	for (;;) {
+		Bitu len=header.ReadB();
+		if (header.Failed()) return false;
+		if (!len) break;
+		header.Skip(len);
+		header.Skip(header.ReadD());
+		if (header.Failed()) {
+			LOG_MSG("SAVESTATE:Saved state is truncated");
+			return false;
+		}
+	}
+
+	/* Then have every module check its state, and only load it all once none of them object */
+	if (!SAVESTATE_LoadChunks(chunks,size-(chunks-data),serial,true)) return false;
+	if (!SAVESTATE_LoadChunks(chunks,size-(chunks-data),serial,false)) return false;
+	last_serial=serial;
+	return true;
+}
+
+bool SAVESTATE_SaveFile(const char * filename) {
+	std::vector<Bit8u> buffer;
+	if (!SAVESTATE_Save(buffer)) return false;
+	FILE * f=fopen(filename,"wb");
+	if (!f) {
+		LOG_MSG("SAVESTATE:Can't open %s for writing",filename);
+		return false;
+	}
+	bool success=fwrite(&buffer[0],1,buffer.size(),f)==buffer.size();
+	if (fclose(f)!=0) success=false;
+	if (!success) LOG_MSG("SAVESTATE:Couldn't write %s",filename);
+	return success;
+}
+
+bool SAVESTATE_LoadFile(const char * filename) {
+	FILE * f=fopen(filename,"rb");
+	if (!f) {
+		LOG_MSG("SAVESTATE:Can't open %s",filename);
+		return false;
+	}
+	std::vector<Bit8u> buffer;
+	Bit8u block[16384];
+	size_t count;
+	while ((count=fread(block,1,sizeof(block),f))>0) buffer.insert(buffer.end(),block,block+count);
+	fclose(f);
+	if (buffer.empty()) return false;
+	return SAVESTATE_Load(&buffer[0],buffer.size());
+}
+
+void SAVESTATE_RequestSave(const char * filename) {
+	requests.save=filename;
+	requests.pending=true;
+}
+
+void SAVESTATE_RequestLoad(const char * filename) {
+	requests.load=filename;
+	requests.pending=true;
+}
+
+void SAVESTATE_RunRequests(void) {
+	if (!requests.pending) return;
+	requests.pending=false;
+	if (!requests.save.empty()) {
+		if (SAVESTATE_SaveFile(requests.save.c_str())) LOG_MSG("SAVESTATE:Saved state to %s",requests.save.c_str());
+		requests.save.clear();
+	}
+	if (!requests.load.empty()) {
+		if (SAVESTATE_LoadFile(requests.load.c_str())) LOG_MSG("SAVESTATE:Loaded state from %s",requests.load.c_str());
+		requests.load.clear();
+	}
+}
+
+
+class STATE : public Program {
+public:
+	void Run(void);
+private:
+	void Benchmark(void);
+};
+
+void STATE::Benchmark(void) {
+	std::vector<Bit8u> keyframe,delta;
+	/* Pages the program has written since the last state was saved or loaded */
+	MEM_SnapshotStats snapshot;
+	MEM_GetSnapshotStats(&snapshot);
+	Bitu dirty_pages=snapshot.dirty_pages;
+	Bit64u start=GetMicroTicks();
+	SAVESTATE_Save(keyframe);
+	Bit64u saved=GetMicroTicks();
+	SAVESTATE_Load(&keyframe[0],keyframe.size());
+	Bit64u loaded=GetMicroTicks();
+	SAVESTATE_Save(delta,true);
+	Bit64u delta_saved=GetMicroTicks();
+	SAVESTATE_Load(&delta[0],delta.size());
+	Bit64u delta_loaded=GetMicroTicks();
+
+	WriteOut(MSG_Get("PROGRAM_STATE_BENCH_MEMORY"),(int)(MEM_TotalPages()*MEM_PAGESIZE/1024));
+	WriteOut(MSG_Get("PROGRAM_STATE_BENCH_RESULT"),"Full",(int)(keyframe.size()/1024),
+		(saved-start)/1000.0,(loaded-saved)/1000.0,(loaded-start)/1000.0);
+	WriteOut(MSG_Get("PROGRAM_STATE_BENCH_RESULT"),"Delta",(int)(delta.size()/1024),
+		(delta_saved-loaded)/1000.0,(delta_loaded-delta_saved)/1000.0,(delta_loaded-loaded)/1000.0);
+	MEM_GetSnapshotStats(&snapshot);
+	WriteOut(MSG_Get("PROGRAM_STATE_BENCH_SNAPSHOT"),(int)dirty_pages,(int)snapshot.total_pages,
+		snapshot.snapshot_ms,snapshot.restore_ms);
+}
+
+void STATE::Run(void) {
+	if (cmd->FindExist("/BENCH",true)) {
+		Benchmark();
+		return;
+	}
+	std::string action;
+	if (!cmd->FindCommand(1,action) || !cmd->FindCommand(2,temp_line)) {
+		WriteOut(MSG_Get("PROGRAM_STATE_USAGE"));
+		return;
+	}
+	if (control->SecureMode()) {
+		WriteOut(MSG_Get("PROGRAM_CONFIG_SECURE_DISALLOW"));
+		return;
+	}
+	/* The state is taken once this program has finished, so that it doesn't
+	   resume in the middle of running STATE itself. */
+	if (!strcasecmp(action.c_str(),"SAVE")) {
+		SAVESTATE_RequestSave(temp_line.c_str());
+	} else if (!strcasecmp(action.c_str(),"LOAD")) {
+		SAVESTATE_RequestLoad(temp_line.c_str());
+	} else {
+		WriteOut(MSG_Get("PROGRAM_STATE_USAGE"));
+	}
+}
+
+static void STATE_ProgramStart(Program * * make) {
+	*make=new STATE;
+}
+
+void SAVESTATE_Init(Section * /*sec*/) {
+	PROGRAMS_MakeFile("STATE.COM",STATE_ProgramStart);
+	MSG_Add("PROGRAM_STATE_USAGE","Saves or restores the state of the emulated machine.\n\n"
+		"STATE SAVE filename\nSTATE LOAD filename\nSTATE /BENCH\n");
+	MSG_Add("PROGRAM_STATE_BENCH_MEMORY","Machine has %dkb of memory.\n");
+	MSG_Add("PROGRAM_STATE_BENCH_RESULT","%-5s state: %6dkb, save %.2fms, load %.2fms, total %.2fms\n");
+	MSG_Add("PROGRAM_STATE_BENCH_SNAPSHOT","Memory snapshot: %d of %d pages written since the last state, snapshot %.2fms, restore %.2fms\n");
+}